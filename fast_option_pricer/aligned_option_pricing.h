@@ -0,0 +1,280 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+#pragma once
+
+#include <hwy/aligned_allocator.h>
+#include <hwy/base.h>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "common.h"
+
+namespace fast_option_pricer {
+
+// Owning column storage that can be reused across pricing cycles. All columns
+// live in one HWY_ALIGNMENT-aligned allocation, each starting on an alignment
+// boundary and padded to a whole number of HWY_ALIGNMENT bytes, so kernels can
+// use aligned loads/stores and run the last partial vector as a full one.
+//
+// A dirty bit per option records which options changed since they were last
+// priced, so that FastBlackScholes::reprice_dirty only revalues those. The
+// set_* methods mark the option they write; writes through the column spans
+// must be followed by mark_dirty. Pricing the whole batch with price or
+// price_mixed clears every bit.
+template <IsFloatOrDouble T>
+class AlignedOptionPricing
+{
+   public:
+    explicit AlignedOptionPricing(size_t num_options = 0)
+    {
+        resize(num_options);
+    }
+
+    // Sets the number of options. Only allocates if num_options exceeds
+    // capacity(), in which case the contents of all columns are unspecified.
+    // Marks every option dirty.
+    void resize(size_t num_options)
+    {
+        reserve(num_options);
+        num_options_ = num_options;
+        fill_padding();
+        mark_all_dirty();
+    }
+
+    void reserve(size_t capacity)
+    {
+        if (capacity <= capacity_) {
+            return;
+        }
+        capacity_ = hwy::RoundUpTo(capacity, kColumnPadding);
+        data_ = hwy::AllocateAligned<T>(kNumColumns * capacity_);
+        dirty_.assign(hwy::DivCeil(capacity_, size_t{64}), 0);
+    }
+
+    [[nodiscard]] size_t num_options() const
+    {
+        return num_options_;
+    }
+
+    [[nodiscard]] size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    [[nodiscard]] std::span<T> underlyings()
+    {
+        return column(kUnderlyings);
+    }
+
+    [[nodiscard]] std::span<T> strikes()
+    {
+        return column(kStrikes);
+    }
+
+    [[nodiscard]] std::span<T> risk_free_rates()
+    {
+        return column(kRiskFreeRates);
+    }
+
+    [[nodiscard]] std::span<T> volatilities()
+    {
+        return column(kVolatilities);
+    }
+
+    [[nodiscard]] std::span<T> times_to_expiry()
+    {
+        return column(kTimesToExpiry);
+    }
+
+    [[nodiscard]] std::span<T> dividend_yields()
+    {
+        return column(kDividendYields);
+    }
+
+    // OptionType<T>::kCall or kPut per option, only read by price_mixed
+    [[nodiscard]] std::span<T> option_types()
+    {
+        return column(kOptionTypes);
+    }
+
+    [[nodiscard]] std::span<T> prices()
+    {
+        return column(kPrices);
+    }
+
+    [[nodiscard]] std::span<T> deltas()
+    {
+        return column(kDeltas);
+    }
+
+    [[nodiscard]] std::span<T> vegas()
+    {
+        return column(kVegas);
+    }
+
+    [[nodiscard]] std::span<T> thetas()
+    {
+        return column(kThetas);
+    }
+
+    [[nodiscard]] std::span<T> gammas()
+    {
+        return column(kGammas);
+    }
+
+    [[nodiscard]] std::span<T> rhos()
+    {
+        return column(kRhos);
+    }
+
+    void set_underlying(size_t i, T value)
+    {
+        set(kUnderlyings, i, value);
+    }
+
+    void set_strike(size_t i, T value)
+    {
+        set(kStrikes, i, value);
+    }
+
+    void set_risk_free_rate(size_t i, T value)
+    {
+        set(kRiskFreeRates, i, value);
+    }
+
+    void set_volatility(size_t i, T value)
+    {
+        set(kVolatilities, i, value);
+    }
+
+    void set_time_to_expiry(size_t i, T value)
+    {
+        set(kTimesToExpiry, i, value);
+    }
+
+    void set_dividend_yield(size_t i, T value)
+    {
+        set(kDividendYields, i, value);
+    }
+
+    void set_option_type(size_t i, T value)
+    {
+        set(kOptionTypes, i, value);
+    }
+
+    void mark_dirty(size_t i)
+    {
+        dirty_[i / 64] |= uint64_t{1} << (i % 64);
+    }
+
+    void mark_all_dirty()
+    {
+        mark_all_clean();
+        for (size_t w = 0; w < num_options_ / 64; ++w) {
+            dirty_[w] = ~uint64_t{0};
+        }
+        if (num_options_ % 64 != 0) {
+            dirty_[num_options_ / 64] = (uint64_t{1} << num_options_ % 64) - 1;
+        }
+    }
+
+    void mark_all_clean()
+    {
+        std::fill(dirty_.begin(), dirty_.end(), 0);
+    }
+
+    [[nodiscard]] bool is_dirty(size_t i) const
+    {
+        return (dirty_[i / 64] >> (i % 64)) & 1;
+    }
+
+    [[nodiscard]] size_t num_dirty() const
+    {
+        size_t n = 0;
+        for (const uint64_t word : dirty_) {
+            n += std::popcount(word);
+        }
+        return n;
+    }
+
+    // Bit i % 64 of word i / 64 is set if option i is dirty
+    [[nodiscard]] std::span<uint64_t> dirty_words()
+    {
+        return {dirty_.data(), hwy::DivCeil(num_options_, size_t{64})};
+    }
+
+    [[nodiscard]] OptionPricingView<T> view()
+    {
+        OptionPricingView<T> v{underlyings(),     strikes(),
+                               risk_free_rates(), volatilities(),
+                               times_to_expiry(), dividend_yields(),
+                               prices(),          deltas(),
+                               vegas(),           thetas(),
+                               gammas(),          rhos(),
+                               option_types()};
+        v.padded_num_options = padded_num_options();
+        return v;
+    }
+
+    static constexpr size_t kColumnPadding = HWY_ALIGNMENT / sizeof(T);
+
+   private:
+    enum Column : size_t
+    {
+        kUnderlyings,
+        kStrikes,
+        kRiskFreeRates,
+        kVolatilities,
+        kTimesToExpiry,
+        kDividendYields,
+        kOptionTypes,
+        kPrices,
+        kDeltas,
+        kVegas,
+        kThetas,
+        kGammas,
+        kRhos,
+        kNumColumns
+    };
+
+    [[nodiscard]] size_t padded_num_options() const
+    {
+        return hwy::RoundUpTo(num_options_, kColumnPadding);
+    }
+
+    [[nodiscard]] std::span<T> column(size_t c)
+    {
+        return {data_.get() + c * capacity_, num_options_};
+    }
+
+    void set(size_t c, size_t i, T value)
+    {
+        data_[c * capacity_ + i] = value;
+        mark_dirty(i);
+    }
+
+    // Padding lanes are priced along with the last vector, so give them
+    // inputs that keep the maths finite.
+    void fill_padding()
+    {
+        const size_t end = padded_num_options();
+        for (size_t c = kUnderlyings; c <= kOptionTypes; ++c) {
+            T* first = data_.get() + c * capacity_;
+            const bool is_rate = c == kRiskFreeRates || c == kDividendYields;
+            std::fill(
+                first + num_options_, first + end,
+                static_cast<T>(is_rate ? 0.0 : 1.0));
+        }
+    }
+
+    size_t num_options_{0};
+    size_t capacity_{0};
+    hwy::AlignedFreeUniquePtr<T[]> data_;
+    std::vector<uint64_t> dirty_;
+};
+
+}  // namespace fast_option_pricer
@@ -0,0 +1,151 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+#pragma once
+
+#include <hwy/base.h>
+#include <algorithm>
+#include <functional>
+#include <span>
+#include <utility>
+#include <vector>
+#include "aligned_option_pricing.h"
+#include "common.h"
+#include "dynamic_black_scholes.h"
+
+namespace fast_option_pricer {
+
+// Runs a sequence of stages over a batch one tile at a time, e.g. a call pass,
+// a put pass and an aggregation of the book. Each stage runs on a tile while
+// the previous stages have just left its columns in L2, so a batch far larger
+// than the caches streams its columns from DRAM once instead of once per pass.
+// Tiles are a whole number of HWY_ALIGNMENT bytes per column, like the chunks
+// of ParallelBlackScholes.
+template <IsFloatOrDouble T = double>
+class BlockedBlackScholes
+{
+   public:
+    // Runs on options [begin, begin + count) of the batch 'op'
+    using Stage = std::function<void(
+        const OptionPricingView<T>& op, size_t begin, size_t count)>;
+
+    // About 16 columns * 2048 doubles = 256 KiB per tile
+    static constexpr size_t kDefaultTileSize = 2048;
+
+    explicit BlockedBlackScholes(size_t tile_size = kDefaultTileSize)
+        : tile_size_(hwy::RoundUpTo(
+              std::max<size_t>(tile_size, 1), HWY_ALIGNMENT / sizeof(T)))
+    {
+    }
+
+    [[nodiscard]] size_t tile_size() const
+    {
+        return tile_size_;
+    }
+
+    BlockedBlackScholes& add_stage(Stage stage)
+    {
+        stages_.push_back(std::move(stage));
+        return *this;
+    }
+
+    // See DynamicBlackScholes::price
+    template <bool Call = true>
+    BlockedBlackScholes& add_price()
+    {
+        return add_stage([](const OptionPricingView<T>& op, size_t begin,
+                            size_t count) {
+            DynamicBlackScholes<T>::template price<Call>(
+                op.subview(begin, count));
+        });
+    }
+
+    // Prices puts into 'put' from the inputs of the batch. Gammas and vegas
+    // are the same for both legs and go to the batch itself.
+    BlockedBlackScholes& add_put(const PutPricingView<T>& put)
+    {
+        return add_stage([put](const OptionPricingView<T>& op, size_t begin,
+                               size_t count) {
+            const OptionPricingView<T> tile = op.subview(begin, count);
+            const PutPricingView<T> put_tile =
+                put.subview(begin, count, op.num_options);
+            OptionPricingView<T> v{
+                tile.underlyings,     tile.strikes,  tile.risk_free_rates,
+                tile.volatilities,    tile.times_to_expiry,
+                tile.dividend_yields, put_tile.prices,
+                put_tile.deltas,      tile.vegas,    put_tile.thetas,
+                tile.gammas,          put_tile.rhos};
+            v.padded_num_options =
+                std::min(tile.padded_num_options, put_tile.padded_num_options);
+            DynamicBlackScholes<T>::template price<false>(v);
+        });
+    }
+
+    // See DynamicBlackScholes::price_call_put
+    BlockedBlackScholes& add_call_put(const PutPricingView<T>& put)
+    {
+        return add_stage([put](const OptionPricingView<T>& op, size_t begin,
+                               size_t count) {
+            DynamicBlackScholes<T>::price_call_put(
+                op.subview(begin, count),
+                put.subview(begin, count, op.num_options));
+        });
+    }
+
+    // See DynamicBlackScholes::price_mixed
+    BlockedBlackScholes& add_price_mixed()
+    {
+        return add_stage([](const OptionPricingView<T>& op, size_t begin,
+                            size_t count) {
+            DynamicBlackScholes<T>::price_mixed(op.subview(begin, count));
+        });
+    }
+
+    // Adds the position weighted outputs of the batch to 'totals', see
+    // DynamicBlackScholes::aggregate. 'positions' and 'totals' must outlive
+    // the pipeline.
+    BlockedBlackScholes& add_aggregate(
+        std::span<const T> positions, OptionResult<T>& totals)
+    {
+        return add_stage([positions, &totals](
+                             const OptionPricingView<T>& op, size_t begin,
+                             size_t count) {
+            const OptionResult<T> tile = DynamicBlackScholes<T>::aggregate(
+                op.subview(begin, count), positions.subspan(begin, count));
+            totals.price += tile.price;
+            totals.delta += tile.delta;
+            totals.vega += tile.vega;
+            totals.theta += tile.theta;
+            totals.gamma += tile.gamma;
+            totals.rho += tile.rho;
+        });
+    }
+
+    void run(OptionPricing<T>& op) const
+    {
+        run(op.view());
+    }
+
+    void run(AlignedOptionPricing<T>& op) const
+    {
+        run(op.view());
+    }
+
+    // Runs every stage on the first tile, then on the next one, and so on
+    void run(const OptionPricingView<T>& op) const
+    {
+        for (size_t begin = 0; begin < op.num_options; begin += tile_size_) {
+            const size_t count = std::min(tile_size_, op.num_options - begin);
+            for (const Stage& stage : stages_) {
+                stage(op, begin, count);
+            }
+        }
+    }
+
+   private:
+    const size_t tile_size_;
+    std::vector<Stage> stages_;
+};
+
+}  // namespace fast_option_pricer
@@ -0,0 +1,93 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+#pragma once
+
+#include <hwy/aligned_allocator.h>
+#include <hwy/base.h>
+#include <span>
+#include "common.h"
+
+namespace fast_option_pricer {
+
+// Per-bucket intermediates of a TermStructureView, filled by
+// FastBlackScholes::cache_bucket_terms and gathered by every
+// price_bucketed call until the rates, dividend yields or expiries of the
+// buckets change. Columns are aligned and padded like those of SpotCache.
+template <IsFloatOrDouble T>
+class BucketTerms
+{
+   public:
+    explicit BucketTerms(size_t num_buckets = 0)
+    {
+        resize(num_buckets);
+    }
+
+    // Only allocates if num_buckets exceeds capacity(), in which case the
+    // contents of all columns are unspecified.
+    void resize(size_t num_buckets)
+    {
+        if (num_buckets > capacity_) {
+            capacity_ = hwy::RoundUpTo(num_buckets, kColumnPadding);
+            data_ = hwy::AllocateAligned<T>(kNumColumns * capacity_);
+        }
+        num_buckets_ = num_buckets;
+    }
+
+    [[nodiscard]] size_t num_buckets() const
+    {
+        return num_buckets_;
+    }
+
+    [[nodiscard]] size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    // sqrt(T)
+    [[nodiscard]] std::span<T> root_ts()
+    {
+        return column(kRootTs);
+    }
+
+    // e^(-qT)
+    [[nodiscard]] std::span<T> e_qts()
+    {
+        return column(kE_qts);
+    }
+
+    // e^(-rT)
+    [[nodiscard]] std::span<T> e_rts()
+    {
+        return column(kE_rts);
+    }
+
+    // Buckets that can be read and written, including the padding
+    [[nodiscard]] size_t padded_num_buckets() const
+    {
+        return hwy::RoundUpTo(num_buckets_, kColumnPadding);
+    }
+
+    static constexpr size_t kColumnPadding = HWY_ALIGNMENT / sizeof(T);
+
+   private:
+    enum Column : size_t
+    {
+        kRootTs,
+        kE_qts,
+        kE_rts,
+        kNumColumns
+    };
+
+    [[nodiscard]] std::span<T> column(size_t c)
+    {
+        return {data_.get() + c * capacity_, num_buckets_};
+    }
+
+    size_t num_buckets_{0};
+    size_t capacity_{0};
+    hwy::AlignedFreeUniquePtr<T[]> data_;
+};
+
+}  // namespace fast_option_pricer
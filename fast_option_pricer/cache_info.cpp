@@ -0,0 +1,52 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+#include "cache_info.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace fast_option_pricer {
+
+namespace {
+
+size_t query_last_level_cache_bytes()
+{
+    long bytes = 0;
+#if defined(__APPLE__)
+    for (const char* name : {"hw.l3cachesize", "hw.l2cachesize"}) {
+        int64_t value = 0;
+        size_t size = sizeof(value);
+        if (sysctlbyname(name, &value, &size, nullptr, 0) == 0) {
+            bytes = std::max<long>(bytes, static_cast<long>(value));
+        }
+    }
+#elif defined(__linux__) && defined(_SC_LEVEL3_CACHE_SIZE)
+    bytes = std::max(
+        sysconf(_SC_LEVEL3_CACHE_SIZE), sysconf(_SC_LEVEL2_CACHE_SIZE));
+#endif
+    return bytes > 0 ? static_cast<size_t>(bytes) : size_t{32} << 20;
+}
+
+}  // namespace
+
+size_t last_level_cache_bytes()
+{
+    static const size_t bytes = query_last_level_cache_bytes();
+    return bytes;
+}
+
+bool streams_outputs(Stores stores, size_t bytes)
+{
+    return stores == Stores::kStreaming ||
+           (stores == Stores::kAuto && bytes > last_level_cache_bytes());
+}
+
+}  // namespace fast_option_pricer
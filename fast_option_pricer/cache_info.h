@@ -0,0 +1,21 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include "common.h"
+
+namespace fast_option_pricer {
+
+// Size of the largest data cache of the host, e.g. the L3 of an x86 socket
+// or the shared L2 of an Apple M-series cluster. Queried once, and 32 MiB if
+// the OS does not report it.
+[[nodiscard]] size_t last_level_cache_bytes();
+
+// Whether 'stores' streams the outputs of a batch whose columns take 'bytes',
+// see Stores
+[[nodiscard]] bool streams_outputs(Stores stores, size_t bytes);
+
+}  // namespace fast_option_pricer
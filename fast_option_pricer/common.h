@@ -4,10 +4,472 @@
 
 #pragma once
 
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <type_traits>
 #include <vector>
 
 namespace fast_option_pricer {
 
+// Values of the option_types column. Kept as +-1 in the column's own type so
+// a vector of types turns into a call/put blend mask with one comparison.
+template <typename T>
+struct OptionType
+{
+    static constexpr T kCall = 1;
+    static constexpr T kPut = -1;
+};
+
+// One option of a struct based feed, see FastOptionRecords. Padded to eight
+// fields, a 64 byte cache line in double, so that a vector of records
+// transposes into columns with two 4-way de-interleaves.
+template <typename T>
+struct OptionRecord
+{
+    T underlying;
+    T strike;
+    T risk_free_rate;
+    T volatility;
+    T time_to_expiry;
+    T dividend_yield;
+    // OptionType<T>::kCall or kPut
+    T option_type;
+    T reserved;
+};
+
+// Outputs of one option in struct form, see FastOptionRecords
+template <typename T>
+struct OptionResult
+{
+    T price;
+    T delta;
+    T vega;
+    T theta;
+    T gamma;
+    T rho;
+};
+
+// Bitmask of the outputs a pricer computes, passed as a template argument so
+// unrequested outputs cost neither arithmetic nor stores.
+enum Output : uint32_t
+{
+    kPrice = 1u << 0,
+    kDelta = 1u << 1,
+    kVega = 1u << 2,
+    kTheta = 1u << 3,
+    kGamma = 1u << 4,
+    kRho = 1u << 5,
+    kAllOutputs = kPrice | kDelta | kVega | kTheta | kGamma | kRho
+};
+
+// Accuracy of the exp, log and normal CDF kernels the fast pricers use, see
+// FastMathHelper for the max errors of each tier.
+enum class Accuracy
+{
+    // Highway's exp/log and the erfc based CDF, within a few ulp
+    kExact,
+    // About 1e-7 relative, i.e. float precision
+    kFast,
+    // About 1e-5, for risk runs that only need greeks to 1e-4
+    kFastest
+};
+
+// Precision the fast pricers evaluate the normal CDF and PDF in
+enum class Precision
+{
+    // The precision of the columns
+    kFull,
+    // Double columns, float lanes for the CDF and PDF. exp and log stay in
+    // double: float discount factors would put float error on S and K.
+    kMixed
+};
+
+// How the fast pricers store outputs
+enum class Stores
+{
+    // Through the caches, for outputs that are read again soon
+    kCached,
+    // Non-temporal stores that bypass the caches and skip the read for
+    // ownership of each output line. Only aligned columns padded to whole
+    // vectors (e.g. AlignedOptionPricing) are streamed.
+    kStreaming,
+    // kStreaming if the batch's columns exceed last_level_cache_bytes(), as
+    // its outputs are then evicted before anything could read them
+    kAuto
+};
+
+// Columns of one option a pricing pass touches: six inputs, the option types
+// of a mixed book, the outputs and, for price_call_put, the put outputs
+// (gamma and vega are shared with the call)
+[[nodiscard]] constexpr size_t pass_columns(
+    uint32_t outputs, bool mixed, bool call_and_put)
+{
+    constexpr uint32_t kPutOutputs = kPrice | kDelta | kTheta | kRho;
+    return 6 + mixed + std::popcount(outputs) +
+           call_and_put * std::popcount(outputs & kPutOutputs);
+}
+
+// Non-owning view over caller-owned input and output columns, e.g. columns
+// of an existing market data buffer. Pricing through a view allocates and
+// copies nothing. Output columns must hold at least num_options elements, or
+// be empty if the output is not requested.
+//
+// If every column can be read and written up to padded_num_options elements
+// (see AlignedOptionPricing), kernels may process the padding too instead of
+// running a partial last vector.
+//
+// option_types is only read by price_mixed and may be left empty otherwise.
+// risk_free_rates, times_to_expiry and dividend_yields may be left empty when
+// pricing against a TermStructureView, which replaces them, and underlyings
+// too when pricing a StrikeChain. num_options is the number of strikes.
+template <typename T>
+struct OptionPricingView
+{
+    OptionPricingView(
+        std::span<const T> underlyings, std::span<const T> strikes,
+        std::span<const T> risk_free_rates, std::span<const T> volatilities,
+        std::span<const T> times_to_expiry,
+        std::span<const T> dividend_yields, std::span<T> prices,
+        std::span<T> deltas, std::span<T> vegas, std::span<T> thetas,
+        std::span<T> gammas, std::span<T> rhos,
+        std::span<const T> option_types = {})
+        : num_options(strikes.size()),
+          padded_num_options(strikes.size()),
+          underlyings(underlyings),
+          strikes(strikes),
+          risk_free_rates(risk_free_rates),
+          volatilities(volatilities),
+          times_to_expiry(times_to_expiry),
+          dividend_yields(dividend_yields),
+          prices(prices),
+          deltas(deltas),
+          vegas(vegas),
+          thetas(thetas),
+          gammas(gammas),
+          rhos(rhos),
+          option_types(option_types)
+    {
+        assert(num_options == underlyings.size() || underlyings.empty());
+        assert(num_options == volatilities.size());
+        assert(num_options == risk_free_rates.size() ||
+               (risk_free_rates.empty() && times_to_expiry.empty() &&
+                dividend_yields.empty()));
+        assert(option_types.empty() || num_options == option_types.size());
+    }
+
+    // True if every input column but option_types holds num_options, i.e.
+    // the view does not rely on a TermStructureView or StrikeChain
+    [[nodiscard]] bool has_input_columns() const
+    {
+        return num_options == underlyings.size() &&
+               num_options == risk_free_rates.size() &&
+               num_options == times_to_expiry.size() &&
+               num_options == dividend_yields.size();
+    }
+
+    // True if the columns of every output in 'outputs' hold num_options
+    [[nodiscard]] bool has_outputs(uint32_t outputs) const
+    {
+        const auto has = [&](uint32_t output, std::span<T> column) {
+            return !(outputs & output) || num_options <= column.size();
+        };
+        return has(kPrice, prices) && has(kDelta, deltas) &&
+               has(kVega, vegas) && has(kTheta, thetas) &&
+               has(kGamma, gammas) && has(kRho, rhos);
+    }
+
+    // Options [begin, begin + count). Only a chunk that reaches the end keeps
+    // the padding, the others stop where the next chunk starts.
+    [[nodiscard]] OptionPricingView subview(size_t begin, size_t count) const
+    {
+        assert(begin + count <= num_options);
+        const auto slice = [&](auto column) {
+            return column.empty() ? column : column.subspan(begin, count);
+        };
+        OptionPricingView v{
+            slice(underlyings),     slice(strikes), slice(risk_free_rates),
+            slice(volatilities),    slice(times_to_expiry),
+            slice(dividend_yields), slice(prices),  slice(deltas),
+            slice(vegas),           slice(thetas),  slice(gammas),
+            slice(rhos),            slice(option_types)};
+        v.padded_num_options =
+            begin + count == num_options ? padded_num_options - begin : count;
+        return v;
+    }
+
+    // True if every column starts on a multiple of 'bytes'
+    [[nodiscard]] bool aligned_to(size_t bytes) const
+    {
+        const auto aligned = [bytes](const T* p) {
+            return reinterpret_cast<uintptr_t>(p) % bytes == 0;
+        };
+        return aligned(underlyings.data()) && aligned(strikes.data()) &&
+               aligned(risk_free_rates.data()) &&
+               aligned(volatilities.data()) &&
+               aligned(times_to_expiry.data()) &&
+               aligned(dividend_yields.data()) && aligned(prices.data()) &&
+               aligned(deltas.data()) && aligned(vegas.data()) &&
+               aligned(thetas.data()) && aligned(gammas.data()) &&
+               aligned(rhos.data()) && aligned(option_types.data());
+    }
+
+    size_t num_options;
+    size_t padded_num_options;
+    std::span<const T> underlyings;
+    std::span<const T> strikes;
+    std::span<const T> risk_free_rates;
+    std::span<const T> volatilities;
+    std::span<const T> times_to_expiry;
+    std::span<const T> dividend_yields;
+    std::span<T> prices;
+    std::span<T> deltas;
+    std::span<T> vegas;
+    std::span<T> thetas;
+    std::span<T> gammas;
+    std::span<T> rhos;
+    std::span<const T> option_types;
+};
+
+// Inputs shared by every option of a strike chain, whose options only differ
+// in strike and volatility, see FastBlackScholes::price_chain
+template <typename T>
+struct StrikeChain
+{
+    T underlying;
+    T risk_free_rate;
+    T time_to_expiry;
+    T dividend_yield;
+};
+
+// Signed integer of the same width as T, as vector gathers index with
+template <typename T>
+using BucketIndex =
+    std::conditional_t<std::is_same_v<T, double>, int64_t, int32_t>;
+
+// Rates, dividend yields and expiries per expiry bucket, for books where
+// many options share them. buckets holds the bucket of each option, so its
+// size is the number of options; the other columns have one entry per
+// bucket. Every bucket must lie in [0, num_buckets): the pricers gather with
+// it unchecked and only assert has_valid_buckets in debug builds.
+template <typename T>
+struct TermStructureView
+{
+    TermStructureView(
+        std::span<const T> risk_free_rates, std::span<const T> dividend_yields,
+        std::span<const T> times_to_expiry,
+        std::span<const BucketIndex<T>> buckets)
+        : num_buckets(risk_free_rates.size()),
+          risk_free_rates(risk_free_rates),
+          dividend_yields(dividend_yields),
+          times_to_expiry(times_to_expiry),
+          buckets(buckets)
+    {
+        assert(num_buckets == dividend_yields.size());
+        assert(num_buckets == times_to_expiry.size());
+    }
+
+    // True if every option's bucket indexes the other columns
+    [[nodiscard]] bool has_valid_buckets() const
+    {
+        return std::all_of(
+            buckets.begin(), buckets.end(), [&](BucketIndex<T> bucket) {
+                return bucket >= 0 && static_cast<size_t>(bucket) < num_buckets;
+            });
+    }
+
+    // Options [begin, begin + count), sharing every bucket
+    [[nodiscard]] TermStructureView subview(size_t begin, size_t count) const
+    {
+        return {risk_free_rates, dividend_yields, times_to_expiry,
+                buckets.subspan(begin, count)};
+    }
+
+    size_t num_buckets;
+    std::span<const T> risk_free_rates;
+    std::span<const T> dividend_yields;
+    std::span<const T> times_to_expiry;
+    std::span<const BucketIndex<T>> buckets;
+};
+
+// Non-owning view over the put outputs of a fused call+put pass. Gammas and
+// vegas are the same for both legs and are written to the OptionPricingView
+// only.
+template <typename T>
+struct PutPricingView
+{
+    PutPricingView(
+        std::span<T> prices, std::span<T> deltas, std::span<T> thetas,
+        std::span<T> rhos)
+        : padded_num_options(prices.size()),
+          prices(prices),
+          deltas(deltas),
+          thetas(thetas),
+          rhos(rhos)
+    {
+    }
+
+    // The put outputs of 'op' itself, for pricing puts only
+    explicit PutPricingView(const OptionPricingView<T>& op)
+        : padded_num_options(op.padded_num_options),
+          prices(op.prices),
+          deltas(op.deltas),
+          thetas(op.thetas),
+          rhos(op.rhos)
+    {
+    }
+
+    // True if the columns of every put output in 'outputs' hold num_options
+    [[nodiscard]] bool has_outputs(uint32_t outputs, size_t num_options) const
+    {
+        const auto has = [&](uint32_t output, std::span<T> column) {
+            return !(outputs & output) || num_options <= column.size();
+        };
+        return has(kPrice, prices) && has(kDelta, deltas) &&
+               has(kTheta, thetas) && has(kRho, rhos);
+    }
+
+    // Put outputs of options [begin, begin + count) of 'op', where 'op' is
+    // the view this one was paired with (see OptionPricingView::subview).
+    [[nodiscard]] PutPricingView subview(
+        size_t begin, size_t count, size_t num_options) const
+    {
+        const auto slice = [&](std::span<T> column) {
+            return column.empty() ? column : column.subspan(begin, count);
+        };
+        PutPricingView v{
+            slice(prices), slice(deltas), slice(thetas), slice(rhos)};
+        v.padded_num_options =
+            begin + count == num_options ? padded_num_options - begin : count;
+        return v;
+    }
+
+    // True if every column starts on a multiple of 'bytes'
+    [[nodiscard]] bool aligned_to(size_t bytes) const
+    {
+        const auto aligned = [bytes](const T* p) {
+            return reinterpret_cast<uintptr_t>(p) % bytes == 0;
+        };
+        return aligned(prices.data()) && aligned(deltas.data()) &&
+               aligned(thetas.data()) && aligned(rhos.data());
+    }
+
+    size_t padded_num_options;
+    std::span<T> prices;
+    std::span<T> deltas;
+    std::span<T> thetas;
+    std::span<T> rhos;
+};
+
+// Spot and volatility shocks of a risk grid. Scenario
+// s = scenario(j, k) moves every underlying to S * (1 + spot_shocks[j]) and
+// every volatility to sigma + vol_shocks[k], so volatility shocks are in
+// absolute terms (0.01 is one vol point). A shocked volatility below
+// kMinVolatility is clamped to it, which prices the option at its
+// discounted intrinsic value instead of NaN.
+template <typename T>
+struct ScenarioGridView
+{
+    static constexpr T kMinVolatility = static_cast<T>(1e-4);
+
+    [[nodiscard]] size_t num_scenarios() const
+    {
+        return spot_shocks.size() * vol_shocks.size();
+    }
+
+    [[nodiscard]] size_t scenario(size_t spot, size_t vol) const
+    {
+        return spot * vol_shocks.size() + vol;
+    }
+
+    std::span<const T> spot_shocks;
+    std::span<const T> vol_shocks;
+};
+
+// Payoffs FastMonteCarlo evaluates on every path. Asians average the
+// underlying over the num_steps monitoring dates after the start; lookbacks
+// take its extremes over the start and the monitoring dates.
+enum class PathPayoff
+{
+    kEuropean,
+    // max(+-(A - K), 0) on the arithmetic mean A
+    kArithmeticAsian,
+    // max(+-(G - K), 0) on the geometric mean G, known in closed form
+    kGeometricAsian,
+    // max(S_max - K, 0) for calls, max(K - S_min, 0) for puts
+    kFixedLookback,
+    // S_T - S_min for calls, S_max - S_T for puts
+    kFloatingLookback
+};
+
+// Paths FastMonteCarlo simulates per option. Path p of option i takes its
+// normals from Philox counters (p, step / 2, i) under 'seed', so the draws
+// only depend on the settings, not on vector width, threads or how the paths
+// were split between calls. Estimates sum the payoffs in an order that
+// depends on the vector width and on the split, so they agree across targets
+// and splits up to rounding.
+struct MonteCarloSettings
+{
+    size_t num_paths{0};
+    // Equal steps to expiry. GBM samples the terminal underlying exactly, so
+    // European payoffs only need one.
+    size_t num_steps{1};
+    uint64_t seed{0};
+    PathPayoff payoff{PathPayoff::kEuropean};
+    // Pairs every path with its mirror on the negated normals, num_paths
+    // counts pairs
+    bool antithetic{false};
+    // Asians only, adds the closed-form mean less the payoff of the
+    // geometric Asian on the same path, so geometric Asians come out exact
+    bool control_variate{false};
+};
+
+// Non-owning view for inverting quoted prices into implied volatilities.
+// option_types (see OptionType) may be left empty if every quote is a call.
+// Quotes outside the no-arbitrage bounds of the model get a NaN volatility.
+template <typename T>
+struct ImpliedVolatilityView
+{
+    ImpliedVolatilityView(
+        std::span<const T> prices, std::span<const T> underlyings,
+        std::span<const T> strikes, std::span<const T> risk_free_rates,
+        std::span<const T> times_to_expiry,
+        std::span<const T> dividend_yields, std::span<T> volatilities,
+        std::span<const T> option_types = {})
+        : num_options(prices.size()),
+          prices(prices),
+          underlyings(underlyings),
+          strikes(strikes),
+          risk_free_rates(risk_free_rates),
+          times_to_expiry(times_to_expiry),
+          dividend_yields(dividend_yields),
+          volatilities(volatilities),
+          option_types(option_types)
+    {
+        assert(num_options == underlyings.size());
+        assert(num_options == strikes.size());
+        assert(num_options == risk_free_rates.size());
+        assert(num_options == times_to_expiry.size());
+        assert(num_options == dividend_yields.size());
+        assert(num_options <= volatilities.size());
+        assert(option_types.empty() || num_options == option_types.size());
+    }
+
+    size_t num_options;
+    std::span<const T> prices;
+    std::span<const T> underlyings;
+    std::span<const T> strikes;
+    std::span<const T> risk_free_rates;
+    std::span<const T> times_to_expiry;
+    std::span<const T> dividend_yields;
+    std::span<T> volatilities;
+    std::span<const T> option_types;
+};
+
+// Columns of outputs not in 'outputs' are left empty, so pricing with a
+// narrower Output mask does not pay for their memory.
 template <typename T>
 struct OptionPricing
 {
@@ -16,26 +478,40 @@ struct OptionPricing
         const std::vector<T>& risk_free_rates,
         const std::vector<T>& volatilities,
         const std::vector<T>& times_to_expiry,
-        const std::vector<T>& dividend_yields)
-        : num_options(underlyings.size()),
+        const std::vector<T>& dividend_yields,
+        const std::vector<T>& option_types = {},
+        uint32_t outputs = kAllOutputs)
+        : num_options(strikes.size()),
           underlyings(underlyings),
           strikes(strikes),
           risk_free_rates(risk_free_rates),
           volatilities(volatilities),
           times_to_expiry(times_to_expiry),
           dividend_yields(dividend_yields),
-          prices(std::vector<T>(underlyings.size(), 0)),
-          deltas(prices),
-          vegas(prices),
-          thetas(prices),
-          gammas(prices),
-          rhos(prices)
+          prices(output_column(outputs, kPrice, num_options)),
+          deltas(output_column(outputs, kDelta, num_options)),
+          vegas(output_column(outputs, kVega, num_options)),
+          thetas(output_column(outputs, kTheta, num_options)),
+          gammas(output_column(outputs, kGamma, num_options)),
+          rhos(output_column(outputs, kRho, num_options)),
+          option_types(option_types)
     {
-        assert(num_options == strikes.size());
-        assert(num_options == risk_free_rates.size());
+        assert(num_options == underlyings.size() || underlyings.empty());
         assert(num_options == volatilities.size());
-        assert(num_options == times_to_expiry.size());
-        assert(num_options == dividend_yields.size());
+        // Or all empty, see OptionPricingView
+        assert(num_options == risk_free_rates.size() ||
+               (risk_free_rates.empty() && times_to_expiry.empty() &&
+                dividend_yields.empty()));
+        assert(risk_free_rates.size() == times_to_expiry.size());
+        assert(risk_free_rates.size() == dividend_yields.size());
+        assert(option_types.empty() || num_options == option_types.size());
+    }
+
+    [[nodiscard]] OptionPricingView<T> view()
+    {
+        return {underlyings, strikes, risk_free_rates, volatilities,
+                times_to_expiry, dividend_yields, prices, deltas,
+                vegas, thetas, gammas, rhos, option_types};
     }
 
     const size_t num_options;
@@ -51,6 +527,46 @@ struct OptionPricing
     std::vector<T> thetas;
     std::vector<T> gammas;
     std::vector<T> rhos;
+    // OptionType<T>::kCall or kPut per option, only needed for price_mixed
+    const std::vector<T> option_types;
+
+   private:
+    [[nodiscard]] static std::vector<T> output_column(
+        uint32_t outputs, uint32_t output, size_t num_options)
+    {
+        return std::vector<T>((outputs & output) ? num_options : 0, 0);
+    }
+};
+
+// Owning put outputs for pricing both legs of OptionPricing in one pass.
+// Like OptionPricing, only allocates the columns in 'outputs'.
+template <typename T>
+struct PutPricing
+{
+    explicit PutPricing(size_t num_options, uint32_t outputs = kAllOutputs)
+        : prices(output_column(outputs, kPrice, num_options)),
+          deltas(output_column(outputs, kDelta, num_options)),
+          thetas(output_column(outputs, kTheta, num_options)),
+          rhos(output_column(outputs, kRho, num_options))
+    {
+    }
+
+    [[nodiscard]] PutPricingView<T> view()
+    {
+        return {prices, deltas, thetas, rhos};
+    }
+
+    std::vector<T> prices;
+    std::vector<T> deltas;
+    std::vector<T> thetas;
+    std::vector<T> rhos;
+
+   private:
+    [[nodiscard]] static std::vector<T> output_column(
+        uint32_t outputs, uint32_t output, size_t num_options)
+    {
+        return std::vector<T>((outputs & output) ? num_options : 0, 0);
+    }
 };
 
 template <typename T>
@@ -0,0 +1,205 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+#include "dynamic_black_scholes.h"
+
+#include <algorithm>
+#include <mutex>
+#include <type_traits>
+
+// Compile the pricing kernels once per target, see hwy/foreach_target.h
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "dynamic_black_scholes.cpp"
+#include <hwy/foreach_target.h>  // IWYU pragma: keep
+
+// Must come after foreach_target.h to avoid redefinition errors.
+#include <hwy/highway.h>
+#include "fast_barone_adesi_whaley.h"
+#include "fast_binomial_tree.h"
+#include "fast_black_scholes.h"
+#include "fast_implied_volatility.h"
+#include "fast_monte_carlo.h"
+#include "fast_option_records.h"
+#include "fast_portfolio.h"
+#include "fast_scenario_grid.h"
+#include "fast_spot_tick.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace fast_option_pricer {
+namespace HWY_NAMESPACE {
+
+int64_t DispatchedTarget()
+{
+    return HWY_TARGET;
+}
+
+// Entries of DynamicKernels forwarding to the engine's static member NAME.
+// The generic lambdas convert to the table's function pointers, whose
+// signatures fix 'args', references included.
+#define FAST_OPTION_PRICER_KERNEL(ENGINE, NAME) \
+    [](auto... args) { return ENGINE::NAME(args...); }
+
+// Call, put and mixed entries from NAME<true>, NAME<false> and NAME_mixed
+#define FAST_OPTION_PRICER_LEGS(ENGINE, NAME)                     \
+    {[](auto... args) { ENGINE::template NAME<true>(args...); },  \
+     [](auto... args) { ENGINE::template NAME<false>(args...); }, \
+     [](auto... args) { ENGINE::NAME##_mixed(args...); }}
+
+// Legs of FastBlackScholes::NAME storing only the OUTPUTS columns
+#define FAST_OPTION_PRICER_MASKED_LEGS(ENGINE, NAME, OUTPUTS)               \
+    {[](auto... args) { ENGINE::template NAME<true, OUTPUTS>(args...); },  \
+     [](auto... args) { ENGINE::template NAME<false, OUTPUTS>(args...); }, \
+     [](auto... args) { ENGINE::template NAME##_mixed<OUTPUTS>(args...); }}
+
+// As FAST_OPTION_PRICER_KERNEL, for NAME<OUTPUTS>
+#define FAST_OPTION_PRICER_MASKED_KERNEL(ENGINE, NAME, OUTPUTS) \
+    [](auto... args) { ENGINE::template NAME<OUTPUTS>(args...); }
+
+// The kAllOutputs and kPrice entries of MASKED, see DynamicKernels::Mask
+#define FAST_OPTION_PRICER_MASKS(MASKED, ENGINE, NAME) \
+    {{MASKED(ENGINE, NAME, kAllOutputs), MASKED(ENGINE, NAME, kPrice)}}
+
+// The table of this target. A new engine adds its member to DynamicKernels,
+// one entry here and a forwarding method to DynamicBlackScholes.
+template <typename T>
+const DynamicKernels<T>& Kernels()
+{
+    using D = hn::ScalableTag<T>;
+    using Pricer = FastBlackScholes<T, D>;
+    using StreamingPricer = FastBlackScholes<
+        T, D, Accuracy::kExact, Precision::kFull, Stores::kStreaming>;
+    using SpotTick = FastSpotTick<T, D>;
+    using Tree = FastBinomialTree<T, D>;
+    using Approximation = FastBaroneAdesiWhaley<T, D>;
+    using MonteCarlo = FastMonteCarlo<T, D>;
+    using ScenarioGrid = FastScenarioGrid<T, D>;
+    using ImpliedVolatility = FastImpliedVolatility<T, D>;
+    using Records = FastOptionRecords<T, D>;
+    using Portfolio = FastPortfolio<T, D>;
+
+    static constexpr DynamicKernels<T> kKernels{
+        .price =
+            {{FAST_OPTION_PRICER_MASKS(
+                  FAST_OPTION_PRICER_MASKED_LEGS, Pricer, price),
+              FAST_OPTION_PRICER_MASKS(
+                  FAST_OPTION_PRICER_MASKED_LEGS, StreamingPricer, price)}},
+        .price_call_put =
+            {{FAST_OPTION_PRICER_MASKS(
+                  FAST_OPTION_PRICER_MASKED_KERNEL, Pricer, price_call_put),
+              FAST_OPTION_PRICER_MASKS(
+                  FAST_OPTION_PRICER_MASKED_KERNEL, StreamingPricer,
+                  price_call_put)}},
+        .cache_bucket_terms =
+            FAST_OPTION_PRICER_KERNEL(Pricer, cache_bucket_terms),
+        .price_bucketed = FAST_OPTION_PRICER_LEGS(Pricer, price_bucketed),
+        .price_chain = FAST_OPTION_PRICER_LEGS(Pricer, price_chain),
+        .reprice_dirty = FAST_OPTION_PRICER_LEGS(Pricer, reprice_dirty),
+        .cache_spot_inputs = FAST_OPTION_PRICER_KERNEL(SpotTick, cache_inputs),
+        .price_spot_tick = FAST_OPTION_PRICER_LEGS(SpotTick, price),
+        .price_american = FAST_OPTION_PRICER_LEGS(Tree, price),
+        .price_american_approximation =
+            FAST_OPTION_PRICER_LEGS(Approximation, price),
+        .price_monte_carlo = FAST_OPTION_PRICER_LEGS(MonteCarlo, price),
+        .accumulate_monte_carlo =
+            FAST_OPTION_PRICER_LEGS(MonteCarlo, accumulate),
+        .finish_monte_carlo = FAST_OPTION_PRICER_KERNEL(MonteCarlo, finish),
+        .simulate_paths = FAST_OPTION_PRICER_KERNEL(MonteCarlo, simulate),
+        .revalue_scenarios = FAST_OPTION_PRICER_KERNEL(ScenarioGrid, revalue),
+        .aggregate_scenarios =
+            FAST_OPTION_PRICER_KERNEL(ScenarioGrid, aggregate),
+        .implied_volatility =
+            FAST_OPTION_PRICER_KERNEL(ImpliedVolatility, implied_volatility),
+        .ingest = FAST_OPTION_PRICER_KERNEL(Records, ingest),
+        .write_results = FAST_OPTION_PRICER_KERNEL(Records, write_results),
+        .aggregate = FAST_OPTION_PRICER_KERNEL(Portfolio, aggregate)};
+    return kKernels;
+}
+
+#undef FAST_OPTION_PRICER_KERNEL
+#undef FAST_OPTION_PRICER_LEGS
+#undef FAST_OPTION_PRICER_MASKED_LEGS
+#undef FAST_OPTION_PRICER_MASKED_KERNEL
+#undef FAST_OPTION_PRICER_MASKS
+
+const DynamicKernels<double>& KernelsDouble()
+{
+    return Kernels<double>();
+}
+
+const DynamicKernels<float>& KernelsFloat()
+{
+    return Kernels<float>();
+}
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+}  // namespace fast_option_pricer
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+
+namespace fast_option_pricer {
+
+HWY_EXPORT(DispatchedTarget);
+HWY_EXPORT(KernelsDouble);
+HWY_EXPORT(KernelsFloat);
+
+template <IsFloatOrDouble T>
+const DynamicKernels<T>& DynamicBlackScholes<T>::kernels()
+{
+    if constexpr (std::is_same_v<T, double>) {
+        return HWY_DYNAMIC_DISPATCH(KernelsDouble)();
+    } else {
+        return HWY_DYNAMIC_DISPATCH(KernelsFloat)();
+    }
+}
+
+template const DynamicKernels<double>& DynamicBlackScholes<double>::kernels();
+template const DynamicKernels<float>& DynamicBlackScholes<float>::kernels();
+
+int64_t dispatched_target()
+{
+    return HWY_DYNAMIC_DISPATCH(DispatchedTarget)();
+}
+
+const char* dispatched_target_name()
+{
+    return hwy::TargetName(dispatched_target());
+}
+
+std::vector<int64_t> available_targets()
+{
+    // Captured before the first force_target(): once dispatch is restricted,
+    // Highway only reports the forced target as supported.
+    static const std::vector<int64_t> targets =
+        hwy::SupportedAndGeneratedTargets();
+    return targets;
+}
+
+// Serialises overrides, so the supported targets and the chosen target are
+// updated as a pair. Dispatching calls do not take it, see force_target.
+static std::mutex target_override_mutex;
+
+bool force_target(int64_t target)
+{
+    const std::vector<int64_t> targets = available_targets();
+    if (std::find(targets.begin(), targets.end(), target) == targets.end()) {
+        return false;
+    }
+    const std::lock_guard<std::mutex> lock(target_override_mutex);
+    hwy::SetSupportedTargetsForTest(target);
+    hwy::GetChosenTarget().Update(hwy::SupportedTargets());
+    return true;
+}
+
+void reset_target()
+{
+    const std::lock_guard<std::mutex> lock(target_override_mutex);
+    hwy::SetSupportedTargetsForTest(0);
+    hwy::GetChosenTarget().Update(hwy::SupportedTargets());
+}
+
+}  // namespace fast_option_pricer
+
+#endif  // HWY_ONCE
@@ -0,0 +1,468 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+#pragma once
+
+#include <hwy/base.h>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "aligned_option_pricing.h"
+#include "bucket_terms.h"
+#include "cache_info.h"
+#include "common.h"
+#include "spot_cache.h"
+
+namespace fast_option_pricer {
+
+// Entry points of one Highway target, filled in by dynamic_black_scholes.cpp
+// for every compiled target. Engines with call, put and mixed variants have
+// one entry per Leg; price and price_call_put also have one per Mask, the
+// output masks they are compiled for, each with cached stores (index 0) and
+// streaming stores (index 1), see Stores.
+template <IsFloatOrDouble T>
+struct DynamicKernels
+{
+    enum Leg : size_t
+    {
+        kCall,
+        kPut,
+        kMixed
+    };
+
+    enum Mask : size_t
+    {
+        kAllOutputsMask,
+        kPriceMask
+    };
+
+    template <uint32_t Outputs>
+    static constexpr bool kHasMask =
+        Outputs == kAllOutputs || Outputs == kPrice;
+
+    template <typename... Args>
+    using Legs = std::array<void (*)(Args...), 3>;
+    template <typename Kernel>
+    using Masks = std::array<Kernel, 2>;
+    template <typename Kernel>
+    using Streams = std::array<Kernel, 2>;
+    using View = OptionPricingView<T>;
+
+    Streams<Masks<Legs<const View&>>> price;
+    Streams<Masks<void (*)(const View&, const PutPricingView<T>&)>>
+        price_call_put;
+    void (*cache_bucket_terms)(const TermStructureView<T>&, BucketTerms<T>&);
+    Legs<const View&, const TermStructureView<T>&, BucketTerms<T>&>
+        price_bucketed;
+    Legs<const StrikeChain<T>&, const View&> price_chain;
+    Legs<AlignedOptionPricing<T>&> reprice_dirty;
+    void (*cache_spot_inputs)(const View&, SpotCache<T>&);
+    Legs<const View&, SpotCache<T>&> price_spot_tick;
+    Legs<const View&, size_t> price_american;
+    Legs<const View&> price_american_approximation;
+    Legs<const View&, const MonteCarloSettings&, std::span<T>>
+        price_monte_carlo;
+    Legs<
+        const View&, const MonteCarloSettings&, size_t, size_t, std::span<T>,
+        std::span<T>>
+        accumulate_monte_carlo;
+    void (*finish_monte_carlo)(
+        const View&, const MonteCarloSettings&, std::span<const T>,
+        std::span<const T>, std::span<T>);
+    void (*simulate_paths)(
+        const View&, size_t, const MonteCarloSettings&, std::span<T>);
+    void (*revalue_scenarios)(
+        const View&, const ScenarioGridView<T>&, std::span<T>, size_t);
+    void (*aggregate_scenarios)(
+        const View&, const ScenarioGridView<T>&, std::span<const T>,
+        std::span<T>);
+    void (*implied_volatility)(const ImpliedVolatilityView<T>&);
+    void (*ingest)(std::span<const OptionRecord<T>>, AlignedOptionPricing<T>&);
+    void (*write_results)(const View&, std::span<OptionResult<T>>);
+    OptionResult<T> (*aggregate)(const View&, std::span<const T>);
+};
+
+// Aborts unless 'op' has a column of at least op.num_options values for every
+// output in 'outputs'. The engines only assert has_outputs, which release
+// builds compile out, and would then write past the end of a short column.
+template <IsFloatOrDouble T>
+void require_outputs(const OptionPricingView<T>& op, uint32_t outputs)
+{
+    if (!op.has_outputs(outputs)) {
+        HWY_ABORT("Output columns hold fewer than %zu options", op.num_options);
+    }
+}
+
+template <IsFloatOrDouble T>
+void require_outputs(
+    const PutPricingView<T>& put, uint32_t outputs, size_t num_options)
+{
+    if (!put.has_outputs(outputs, num_options)) {
+        HWY_ABORT(
+            "Put output columns hold fewer than %zu options", num_options);
+    }
+}
+
+// Same kernel as FastBlackScholes, compiled once per Highway target in
+// dynamic_black_scholes.cpp and dispatched at runtime to the best target the
+// host CPU supports (e.g. AVX2 on older nodes, AVX3 on newer ones).
+//
+// price, price_call_put and price_mixed take an Outputs mask of kAllOutputs
+// or kPrice, and a Stores choice that decides kAuto on the view's whole
+// batch; every other entry point stores all the outputs its engine computes
+// through the caches. Each call checks that the view has a column for every
+// output it stores and aborts otherwise, in release builds too.
+template <IsFloatOrDouble T = double>
+class DynamicBlackScholes
+{
+    using Kernels = DynamicKernels<T>;
+
+   public:
+    // Default number of steps of price_american's trees
+    static constexpr size_t kNumTreeSteps = 200;
+
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    static void price(OptionPricing<T>& op, Stores stores = Stores::kCached)
+    {
+        price<Call, Outputs>(op.view(), stores);
+    }
+
+    // Also marks every option of 'op' clean, see reprice_dirty
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    static void price(
+        AlignedOptionPricing<T>& op, Stores stores = Stores::kCached)
+    {
+        price<Call, Outputs>(op.view(), stores);
+        op.mark_all_clean();
+    }
+
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    static void price(
+        const OptionPricingView<T>& op, Stores stores = Stores::kCached)
+    {
+        static_assert(Kernels::template kHasMask<Outputs>);
+        require_outputs(op, Outputs);
+        const bool streamed =
+            streams(stores, op, pass_columns(Outputs, false, false));
+        kernels().price[streamed][mask<Outputs>][leg<Call>](op);
+    }
+
+    // See FastBlackScholes::price_call_put
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_call_put(
+        OptionPricing<T>& op, PutPricing<T>& put,
+        Stores stores = Stores::kCached)
+    {
+        price_call_put<Outputs>(op.view(), put.view(), stores);
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_call_put(
+        const OptionPricingView<T>& op, const PutPricingView<T>& put,
+        Stores stores = Stores::kCached)
+    {
+        static_assert(Kernels::template kHasMask<Outputs>);
+        require_outputs(op, Outputs);
+        require_outputs(put, Outputs, op.num_options);
+        const bool streamed =
+            streams(stores, op, pass_columns(Outputs, false, true));
+        kernels().price_call_put[streamed][mask<Outputs>](op, put);
+    }
+
+    // See FastBlackScholes::price_mixed
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_mixed(
+        OptionPricing<T>& op, Stores stores = Stores::kCached)
+    {
+        price_mixed<Outputs>(op.view(), stores);
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_mixed(
+        AlignedOptionPricing<T>& op, Stores stores = Stores::kCached)
+    {
+        price_mixed<Outputs>(op.view(), stores);
+        op.mark_all_clean();
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_mixed(
+        const OptionPricingView<T>& op, Stores stores = Stores::kCached)
+    {
+        static_assert(Kernels::template kHasMask<Outputs>);
+        require_outputs(op, Outputs);
+        const bool streamed =
+            streams(stores, op, pass_columns(Outputs, true, false));
+        kernels().price[streamed][mask<Outputs>][Kernels::kMixed](op);
+    }
+
+    // See FastBlackScholes::cache_bucket_terms
+    static void cache_bucket_terms(
+        const TermStructureView<T>& ts, BucketTerms<T>& terms)
+    {
+        kernels().cache_bucket_terms(ts, terms);
+    }
+
+    // See FastBlackScholes::price_bucketed
+    template <bool Call = true>
+    static void price_bucketed(
+        const OptionPricingView<T>& op, const TermStructureView<T>& ts,
+        BucketTerms<T>& terms)
+    {
+        require_outputs(op, kAllOutputs);
+        kernels().price_bucketed[leg<Call>](op, ts, terms);
+    }
+
+    static void price_bucketed_mixed(
+        const OptionPricingView<T>& op, const TermStructureView<T>& ts,
+        BucketTerms<T>& terms)
+    {
+        require_outputs(op, kAllOutputs);
+        kernels().price_bucketed[Kernels::kMixed](op, ts, terms);
+    }
+
+    // See FastBlackScholes::price_chain
+    template <bool Call = true>
+    static void price_chain(
+        const StrikeChain<T>& chain, const OptionPricingView<T>& op)
+    {
+        require_outputs(op, kAllOutputs);
+        kernels().price_chain[leg<Call>](chain, op);
+    }
+
+    static void price_chain_mixed(
+        const StrikeChain<T>& chain, const OptionPricingView<T>& op)
+    {
+        require_outputs(op, kAllOutputs);
+        kernels().price_chain[Kernels::kMixed](chain, op);
+    }
+
+    // See FastBlackScholes::reprice_dirty
+    template <bool Call = true>
+    static void reprice_dirty(AlignedOptionPricing<T>& op)
+    {
+        kernels().reprice_dirty[leg<Call>](op);
+    }
+
+    static void reprice_dirty_mixed(AlignedOptionPricing<T>& op)
+    {
+        kernels().reprice_dirty[Kernels::kMixed](op);
+    }
+
+    // See FastSpotTick
+    static void cache_spot_inputs(
+        const OptionPricingView<T>& op, SpotCache<T>& cache)
+    {
+        kernels().cache_spot_inputs(op, cache);
+    }
+
+    template <bool Call = true>
+    static void price_spot_tick(
+        const OptionPricingView<T>& op, SpotCache<T>& cache)
+    {
+        require_outputs(op, kAllOutputs);
+        kernels().price_spot_tick[leg<Call>](op, cache);
+    }
+
+    static void price_spot_tick_mixed(
+        const OptionPricingView<T>& op, SpotCache<T>& cache)
+    {
+        require_outputs(op, kAllOutputs);
+        kernels().price_spot_tick[Kernels::kMixed](op, cache);
+    }
+
+    // See FastBinomialTree
+    template <bool Call = true>
+    static void price_american(
+        const OptionPricingView<T>& op, size_t num_steps = kNumTreeSteps)
+    {
+        require_outputs(op, kAllOutputs);
+        kernels().price_american[leg<Call>](op, num_steps);
+    }
+
+    static void price_american_mixed(
+        const OptionPricingView<T>& op, size_t num_steps = kNumTreeSteps)
+    {
+        require_outputs(op, kAllOutputs);
+        kernels().price_american[Kernels::kMixed](op, num_steps);
+    }
+
+    // See FastBaroneAdesiWhaley
+    template <bool Call = true>
+    static void price_american_approximation(const OptionPricingView<T>& op)
+    {
+        require_outputs(op, kPrice);
+        kernels().price_american_approximation[leg<Call>](op);
+    }
+
+    static void price_american_approximation_mixed(
+        const OptionPricingView<T>& op)
+    {
+        require_outputs(op, kPrice);
+        kernels().price_american_approximation[Kernels::kMixed](op);
+    }
+
+    // See FastMonteCarlo
+    template <bool Call = true>
+    static void price_monte_carlo(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        std::span<T> standard_errors = {})
+    {
+        require_outputs(op, kPrice);
+        kernels().price_monte_carlo[leg<Call>](op, settings, standard_errors);
+    }
+
+    static void price_monte_carlo_mixed(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        std::span<T> standard_errors = {})
+    {
+        require_outputs(op, kPrice);
+        kernels().price_monte_carlo[Kernels::kMixed](
+            op, settings, standard_errors);
+    }
+
+    template <bool Call = true>
+    static void accumulate_monte_carlo(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        size_t first_path, size_t num_paths, std::span<T> sums,
+        std::span<T> sums_of_squares)
+    {
+        kernels().accumulate_monte_carlo[leg<Call>](
+            op, settings, first_path, num_paths, sums, sums_of_squares);
+    }
+
+    static void accumulate_monte_carlo_mixed(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        size_t first_path, size_t num_paths, std::span<T> sums,
+        std::span<T> sums_of_squares)
+    {
+        kernels().accumulate_monte_carlo[Kernels::kMixed](
+            op, settings, first_path, num_paths, sums, sums_of_squares);
+    }
+
+    static void finish_monte_carlo(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        std::span<const T> sums, std::span<const T> sums_of_squares,
+        std::span<T> standard_errors = {})
+    {
+        require_outputs(op, kPrice);
+        kernels().finish_monte_carlo(
+            op, settings, sums, sums_of_squares, standard_errors);
+    }
+
+    static void simulate_paths(
+        const OptionPricingView<T>& op, size_t i,
+        const MonteCarloSettings& settings, std::span<T> paths)
+    {
+        kernels().simulate_paths(op, i, settings, paths);
+    }
+
+    // See FastScenarioGrid::revalue
+    static void revalue_scenarios(
+        const OptionPricingView<T>& op, const ScenarioGridView<T>& grid,
+        std::span<T> pnl)
+    {
+        revalue_scenarios(op, grid, pnl, op.num_options);
+    }
+
+    static void revalue_scenarios(
+        const OptionPricingView<T>& op, const ScenarioGridView<T>& grid,
+        std::span<T> pnl, size_t stride)
+    {
+        kernels().revalue_scenarios(op, grid, pnl, stride);
+    }
+
+    // See FastScenarioGrid::aggregate
+    static void aggregate_scenarios(
+        const OptionPricingView<T>& op, const ScenarioGridView<T>& grid,
+        std::span<const T> positions, std::span<T> totals)
+    {
+        kernels().aggregate_scenarios(op, grid, positions, totals);
+    }
+
+    // See FastImpliedVolatility
+    static void implied_volatility(const ImpliedVolatilityView<T>& iv)
+    {
+        kernels().implied_volatility(iv);
+    }
+
+    // See FastOptionRecords
+    static void ingest(
+        std::span<const OptionRecord<T>> records, AlignedOptionPricing<T>& op)
+    {
+        kernels().ingest(records, op);
+    }
+
+    static void write_results(
+        OptionPricing<T>& op, std::span<OptionResult<T>> results)
+    {
+        write_results(op.view(), results);
+    }
+
+    static void write_results(
+        AlignedOptionPricing<T>& op, std::span<OptionResult<T>> results)
+    {
+        write_results(op.view(), results);
+    }
+
+    static void write_results(
+        const OptionPricingView<T>& op, std::span<OptionResult<T>> results)
+    {
+        require_outputs(op, kAllOutputs);
+        kernels().write_results(op, results);
+    }
+
+    // See FastPortfolio
+    [[nodiscard]] static OptionResult<T> aggregate(
+        const OptionPricingView<T>& op, std::span<const T> positions)
+    {
+        require_outputs(op, kAllOutputs);
+        return kernels().aggregate(op, positions);
+    }
+
+   private:
+    template <bool Call>
+    static constexpr size_t leg = Call ? Kernels::kCall : Kernels::kPut;
+    template <uint32_t Outputs>
+    static constexpr size_t mask =
+        Outputs == kAllOutputs ? Kernels::kAllOutputsMask : Kernels::kPriceMask;
+
+    // Whether a pass over all of 'op' touching 'columns' per option streams
+    static bool streams(
+        Stores stores, const OptionPricingView<T>& op, size_t columns)
+    {
+        return streams_outputs(stores, op.num_options * columns * sizeof(T));
+    }
+
+    // Kernels of the target dispatch currently picks
+    static const Kernels& kernels();
+};
+
+// Highway target (HWY_AVX2, HWY_AVX3, ...) that DynamicBlackScholes currently
+// dispatches to.
+[[nodiscard]] int64_t dispatched_target();
+
+// Human-readable name of dispatched_target().
+[[nodiscard]] const char* dispatched_target_name();
+
+// Targets that were compiled into the library and are supported by the host,
+// best first.
+[[nodiscard]] std::vector<int64_t> available_targets();
+
+// Restricts dispatch to 'target'. Returns false and leaves dispatch unchanged
+// if 'target' is not one of available_targets().
+//
+// For tests and benchmarks only: this goes through Highway's test hook
+// SetSupportedTargetsForTest and switches dispatch for the whole process.
+// It is not thread-safe against pricing calls in flight on other threads,
+// e.g. ThreadPool tasks of ParallelBlackScholes; call it while no other
+// thread prices.
+bool force_target(int64_t target);
+
+// Undoes force_target(), dispatching to the best available target again.
+// Same restrictions as force_target.
+void reset_target();
+
+}  // namespace fast_option_pricer
@@ -0,0 +1,317 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+// Per-target include guard, see hwy/highway.h and math-inl.h
+#if defined(FAST_OPTION_PRICER_FAST_BARONE_ADESI_WHALEY_H_) == \
+    defined(HWY_TARGET_TOGGLE)
+#ifdef FAST_OPTION_PRICER_FAST_BARONE_ADESI_WHALEY_H_
+#undef FAST_OPTION_PRICER_FAST_BARONE_ADESI_WHALEY_H_
+#else
+#define FAST_OPTION_PRICER_FAST_BARONE_ADESI_WHALEY_H_
+#endif
+
+#include <hwy/highway.h>
+#include <cassert>
+#include <type_traits>
+#include "common.h"
+#include "fast_black_scholes.h"
+#include "fast_math_helper.h"
+#include "math-inl.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace fast_option_pricer {
+namespace HWY_NAMESPACE {
+
+namespace hn = hwy::HWY_NAMESPACE;
+
+// American prices from the Barone-Adesi-Whaley quadratic approximation: the
+// European price plus an early exercise premium A * (S / S*)^q, where the
+// critical underlying S* solves a scalar equation per option. Every lane
+// runs Newton's method on its own S* and drops out of the iteration once it
+// has converged, so a vector costs a handful of European evaluations.
+//
+// Calls on underlyings without a dividend yield, and puts at non-positive
+// rates, are never exercised early and get their European price. Expired
+// options get their payoff. Like FastBlackScholes and FastBinomialTree, the
+// underlying drifts at the cost of carry r - q. Only prices are computed;
+// FastBinomialTree has tree greeks.
+template <
+    IsFloatOrDouble T = double, typename D = hn::ScalableTag<T>,
+    Accuracy A = Accuracy::kExact>
+class FastBaroneAdesiWhaley
+{
+   public:
+    using VecT = hn::Vec<D>;
+    using Pricer = FastBlackScholes<T, D, A>;
+    using Access = typename Pricer::Access;
+    using Legs = typename Pricer::Legs;
+
+    template <bool Call = true>
+    static void price(const OptionPricingView<T>& op)
+    {
+        constexpr Legs L = Call ? Legs::kCall : Legs::kPut;
+        price_legs<L>(op);
+    }
+
+    // See FastBlackScholes::price_mixed
+    static void price_mixed(const OptionPricingView<T>& op)
+    {
+        assert(op.num_options == op.option_types.size());
+        price_legs<Legs::kMixed>(op);
+    }
+
+   private:
+    // |S* - K - European(S*) - premium(S*)| relative to K at which a lane
+    // stops iterating
+    static constexpr T kTolerance = std::is_same_v<T, double> ? 1e-10 : 1e-5;
+    static constexpr size_t kMaxIterations = 32;
+    // |rT| below which 1 - e^(-rT) is taken from its series, as it cancels
+    static constexpr T kSmallRateTime =
+        std::is_same_v<T, double> ? 1e-5 : 1e-2;
+
+    template <Legs L>
+    static void price_legs(const OptionPricingView<T>& op)
+    {
+        assert(op.has_input_columns());
+        assert(op.has_outputs(kPrice));
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+
+        size_t i = 0;
+        for (; i + lanes <= op.num_options; i += lanes) {
+            price_vector<L, Access::kUnaligned>(op, i, lanes);
+        }
+        // Remainder of a batch that is not a multiple of lanes
+        if (i < op.num_options) {
+            price_vector<L, Access::kPartial>(op, i, op.num_options - i);
+        }
+    }
+
+    template <Legs L, Access Mode>
+    static inline void price_vector(
+        const OptionPricingView<T>& op, size_t i, size_t count)
+    {
+        constexpr D d;
+        const VecT underlying = load<Mode>(op.underlyings.data() + i, count);
+        const VecT strike = load<Mode>(op.strikes.data() + i, count);
+        const VecT risk_free_rate =
+            load<Mode>(op.risk_free_rates.data() + i, count);
+        const VecT volatility = load<Mode>(op.volatilities.data() + i, count);
+        const VecT time_to_expiry =
+            load<Mode>(op.times_to_expiry.data() + i, count);
+        const VecT dividend_yield =
+            load<Mode>(op.dividend_yields.data() + i, count);
+        // +1 for calls and -1 for puts, see OptionType
+        VecT sign = hn::Set(d, L == Legs::kPut ? T{-1} : T{1});
+        if constexpr (L == Legs::kMixed) {
+            sign = load<Mode>(op.option_types.data() + i, count);
+        }
+
+        const VecT zero = hn::Zero(d);
+        const VecT one = hn::Set(d, static_cast<T>(1.0));
+        const VecT two = hn::Set(d, static_cast<T>(2.0));
+        const VecT half = hn::Set(d, static_cast<T>(0.5));
+        const VecT carry = hn::Sub(risk_free_rate, dividend_yield);
+        const VecT root_t = hn::Sqrt(time_to_expiry);
+        const VecT sigma_root_t = hn::Mul(volatility, root_t);
+        const VecT e_qt = FastMathHelper::exp<VecT, T, D, d, A>(
+            hn::Neg(hn::Mul(time_to_expiry, dividend_yield)));
+        const VecT e_rt = FastMathHelper::exp<VecT, T, D, d, A>(
+            hn::Neg(hn::Mul(time_to_expiry, risk_free_rate)));
+
+        // Exponent of the premium, q2 for calls and q1 for puts
+        const VecT variance = hn::Mul(volatility, volatility);
+        const VecT m = hn::Div(hn::Mul(two, risk_free_rate), variance);
+        const VecT n_minus_one =
+            hn::Sub(hn::Div(hn::Mul(two, carry), variance), one);
+        const VecT n_minus_one_squared = hn::Mul(n_minus_one, n_minus_one);
+        // m / (1 - e^(-rT)) = 2 / (sigma^2 T) * rT / (1 - e^(-rT)), whose
+        // last factor is 1 + rT / 2 near r = 0 rather than 0 / 0
+        const VecT rate_time = hn::Mul(risk_free_rate, time_to_expiry);
+        const VecT m_over_k = hn::Mul(
+            hn::Div(two, hn::Mul(variance, time_to_expiry)),
+            hn::IfThenElse(
+                hn::Lt(hn::Abs(rate_time), hn::Set(d, kSmallRateTime)),
+                hn::MulAdd(half, rate_time, one),
+                hn::Div(rate_time, hn::Sub(one, e_rt))));
+        const VecT exponent = hn::Mul(
+            half,
+            hn::MulAdd(
+                sign,
+                hn::Sqrt(hn::MulAdd(
+                    hn::Set(d, static_cast<T>(4.0)), m_over_k,
+                    n_minus_one_squared)),
+                hn::Neg(n_minus_one)));
+
+        // Seed S* from its limit at infinite expiry
+        const VecT infinite_exponent = hn::Mul(
+            half,
+            hn::MulAdd(
+                sign,
+                hn::Sqrt(hn::MulAdd(
+                    hn::Set(d, static_cast<T>(4.0)), m, n_minus_one_squared)),
+                hn::Neg(n_minus_one)));
+        const VecT infinite_critical =
+            hn::Div(strike, hn::Sub(one, hn::Div(one, infinite_exponent)));
+        const VecT h = hn::Div(
+            hn::Neg(hn::Mul(
+                hn::MulAdd(
+                    sign, hn::Mul(carry, time_to_expiry),
+                    hn::Mul(two, sigma_root_t)),
+                strike)),
+            hn::Mul(sign, hn::Sub(infinite_critical, strike)));
+        VecT critical = hn::MulAdd(
+            hn::Sub(strike, infinite_critical),
+            FastMathHelper::exp<VecT, T, D, d, A>(h), infinite_critical);
+
+        // Never exercised early, so never iterated
+        const auto european_only = hn::Or(
+            hn::And(hn::Gt(sign, zero), hn::Le(dividend_yield, zero)),
+            hn::And(hn::Lt(sign, zero), hn::Le(risk_free_rate, zero)));
+        // Worth their payoff, where d1 and the premium are 0 / 0
+        const auto expired = hn::Le(time_to_expiry, zero);
+
+        // Newton's method on
+        // sign * (S* - K) = European(S*) + premium(S*), per lane
+        VecT rhs, slope, n_sign_d1;
+        critical_terms(
+            sign, critical, strike, carry, time_to_expiry, sigma_root_t,
+            e_qt, e_rt, exponent, rhs, slope, n_sign_d1);
+        const VecT tolerance = hn::Mul(hn::Set(d, kTolerance), strike);
+        auto active = hn::AndNot(
+            hn::Or(european_only, expired),
+            hn::Gt(
+                hn::Abs(hn::Sub(
+                    hn::Mul(sign, hn::Sub(critical, strike)), rhs)),
+                tolerance));
+        for (size_t iteration = 0;
+             iteration < kMaxIterations && !hn::AllFalse(d, active);
+             ++iteration) {
+            const VecT next = hn::Sub(
+                critical,
+                hn::Div(
+                    hn::Sub(hn::Mul(sign, hn::Sub(critical, strike)), rhs),
+                    hn::Sub(sign, slope)));
+            critical = hn::IfThenElse(active, next, critical);
+            critical_terms(
+                sign, critical, strike, carry, time_to_expiry, sigma_root_t,
+                e_qt, e_rt, exponent, rhs, slope, n_sign_d1);
+            active = hn::And(
+                active,
+                hn::Gt(
+                    hn::Abs(hn::Sub(
+                        hn::Mul(sign, hn::Sub(critical, strike)), rhs)),
+                    tolerance));
+        }
+
+        // A = sign * (S* / q) * (1 - e^(-qT) * N(sign * d1(S*)))
+        const VecT premium_scale = hn::Mul(
+            sign,
+            hn::Mul(
+                hn::Div(critical, exponent),
+                hn::NegMulAdd(e_qt, n_sign_d1, one)));
+        VecT european, unused_pdf, unused_cdf;
+        european_terms(
+            sign, underlying, strike, carry, time_to_expiry, sigma_root_t,
+            e_qt, e_rt, european, unused_pdf, unused_cdf);
+        const VecT american = hn::MulAdd(
+            premium_scale,
+            FastMathHelper::exp<VecT, T, D, d, A>(hn::Mul(
+                exponent,
+                FastMathHelper::log<VecT, T, D, d, A>(
+                    hn::Div(underlying, critical)))),
+            european);
+        // Beyond S* the option is worth exercising now
+        const VecT exercised = hn::Mul(sign, hn::Sub(underlying, strike));
+        const VecT price = hn::IfThenElse(
+            hn::Ge(hn::Mul(sign, hn::Sub(underlying, critical)), zero),
+            exercised, american);
+
+        store<Mode>(
+            hn::IfThenElse(
+                expired, hn::Max(exercised, zero),
+                hn::IfThenElse(european_only, european, price)),
+            op.prices.data() + i, count);
+    }
+
+    // European price at 'underlying', with the pdf(d1) and N(sign * d1) that
+    // its derivative in the underlying needs
+    static inline void european_terms(
+        const VecT& sign, const VecT& underlying, const VecT& strike,
+        const VecT& carry, const VecT& time_to_expiry,
+        const VecT& sigma_root_t, const VecT& e_qt, const VecT& e_rt,
+        VecT& price, VecT& pdf_d1, VecT& n_sign_d1)
+    {
+        constexpr D d;
+        // d1 with the cost of carry r - q in place of the rate
+        const VecT d1 = Pricer::template calc_d1<d>(
+            underlying, strike, carry, hn::Zero(d), time_to_expiry,
+            sigma_root_t);
+        const VecT d2 = Pricer::calc_d2(d1, sigma_root_t);
+        n_sign_d1 =
+            FastMathHelper::normal_cdf<VecT, T, D, d, A>(hn::Mul(sign, d1));
+        const VecT n_sign_d2 =
+            FastMathHelper::normal_cdf<VecT, T, D, d, A>(hn::Mul(sign, d2));
+        pdf_d1 = FastMathHelper::normal_pdf<VecT, T, D, d, A>(d1);
+        price = hn::Mul(
+            sign,
+            hn::Sub(
+                hn::Mul(hn::Mul(underlying, e_qt), n_sign_d1),
+                hn::Mul(hn::Mul(strike, e_rt), n_sign_d2)));
+    }
+
+    // European(S) + premium(S) at S = 'critical', and its derivative in S
+    static inline void critical_terms(
+        const VecT& sign, const VecT& critical, const VecT& strike,
+        const VecT& carry, const VecT& time_to_expiry,
+        const VecT& sigma_root_t, const VecT& e_qt, const VecT& e_rt,
+        const VecT& exponent, VecT& rhs, VecT& slope, VecT& n_sign_d1)
+    {
+        constexpr D d;
+        const VecT one = hn::Set(d, static_cast<T>(1.0));
+        VecT european, pdf_d1;
+        european_terms(
+            sign, critical, strike, carry, time_to_expiry, sigma_root_t,
+            e_qt, e_rt, european, pdf_d1, n_sign_d1);
+        // premium(S) = sign * (1 - e^(-qT) * N(sign * d1)) * S / q
+        const VecT not_exercised = hn::NegMulAdd(e_qt, n_sign_d1, one);
+        rhs = hn::MulAdd(
+            hn::Mul(sign, not_exercised), hn::Div(critical, exponent),
+            european);
+        // sign * e^(-qT) * N(sign * d1) from the European price, then the
+        // derivative of the premium
+        slope = hn::Sub(
+            hn::Mul(
+                sign,
+                hn::Add(
+                    hn::Mul(e_qt, n_sign_d1),
+                    hn::Div(not_exercised, exponent))),
+            hn::Div(
+                hn::Mul(e_qt, pdf_d1), hn::Mul(sigma_root_t, exponent)));
+    }
+
+    template <Access Mode>
+    [[nodiscard]] static inline VecT load(const T* from, size_t count)
+    {
+        return Pricer::template load<Mode>(from, count);
+    }
+
+    template <Access Mode>
+    static inline void store(const VecT& v, T* to, size_t count)
+    {
+        Pricer::template store<Mode>(v, to, count);
+    }
+};
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+
+#if HWY_TARGET == HWY_STATIC_TARGET
+using HWY_NAMESPACE::FastBaroneAdesiWhaley;
+#endif
+
+}  // namespace fast_option_pricer
+HWY_AFTER_NAMESPACE();
+
+#endif  // FAST_OPTION_PRICER_FAST_BARONE_ADESI_WHALEY_H_
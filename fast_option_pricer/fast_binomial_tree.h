@@ -0,0 +1,345 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+// Per-target include guard, see hwy/highway.h and math-inl.h
+#if defined(FAST_OPTION_PRICER_FAST_BINOMIAL_TREE_H_) == \
+    defined(HWY_TARGET_TOGGLE)
+#ifdef FAST_OPTION_PRICER_FAST_BINOMIAL_TREE_H_
+#undef FAST_OPTION_PRICER_FAST_BINOMIAL_TREE_H_
+#else
+#define FAST_OPTION_PRICER_FAST_BINOMIAL_TREE_H_
+#endif
+
+#include <hwy/aligned_allocator.h>
+#include <hwy/highway.h>
+#include <cassert>
+#include "common.h"
+#include "fast_black_scholes.h"
+#include "fast_math_helper.h"
+#include "math-inl.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace fast_option_pricer {
+namespace HWY_NAMESPACE {
+
+namespace hn = hwy::HWY_NAMESPACE;
+
+// Prices American options on Cox-Ross-Rubinstein binomial trees with one
+// option per lane. All lanes step back through their trees together and
+// early exercise is a vector Max against the payoff of the node. A node n
+// steps in with j down moves sits at S * u^(n - 2j), so the exercise payoffs
+// of every node of a tree are one column of 2 * num_steps + 1 values per
+// lane. The column is built outward from S by repeated multiplication by u
+// and d, and is shared by every tree with the same moves: the price tree and
+// both rho trees. Only the vega trees, whose moves differ, fill their own.
+//
+// Delta, gamma and theta come from the nodes one and two steps in. Vega and
+// rho reprice the tree with the volatility or rate bumped either way, so
+// they cost four more trees and only run if requested. Volatilities at or
+// below the bump are only bumped up. Units are those of
+// FastBlackScholes: vega and rho per 1%, theta per day. Like
+// FastBlackScholes, the tree drifts at the cost of carry r - q.
+template <
+    IsFloatOrDouble T = double, typename D = hn::ScalableTag<T>,
+    Accuracy A = Accuracy::kExact>
+class FastBinomialTree
+{
+   public:
+    using VecT = hn::Vec<D>;
+    using Pricer = FastBlackScholes<T, D, A>;
+    using Access = typename Pricer::Access;
+    using Legs = typename Pricer::Legs;
+
+    static constexpr size_t kDefaultNumSteps = 200;
+
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    static void price(
+        const OptionPricingView<T>& op, size_t num_steps = kDefaultNumSteps)
+    {
+        constexpr Legs L = Call ? Legs::kCall : Legs::kPut;
+        price_legs<L, Outputs>(op, num_steps);
+    }
+
+    // See FastBlackScholes::price_mixed
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_mixed(
+        const OptionPricingView<T>& op, size_t num_steps = kDefaultNumSteps)
+    {
+        assert(op.num_options == op.option_types.size());
+        price_legs<Legs::kMixed, Outputs>(op, num_steps);
+    }
+
+   private:
+    // Central difference step of vega and rho
+    static constexpr T kBump = 1e-2;
+
+    template <Legs L, uint32_t Outputs>
+    static void price_legs(const OptionPricingView<T>& op, size_t num_steps)
+    {
+        assert(op.has_input_columns());
+        assert(op.has_outputs(Outputs));
+        // Gamma and theta need the nodes two steps in
+        assert(num_steps >= 2);
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+
+        // Node values of the current step, and exercise payoffs by up moves
+        // less down moves, one vector per node
+        const auto values = hwy::AllocateAligned<T>((num_steps + 1) * lanes);
+        const auto payoffs =
+            hwy::AllocateAligned<T>((2 * num_steps + 1) * lanes);
+
+        size_t i = 0;
+        for (; i + lanes <= op.num_options; i += lanes) {
+            price_vector<L, Outputs, Access::kUnaligned>(
+                op, i, lanes, num_steps, values.get(), payoffs.get());
+        }
+        // Remainder of a batch that is not a multiple of lanes
+        if (i < op.num_options) {
+            price_vector<L, Outputs, Access::kPartial>(
+                op, i, op.num_options - i, num_steps, values.get(),
+                payoffs.get());
+        }
+    }
+
+    template <Legs L, uint32_t Outputs, Access Mode>
+    static inline void price_vector(
+        const OptionPricingView<T>& op, size_t i, size_t count,
+        size_t num_steps, T* values, T* payoffs)
+    {
+        constexpr D d;
+        const VecT underlying = load<Mode>(op.underlyings.data() + i, count);
+        const VecT strike = load<Mode>(op.strikes.data() + i, count);
+        const VecT risk_free_rate =
+            load<Mode>(op.risk_free_rates.data() + i, count);
+        const VecT volatility = load<Mode>(op.volatilities.data() + i, count);
+        const VecT time_to_expiry =
+            load<Mode>(op.times_to_expiry.data() + i, count);
+        const VecT dividend_yield =
+            load<Mode>(op.dividend_yields.data() + i, count);
+        // +1 for calls and -1 for puts, see OptionType
+        VecT sign = hn::Set(d, L == Legs::kPut ? T{-1} : T{1});
+        if constexpr (L == Legs::kMixed) {
+            sign = load<Mode>(op.option_types.data() + i, count);
+        }
+        const VecT dt =
+            hn::Div(time_to_expiry, hn::Set(d, static_cast<T>(num_steps)));
+        const VecT root_dt = hn::Sqrt(dt);
+
+        VecT up, down;
+        moves(volatility, root_dt, up, down);
+        fill_payoffs(underlying, strike, sign, up, down, num_steps, payoffs);
+        VecT v1_up, v1_down, v2_up, v2_mid, v2_down;
+        const VecT v0 = roll_back(
+            up, down, risk_free_rate, dividend_yield, dt, num_steps, values,
+            payoffs, v1_up, v1_down, v2_up, v2_mid, v2_down);
+
+        const VecT underlying_up = hn::Mul(underlying, up);
+        const VecT underlying_down = hn::Div(underlying, up);
+        if constexpr (Outputs & kPrice) {
+            store<Mode>(v0, op.prices.data() + i, count);
+        }
+        if constexpr (Outputs & kDelta) {
+            store<Mode>(
+                hn::Div(
+                    hn::Sub(v1_up, v1_down),
+                    hn::Sub(underlying_up, underlying_down)),
+                op.deltas.data() + i, count);
+        }
+        if constexpr (Outputs & kGamma) {
+            const VecT underlying_up_up = hn::Mul(underlying_up, up);
+            const VecT underlying_down_down = hn::Div(underlying_down, up);
+            store<Mode>(
+                hn::Div(
+                    hn::Sub(
+                        hn::Div(
+                            hn::Sub(v2_up, v2_mid),
+                            hn::Sub(underlying_up_up, underlying)),
+                        hn::Div(
+                            hn::Sub(v2_mid, v2_down),
+                            hn::Sub(underlying, underlying_down_down))),
+                    hn::Mul(
+                        hn::Set(d, static_cast<T>(0.5)),
+                        hn::Sub(underlying_up_up, underlying_down_down))),
+                op.gammas.data() + i, count);
+        }
+        if constexpr (Outputs & kTheta) {
+            // The middle node two steps in has the same underlying
+            store<Mode>(
+                hn::Mul(
+                    hn::Set(d, Pricer::C_theta),
+                    hn::Div(
+                        hn::Sub(v2_mid, v0),
+                        hn::Mul(hn::Set(d, static_cast<T>(2.0)), dt))),
+                op.thetas.data() + i, count);
+        }
+
+        const VecT bump = hn::Set(d, kBump);
+        if constexpr (Outputs & kRho) {
+            // Per 1%, from the bumped prices. The rate does not change the
+            // moves, so both trees reuse the payoffs of the price tree.
+            const VecT per_percent =
+                hn::Set(d, Pricer::C / (static_cast<T>(2.0) * kBump));
+            const VecT v_up = roll_back(
+                up, down, hn::Add(risk_free_rate, bump), dividend_yield, dt,
+                num_steps, values, payoffs, v1_up, v1_down, v2_up, v2_mid,
+                v2_down);
+            const VecT v_down = roll_back(
+                up, down, hn::Sub(risk_free_rate, bump), dividend_yield, dt,
+                num_steps, values, payoffs, v1_up, v1_down, v2_up, v2_mid,
+                v2_down);
+            store<Mode>(
+                hn::Mul(per_percent, hn::Sub(v_up, v_down)),
+                op.rhos.data() + i, count);
+        }
+        if constexpr (Outputs & kVega) {
+            // A tree without volatility has no up move, so at or below the
+            // bump the difference is one-sided from the unbumped volatility.
+            // Runs last, as each bumped tree overwrites the payoffs.
+            const VecT vol_up = hn::Add(volatility, bump);
+            const VecT vol_down = hn::IfThenElse(
+                hn::Gt(volatility, bump), hn::Sub(volatility, bump),
+                volatility);
+            const VecT v_up = bumped_roll_back(
+                underlying, strike, sign, risk_free_rate, vol_up,
+                dividend_yield, dt, root_dt, num_steps, values, payoffs);
+            const VecT v_down = bumped_roll_back(
+                underlying, strike, sign, risk_free_rate, vol_down,
+                dividend_yield, dt, root_dt, num_steps, values, payoffs);
+            store<Mode>(
+                hn::Mul(
+                    hn::Set(d, Pricer::C),
+                    hn::Div(
+                        hn::Sub(v_up, v_down), hn::Sub(vol_up, vol_down))),
+                op.vegas.data() + i, count);
+        }
+    }
+
+    // Sets u = e^(sigma * sqrt(dt)) and d = e^(-sigma * sqrt(dt))
+    static inline void moves(
+        const VecT& volatility, const VecT& root_dt, VecT& up, VecT& down)
+    {
+        constexpr D d;
+        const VecT sigma_root_dt = hn::Mul(volatility, root_dt);
+        up = FastMathHelper::exp<VecT, T, D, d, A>(sigma_root_dt);
+        down = FastMathHelper::exp<VecT, T, D, d, A>(hn::Neg(sigma_root_dt));
+    }
+
+    // payoffs[k] is the exercise value at S * u^(k - num_steps), with the
+    // nodes stepped out from S one multiplication at a time
+    static inline void fill_payoffs(
+        const VecT& underlying, const VecT& strike, const VecT& sign,
+        const VecT& up, const VecT& down, size_t num_steps, T* payoffs)
+    {
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+        const VecT zero = hn::Zero(d);
+        const auto store_payoff = [&](const VecT& node, size_t k) {
+            hn::Store(
+                hn::Max(hn::Mul(sign, hn::Sub(node, strike)), zero), d,
+                payoffs + k * lanes);
+        };
+        store_payoff(underlying, num_steps);
+        VecT node_up = underlying;
+        VecT node_down = underlying;
+        for (size_t k = 1; k <= num_steps; ++k) {
+            node_up = hn::Mul(node_up, up);
+            node_down = hn::Mul(node_down, down);
+            store_payoff(node_up, num_steps + k);
+            store_payoff(node_down, num_steps - k);
+        }
+    }
+
+    // Value of the tree at a bumped volatility, which moves every node
+    static inline VecT bumped_roll_back(
+        const VecT& underlying, const VecT& strike, const VecT& sign,
+        const VecT& risk_free_rate, const VecT& volatility,
+        const VecT& dividend_yield, const VecT& dt, const VecT& root_dt,
+        size_t num_steps, T* values, T* payoffs)
+    {
+        VecT up, down;
+        moves(volatility, root_dt, up, down);
+        fill_payoffs(underlying, strike, sign, up, down, num_steps, payoffs);
+        VecT v1_up, v1_down, v2_up, v2_mid, v2_down;
+        return roll_back(
+            up, down, risk_free_rate, dividend_yield, dt, num_steps, values,
+            payoffs, v1_up, v1_down, v2_up, v2_mid, v2_down);
+    }
+
+    // Returns the value of the tree with moves 'up' and 'down' whose
+    // exercise payoffs fill_payoffs stored in 'payoffs', and sets the node
+    // values one and two steps in, highest underlying first
+    static inline VecT roll_back(
+        const VecT& up, const VecT& down, const VecT& risk_free_rate,
+        const VecT& dividend_yield, const VecT& dt, size_t num_steps,
+        T* values, const T* payoffs, VecT& v1_up, VecT& v1_down, VecT& v2_up,
+        VecT& v2_mid, VecT& v2_down)
+    {
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+        const VecT growth = FastMathHelper::exp<VecT, T, D, d, A>(
+            hn::Mul(hn::Sub(risk_free_rate, dividend_yield), dt));
+        const VecT discount = FastMathHelper::exp<VecT, T, D, d, A>(
+            hn::Neg(hn::Mul(risk_free_rate, dt)));
+        // Discounted risk-neutral probabilities of an up and a down move
+        const VecT up_weight = hn::Mul(
+            discount, hn::Div(hn::Sub(growth, down), hn::Sub(up, down)));
+        const VecT down_weight = hn::Sub(discount, up_weight);
+
+        // At expiry, node j is worth its payoff
+        for (size_t j = 0; j <= num_steps; ++j) {
+            hn::Store(
+                hn::Load(d, payoffs + 2 * (num_steps - j) * lanes), d,
+                values + j * lanes);
+        }
+        for (size_t n = num_steps; n-- > 0;) {
+            // Each node's down child is the next node's up child
+            VecT next = hn::Load(d, values);
+            for (size_t j = 0; j <= n; ++j) {
+                const VecT child_up = next;
+                next = hn::Load(d, values + (j + 1) * lanes);
+                const VecT held =
+                    hn::MulAdd(up_weight, child_up, hn::Mul(down_weight, next));
+                hn::Store(
+                    hn::Max(
+                        held,
+                        hn::Load(d, payoffs + (num_steps + n - 2 * j) * lanes)),
+                    d, values + j * lanes);
+            }
+            if (n == 2) {
+                v2_up = hn::Load(d, values);
+                v2_mid = hn::Load(d, values + lanes);
+                v2_down = hn::Load(d, values + 2 * lanes);
+            } else if (n == 1) {
+                v1_up = hn::Load(d, values);
+                v1_down = hn::Load(d, values + lanes);
+            }
+        }
+        return hn::Load(d, values);
+    }
+
+    template <Access Mode>
+    [[nodiscard]] static inline VecT load(const T* from, size_t count)
+    {
+        return Pricer::template load<Mode>(from, count);
+    }
+
+    template <Access Mode>
+    static inline void store(const VecT& v, T* to, size_t count)
+    {
+        Pricer::template store<Mode>(v, to, count);
+    }
+};
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+
+#if HWY_TARGET == HWY_STATIC_TARGET
+using HWY_NAMESPACE::FastBinomialTree;
+#endif
+
+}  // namespace fast_option_pricer
+HWY_AFTER_NAMESPACE();
+
+#endif  // FAST_OPTION_PRICER_FAST_BINOMIAL_TREE_H_
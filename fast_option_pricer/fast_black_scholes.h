@@ -2,116 +2,710 @@
 // Created by Karolis Spukas on 10/2/2024.
 //
 
-#pragma once
+// Per-target include guard, see hwy/highway.h and math-inl.h
+#if defined(FAST_OPTION_PRICER_FAST_BLACK_SCHOLES_H_) == \
+    defined(HWY_TARGET_TOGGLE)
+#ifdef FAST_OPTION_PRICER_FAST_BLACK_SCHOLES_H_
+#undef FAST_OPTION_PRICER_FAST_BLACK_SCHOLES_H_
+#else
+#define FAST_OPTION_PRICER_FAST_BLACK_SCHOLES_H_
+#endif
 
+#include <hwy/aligned_allocator.h>
 #include <hwy/highway.h>
-#include <iostream>
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <span>
 #include <type_traits>
+#include "aligned_option_pricing.h"
+#include "bucket_terms.h"
+#include "cache_info.h"
 #include "common.h"
 #include "fast_math_helper.h"
 #include "math-inl.h"
 
+HWY_BEFORE_NAMESPACE();
 namespace fast_option_pricer {
+namespace HWY_NAMESPACE {
 
 namespace hn = hwy::HWY_NAMESPACE;
 
-template <IsFloatOrDouble T = double, typename D = hn::ScalableTag<T>>
+// A picks the accuracy of exp, log and the normal CDF (see Accuracy), e.g.
+// FastBlackScholes<double, D, Accuracy::kFastest> for intraday risk runs.
+// P = Precision::kMixed keeps double inputs and outputs but evaluates the
+// normal CDF and PDF in float lanes, see calc_normal_cdfs.
+// S = Stores::kAuto streams the outputs of batches larger than the last level
+// cache past it, see Stores.
+template <
+    IsFloatOrDouble T = double, typename D = hn::ScalableTag<T>,
+    Accuracy A = Accuracy::kExact, Precision P = Precision::kFull,
+    Stores S = Stores::kCached>
 class FastBlackScholes
 {
+    static_assert(
+        P == Precision::kFull || std::is_same_v<T, double>,
+        "Precision::kMixed prices double columns");
+
    public:
     using VecT = hn::Vec<D>;
 
-    template <bool Call = true>
+    // Outputs (see Output) selects what is computed and stored, e.g.
+    // price<true, kPrice> for calibration. Columns of other outputs are
+    // neither written nor required to exist.
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
     static void price(OptionPricing<T>& op)
+    {
+        price<Call, Outputs>(op.view());
+    }
+
+    // Also marks every option of 'op' clean, see reprice_dirty
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    static void price(AlignedOptionPricing<T>& op)
+    {
+        price<Call, Outputs>(op.view());
+        op.mark_all_clean();
+    }
+
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    static void price(const OptionPricingView<T>& op)
+    {
+        constexpr Legs L = Call ? Legs::kCall : Legs::kPut;
+        price_legs<L, Outputs>(op, PutPricingView<T>(op));
+    }
+
+    // Prices both legs in one pass: call outputs, gammas and vegas go to
+    // 'op', put outputs to 'put'.
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_call_put(OptionPricing<T>& op, PutPricing<T>& put)
+    {
+        price_call_put<Outputs>(op.view(), put.view());
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_call_put(
+        const OptionPricingView<T>& op, const PutPricingView<T>& put)
+    {
+        assert(put.has_outputs(Outputs, op.num_options));
+        price_legs<Legs::kCallAndPut, Outputs>(op, put);
+    }
+
+    // Prices a book that mixes calls and puts in one pass, as given by
+    // op.option_types (see OptionType). Gammas and vegas are the same for both.
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_mixed(OptionPricing<T>& op)
+    {
+        price_mixed<Outputs>(op.view());
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_mixed(AlignedOptionPricing<T>& op)
+    {
+        price_mixed<Outputs>(op.view());
+        op.mark_all_clean();
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_mixed(const OptionPricingView<T>& op)
+    {
+        assert(op.num_options == op.option_types.size());
+        price_legs<Legs::kMixed, Outputs>(op, PutPricingView<T>(op));
+    }
+
+    // Resizes 'terms' to ts.num_buckets and fills it with sqrt(T), e^(-qT)
+    // and e^(-rT) of every bucket of 'ts'. Must run again whenever a rate,
+    // dividend yield or expiry of a bucket changes.
+    static void cache_bucket_terms(
+        const TermStructureView<T>& ts, BucketTerms<T>& terms)
+    {
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+        const VecT minus_one = hn::Set(d, static_cast<T>(-1.0));
+        terms.resize(ts.num_buckets);
+        // The columns are padded to kColumnPadding >= lanes, so every vector
+        // can be stored whole
+        for (size_t b = 0; b < ts.num_buckets; b += lanes) {
+            const size_t count = std::min(lanes, ts.num_buckets - b);
+            const VecT risk_free_rate = load<Access::kPartial>(
+                ts.risk_free_rates.data() + b, count);
+            const VecT dividend_yield = load<Access::kPartial>(
+                ts.dividend_yields.data() + b, count);
+            const VecT time_to_expiry = load<Access::kPartial>(
+                ts.times_to_expiry.data() + b, count);
+            hn::Store(hn::Sqrt(time_to_expiry), d, terms.root_ts().data() + b);
+            hn::Store(
+                FastMathHelper::exp<VecT, T, D, d, A>(hn::Mul(
+                    minus_one, hn::Mul(time_to_expiry, dividend_yield))),
+                d, terms.e_qts().data() + b);
+            hn::Store(
+                FastMathHelper::exp<VecT, T, D, d, A>(hn::Mul(
+                    minus_one, hn::Mul(time_to_expiry, risk_free_rate))),
+                d, terms.e_rts().data() + b);
+        }
+    }
+
+    // Prices 'op' with the rates, dividend yields and expiries of the expiry
+    // buckets in 'ts' instead of its own columns, which may be left empty.
+    // sqrt(T), e^(-qT) and e^(-rT) come from 'terms', filled from 'ts' by
+    // cache_bucket_terms, and are gathered per option, which takes both exps
+    // off the per-option path. Every entry of ts.buckets must lie in
+    // [0, ts.num_buckets); gathers do not check it.
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    static void price_bucketed(
+        const OptionPricingView<T>& op, const TermStructureView<T>& ts,
+        BucketTerms<T>& terms)
+    {
+        constexpr Legs L = Call ? Legs::kCall : Legs::kPut;
+        price_bucketed_legs<L, Outputs>(op, PutPricingView<T>(op), ts, terms);
+    }
+
+    // See price_mixed and price_bucketed
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_bucketed_mixed(
+        const OptionPricingView<T>& op, const TermStructureView<T>& ts,
+        BucketTerms<T>& terms)
+    {
+        assert(op.num_options == op.option_types.size());
+        price_bucketed_legs<Legs::kMixed, Outputs>(
+            op, PutPricingView<T>(op), ts, terms);
+    }
+
+    // Prices a strike chain: options on one underlying with one expiry, rate
+    // and dividend yield, differing only in strike and volatility. 'op'
+    // supplies strikes, volatilities and outputs; its other input columns
+    // may be left empty. sqrt(T), e^(-qT) and e^(-rT) are evaluated once and
+    // broadcast, so each option loads two columns and pays for log(S / K),
+    // the CDFs and its outputs only.
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    static void price_chain(
+        const StrikeChain<T>& chain, const OptionPricingView<T>& op)
+    {
+        constexpr Legs L = Call ? Legs::kCall : Legs::kPut;
+        price_chain_legs<L, Outputs>(chain, op, PutPricingView<T>(op));
+    }
+
+    // See price_mixed and price_chain
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_chain_mixed(
+        const StrikeChain<T>& chain, const OptionPricingView<T>& op)
+    {
+        assert(op.num_options == op.option_types.size());
+        price_chain_legs<Legs::kMixed, Outputs>(
+            chain, op, PutPricingView<T>(op));
+    }
+
+    // Reprices only the vectors of 'op' that hold a dirty option (see
+    // AlignedOptionPricing) and marks them clean, so a cycle that changed 1%
+    // of the inputs costs about 1% of price. Dirty vectors are found by bit
+    // scans over the bitmap, skipping 64 clean options per zero word.
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    static void reprice_dirty(AlignedOptionPricing<T>& op)
+    {
+        constexpr Legs L = Call ? Legs::kCall : Legs::kPut;
+        const OptionPricingView<T> v = op.view();
+        reprice_dirty_legs<L, Outputs>(
+            op.dirty_words(), v, PutPricingView<T>(v));
+    }
+
+    // See price_mixed and reprice_dirty
+    template <uint32_t Outputs = kAllOutputs>
+    static void reprice_dirty_mixed(AlignedOptionPricing<T>& op)
+    {
+        const OptionPricingView<T> v = op.view();
+        reprice_dirty_legs<Legs::kMixed, Outputs>(
+            op.dirty_words(), v, PutPricingView<T>(v));
+    }
+
+    // Which legs price_vector computes
+    enum class Legs
+    {
+        kCall,
+        kPut,
+        kCallAndPut,
+        kMixed  // per op.option_types, blended lane by lane
+    };
+
+    // How price_vector reads and writes the columns
+    enum class Access
+    {
+        kAligned,    // whole vectors at vector-aligned addresses
+        kStreamed,   // as kAligned, with non-temporal stores
+        kUnaligned,  // whole vectors at any address
+        kPartial     // the first 'count' lanes only
+    };
+
+    template <Legs L, uint32_t Outputs>
+    static void price_legs(
+        const OptionPricingView<T>& op, const PutPricingView<T>& put)
+    {
+        assert(op.has_input_columns());
+        assert(op.has_outputs(Outputs));
+        for_each_vector<L, Outputs>(
+            op, put, [&]<Access Mode>(size_t i, size_t count) {
+                price_vector<L, Outputs, Mode>(op, put, i, count);
+            });
+    }
+
+    template <Legs L, uint32_t Outputs>
+    static void price_chain_legs(
+        const StrikeChain<T>& chain, const OptionPricingView<T>& op,
+        const PutPricingView<T>& put)
+    {
+        assert(op.has_outputs(Outputs));
+        constexpr D d;
+        constexpr bool kNeedsE_qt = Outputs & ~kRho;
+        constexpr bool kNeedsE_rt = Outputs & (kPrice | kTheta | kRho);
+
+        // Broadcast once, see price_vector
+        const VecT underlying = hn::Set(d, chain.underlying);
+        const VecT risk_free_rate = hn::Set(d, chain.risk_free_rate);
+        const VecT time_to_expiry = hn::Set(d, chain.time_to_expiry);
+        const VecT dividend_yield = hn::Set(d, chain.dividend_yield);
+        const VecT root_t = hn::Sqrt(time_to_expiry);
+        const VecT e_qt =
+            kNeedsE_qt ? FastMathHelper::exp<VecT, T, D, d, A>(hn::Mul(
+                             hn::Set(d, static_cast<T>(-1.0)),
+                             hn::Mul(time_to_expiry, dividend_yield)))
+                       : hn::Zero(d);
+        const VecT e_rt =
+            kNeedsE_rt ? FastMathHelper::exp<VecT, T, D, d, A>(hn::Mul(
+                             hn::Set(d, static_cast<T>(-1.0)),
+                             hn::Mul(time_to_expiry, risk_free_rate)))
+                       : hn::Zero(d);
+
+        for_each_vector<L, Outputs>(
+            op, put, [&]<Access Mode>(size_t i, size_t count) {
+                price_terms<L, Outputs, Mode>(
+                    op, put, i, count, underlying,
+                    load<Mode>(op.strikes.data() + i, count), risk_free_rate,
+                    load<Mode>(op.volatilities.data() + i, count),
+                    time_to_expiry, dividend_yield, root_t, e_qt, e_rt);
+            });
+    }
+
+    // Calls f.template operator()<Mode>(i, count) for every vector of 'op'.
+    // Aligned columns padded to whole vectors (e.g. AlignedOptionPricing)
+    // run aligned full vectors all the way through the padding.
+    template <Legs L, uint32_t Outputs, typename F>
+    static void for_each_vector(
+        const OptionPricingView<T>& op, const PutPricingView<T>& put,
+        const F& f)
+    {
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+
+        const size_t padded = hwy::RoundUpTo(op.num_options, lanes);
+        if (op.aligned_to(lanes * sizeof(T)) &&
+            put.aligned_to(lanes * sizeof(T)) &&
+            op.padded_num_options >= padded &&
+            put.padded_num_options >= padded) {
+            if (streams<L, Outputs>(op.num_options)) {
+                for (size_t i = 0; i < op.num_options; i += lanes) {
+                    f.template operator()<Access::kStreamed>(i, lanes);
+                }
+                // Streamed stores are weakly ordered, order them before
+                // any later store, e.g. a flag telling readers we are done
+                hn::FlushStream();
+                return;
+            }
+            for (size_t i = 0; i < op.num_options; i += lanes) {
+                f.template operator()<Access::kAligned>(i, lanes);
+            }
+            return;
+        }
+
+        size_t i = 0;
+        for (; i + lanes <= op.num_options; i += lanes) {
+            f.template operator()<Access::kUnaligned>(i, lanes);
+        }
+        // Remainder of a batch that is not a multiple of lanes
+        if (i < op.num_options) {
+            f.template operator()<Access::kPartial>(i, op.num_options - i);
+        }
+    }
+
+    template <Legs L, uint32_t Outputs>
+    static void price_bucketed_legs(
+        const OptionPricingView<T>& op, const PutPricingView<T>& put,
+        const TermStructureView<T>& ts, BucketTerms<T>& terms)
+    {
+        assert(op.has_outputs(Outputs));
+        assert(op.num_options == op.underlyings.size());
+        assert(op.num_options == ts.buckets.size());
+        assert(terms.num_buckets() == ts.num_buckets);
+        assert(ts.has_valid_buckets());
+        // Lanes past the end of a partial vector gather bucket 0
+        assert(op.num_options == 0 || ts.num_buckets > 0);
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+        const T* root_ts = terms.root_ts().data();
+        const T* e_qts = terms.e_qts().data();
+        const T* e_rts = terms.e_rts().data();
+
+        // The bucket column has no padding, so no aligned full vectors here
+        size_t i = 0;
+        for (; i + lanes <= op.num_options; i += lanes) {
+            price_bucketed_vector<L, Outputs, Access::kUnaligned>(
+                op, put, ts, root_ts, e_qts, e_rts, i, lanes);
+        }
+        // Remainder of a batch that is not a multiple of lanes
+        if (i < op.num_options) {
+            price_bucketed_vector<L, Outputs, Access::kPartial>(
+                op, put, ts, root_ts, e_qts, e_rts, i, op.num_options - i);
+        }
+    }
+
+    // price_vector with the rate, dividend yield, expiry and their terms
+    // gathered from the buckets of options [i, i + count)
+    template <Legs L, uint32_t Outputs, Access Mode>
+    static inline void price_bucketed_vector(
+        const OptionPricingView<T>& op, const PutPricingView<T>& put,
+        const TermStructureView<T>& ts, const T* root_ts, const T* e_qts,
+        const T* e_rts, size_t i, size_t count)
+    {
+        constexpr D d;
+        constexpr hn::RebindToSigned<D> di;
+        constexpr bool kNeedsE_qt = Outputs & ~kRho;
+        constexpr bool kNeedsE_rt = Outputs & (kPrice | kTheta | kRho);
+
+        const auto bucket =
+            Mode == Access::kPartial
+                ? hn::LoadN(di, ts.buckets.data() + i, count)
+                : hn::LoadU(di, ts.buckets.data() + i);
+        const VecT underlying = load<Mode>(op.underlyings.data() + i, count);
+        const VecT strike = load<Mode>(op.strikes.data() + i, count);
+        const VecT volatility = load<Mode>(op.volatilities.data() + i, count);
+        const VecT risk_free_rate =
+            hn::GatherIndex(d, ts.risk_free_rates.data(), bucket);
+        const VecT time_to_expiry =
+            hn::GatherIndex(d, ts.times_to_expiry.data(), bucket);
+        const VecT dividend_yield =
+            hn::GatherIndex(d, ts.dividend_yields.data(), bucket);
+        const VecT root_t = hn::GatherIndex(d, root_ts, bucket);
+        const VecT e_qt =
+            kNeedsE_qt ? hn::GatherIndex(d, e_qts, bucket) : hn::Zero(d);
+        const VecT e_rt =
+            kNeedsE_rt ? hn::GatherIndex(d, e_rts, bucket) : hn::Zero(d);
+
+        price_terms<L, Outputs, Mode>(
+            op, put, i, count, underlying, strike, risk_free_rate, volatility,
+            time_to_expiry, dividend_yield, root_t, e_qt, e_rt);
+    }
+
+    // Prices the vectors holding an option whose bit is set in 'dirty' and
+    // clears the bits. 'op' must be aligned and padded to whole vectors.
+    template <Legs L, uint32_t Outputs>
+    static void reprice_dirty_legs(
+        std::span<uint64_t> dirty, const OptionPricingView<T>& op,
+        const PutPricingView<T>& put)
+    {
+        assert(op.has_outputs(Outputs));
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+        // Vectors start on a multiple of lanes, so each one maps to 'lanes'
+        // bits of a single word
+        assert(64 % lanes == 0);
+        const uint64_t vector_bits =
+            lanes == 64 ? ~uint64_t{0} : (uint64_t{1} << lanes) - 1;
+
+        for (size_t w = 0; w < dirty.size(); ++w) {
+            uint64_t bits = dirty[w];
+            while (bits != 0) {
+                const size_t first = std::countr_zero(bits) / lanes * lanes;
+                price_vector<L, Outputs, Access::kAligned>(
+                    op, put, w * 64 + first, lanes);
+                bits &= ~(vector_bits << first);
+            }
+            dirty[w] = 0;
+        }
+    }
+
+    // Whether price_legs streams the outputs of an aligned batch, see Stores
+    template <Legs L, uint32_t Outputs>
+    [[nodiscard]] static bool streams(size_t num_options)
+    {
+        constexpr size_t kColumns = pass_columns(
+            Outputs, L == Legs::kMixed, L == Legs::kCallAndPut);
+        return streams_outputs(S, num_options * kColumns * sizeof(T));
+    }
+
+    // Prices options [i, i + count), count <= lanes. Put outputs go to
+    // 'put', which aliases the outputs of 'op' when pricing puts only. Only
+    // the Outputs are computed and stored.
+    template <Legs L, uint32_t Outputs, Access Mode>
+    static inline void price_vector(
+        const OptionPricingView<T>& op, const PutPricingView<T>& put,
+        size_t i, size_t count)
+    {
+        constexpr D d;
+        constexpr bool kNeedsE_qt = Outputs & ~kRho;
+        constexpr bool kNeedsE_rt = Outputs & (kPrice | kTheta | kRho);
+
+        // Load initial option info
+        const VecT underlying = load<Mode>(op.underlyings.data() + i, count);
+        const VecT strike = load<Mode>(op.strikes.data() + i, count);
+        const VecT risk_free_rate =
+            load<Mode>(op.risk_free_rates.data() + i, count);
+        const VecT volatility = load<Mode>(op.volatilities.data() + i, count);
+        const VecT time_to_expiry =
+            load<Mode>(op.times_to_expiry.data() + i, count);
+        const VecT dividend_yield =
+            load<Mode>(op.dividend_yields.data() + i, count);
+
+        // Calculate shared constants, skipping those no output depends on
+        const VecT root_t = hn::Sqrt(time_to_expiry);
+        const VecT e_qt =
+            kNeedsE_qt ? FastMathHelper::exp<VecT, T, D, d, A>(hn::Mul(
+                             hn::Set(d, static_cast<T>(-1.0)),
+                             hn::Mul(time_to_expiry, dividend_yield)))
+                       : hn::Zero(d);
+        const VecT e_rt =
+            kNeedsE_rt ? FastMathHelper::exp<VecT, T, D, d, A>(hn::Mul(
+                             hn::Set(d, static_cast<T>(-1.0)),
+                             hn::Mul(time_to_expiry, risk_free_rate)))
+                       : hn::Zero(d);
+
+        price_terms<L, Outputs, Mode>(
+            op, put, i, count, underlying, strike, risk_free_rate, volatility,
+            time_to_expiry, dividend_yield, root_t, e_qt, e_rt);
+    }
+
+    // The rest of price_vector, from the inputs and the terms that only
+    // depend on the rate, dividend yield and expiry. Shared with
+    // price_bucketed, which gathers those terms per expiry bucket.
+    template <Legs L, uint32_t Outputs, Access Mode>
+    static inline void price_terms(
+        const OptionPricingView<T>& op, const PutPricingView<T>& put,
+        size_t i, size_t count, const VecT& underlying, const VecT& strike,
+        const VecT& risk_free_rate, const VecT& volatility,
+        const VecT& time_to_expiry, const VecT& dividend_yield,
+        const VecT& root_t, const VecT& e_qt, const VecT& e_rt)
+    {
+        constexpr D d;
+        constexpr bool kNeedsN_d1 = Outputs & (kPrice | kDelta | kTheta);
+        constexpr bool kNeedsN_d2 = Outputs & (kPrice | kTheta | kRho);
+        constexpr bool kNeedsPdf_d1 = Outputs & (kVega | kTheta | kGamma);
+        constexpr bool kNeedsE_rt = Outputs & (kPrice | kTheta | kRho);
+
+        // The terms of store_outputs that do not depend on the underlying
+        const VecT discounted_strike =
+            kNeedsE_rt ? hn::Mul(strike, e_rt) : hn::Zero(d);
+        const VecT rate_discounted_strike =
+            (Outputs & kTheta) ? hn::Mul(risk_free_rate, discounted_strike)
+                               : hn::Zero(d);
+        const VecT time_discounted_strike =
+            (Outputs & kRho) ? hn::Mul(time_to_expiry, discounted_strike)
+                             : hn::Zero(d);
+        const VecT dividend_e_qt = (Outputs & kTheta)
+                                       ? hn::Mul(dividend_yield, e_qt)
+                                       : hn::Zero(d);
+
+        const VecT sigma_root_t = hn::Mul(volatility, root_t);
+        const VecT d1 = calc_d1<d>(
+            underlying, strike, risk_free_rate, dividend_yield, time_to_expiry,
+            sigma_root_t);
+        const VecT d2 = calc_d2(d1, sigma_root_t);
+        VecT n_d1 = hn::Zero(d);
+        VecT n_d2 = hn::Zero(d);
+        if constexpr (P == Precision::kMixed && (kNeedsN_d1 || kNeedsN_d2)) {
+            calc_normal_cdfs<d>(d1, d2, n_d1, n_d2);
+        } else {
+            if constexpr (kNeedsN_d1) {
+                n_d1 = FastMathHelper::normal_cdf<VecT, T, D, d, A>(d1);
+            }
+            if constexpr (kNeedsN_d2) {
+                n_d2 = FastMathHelper::normal_cdf<VecT, T, D, d, A>(d2);
+            }
+        }
+
+        const VecT pdf_d1 =
+            kNeedsPdf_d1 ? calc_normal_pdf<d>(d1) : hn::Zero(d);
+        // Time decay of the volatility term, shared by call and put theta
+        const VecT theta_decay =
+            (Outputs & kTheta)
+                ? calc_theta_decay<d>(
+                      underlying, e_qt, sigma_root_t, time_to_expiry, pdf_d1)
+                : hn::Zero(d);
+        const VecT vega =
+            (Outputs & kVega)
+                ? calc_vega<d>(underlying, e_qt, root_t, pdf_d1)
+                : hn::Zero(d);
+
+        store_outputs<L, Outputs, Mode>(
+            op, put, i, count, underlying, sigma_root_t, e_qt, dividend_e_qt,
+            discounted_strike, rate_discounted_strike, time_discounted_strike,
+            n_d1, n_d2, pdf_d1, theta_decay, vega);
+    }
+
+    // Computes the Outputs of options [i, i + count) from the intermediates
+    // of price_vector and stores them: K * e^(-rT) for the price, q * e^(-qT)
+    // and r * K * e^(-rT) for theta, T * K * e^(-rT) for rho. Shared with
+    // FastSpotTick, which caches everything but the underlying, the CDFs and
+    // the PDF, so that a tick reads no other input column.
+    template <Legs L, uint32_t Outputs, Access Mode>
+    static inline void store_outputs(
+        const OptionPricingView<T>& op, const PutPricingView<T>& put,
+        size_t i, size_t count, const VecT& underlying,
+        const VecT& sigma_root_t, const VecT& e_qt, const VecT& dividend_e_qt,
+        const VecT& discounted_strike, const VecT& rate_discounted_strike,
+        const VecT& time_discounted_strike, const VecT& n_d1,
+        const VecT& n_d2, const VecT& pdf_d1, const VecT& theta_decay,
+        const VecT& vega)
     {
         constexpr D d;
-        constexpr auto lanes = hn::Lanes(d);
-        // std::cout << "Lanes: " << hn::Lanes(d) << std::endl;
-
-        for (size_t i = 0; i < op.num_options; i += lanes) {
-            // Load initial option info
-            // TODO take care of the last vector in case it's not 0 mod lanes
-            const VecT underlying = hn::Load(d, op.underlyings.data() + i);
-            const VecT strike = hn::Load(d, op.strikes.data() + i);
-            const VecT risk_free_rate =
-                hn::Load(d, op.risk_free_rates.data() + i);
-            const VecT volatility = hn::Load(d, op.volatilities.data() + i);
-            const VecT time_to_expiry =
-                hn::Load(d, op.times_to_expiry.data() + i);
-            const VecT dividend_yield =
-                hn::Load(d, op.dividend_yields.data() + i);
-
-            // Calculate shared constants
-            const VecT sigma_root_t =
-                hn::Mul(volatility, hn::Sqrt(time_to_expiry));
-            const VecT e_qt = hn::Exp(
-                d, hn::Mul(
-                       hn::Set(d, static_cast<T>(-1.0)),
-                       hn::Mul(time_to_expiry, dividend_yield)));
-            const VecT e_rt = hn::Exp(
-                d, hn::Mul(
-                       hn::Set(d, static_cast<T>(-1.0)),
-                       hn::Mul(time_to_expiry, risk_free_rate)));
-
-            const VecT d1 = calc_d1<d>(
-                underlying, strike, risk_free_rate, time_to_expiry,
-                sigma_root_t);
-            const VecT n_d1 =
-                FastMathHelper::normal_cdf<VecT, T, lanes, D, d>(d1);
-
-            const VecT d2 = calc_d2(d1, sigma_root_t);
-            const VecT n_d2 =
-                FastMathHelper::normal_cdf<VecT, T, lanes, D, d>(d2);
-
-            // Actual price, greeks etc
-            if constexpr (Call) {
-                hn::Store(
-                    calc_call_price(underlying, e_qt, n_d1, strike, e_rt, n_d2),
-                    d, op.prices.data() + i);
-                hn::Store(calc_call_delta(e_qt, n_d1), d, op.deltas.data() + i);
-                hn::Store(
-                    calc_call_rho<d>(strike, time_to_expiry, e_rt, n_d2), d,
-                    op.rhos.data() + i);
-            } else {
-                const VecT n_minus_d1 = hn::Mul(
-                    hn::Set(d, static_cast<T>(-1.0)),
-                    hn::Sub(n_d1, hn::Set(d, static_cast<T>(1.0))));
-                const VecT n_minus_d2 = hn::Mul(
-                    hn::Set(d, static_cast<T>(-1.0)),
-                    hn::Sub(n_d2, hn::Set(d, static_cast<T>(1.0))));
-
-                hn::Store(
+        // Actual price, greeks etc
+        if constexpr (L == Legs::kMixed) {
+            // Branch-free: price both legs and keep one of them per lane
+            const auto is_call = hn::Gt(
+                load<Mode>(op.option_types.data() + i, count), hn::Zero(d));
+            const VecT n_minus_d1 = calc_n_minus<d>(n_d1);
+            const VecT n_minus_d2 = calc_n_minus<d>(n_d2);
+
+            if constexpr (Outputs & kPrice) {
+                store<Mode>(
+                    hn::IfThenElse(
+                        is_call,
+                        calc_call_price(
+                            underlying, e_qt, n_d1, discounted_strike, n_d2),
+                        calc_put_price(
+                            underlying, e_qt, n_minus_d1, discounted_strike,
+                            n_minus_d2)),
+                    op.prices.data() + i, count);
+            }
+            if constexpr (Outputs & kDelta) {
+                store<Mode>(
+                    hn::IfThenElse(
+                        is_call, calc_call_delta(e_qt, n_d1),
+                        calc_put_delta<d>(e_qt, n_minus_d1)),
+                    op.deltas.data() + i, count);
+            }
+            if constexpr (Outputs & kRho) {
+                store<Mode>(
+                    hn::IfThenElse(
+                        is_call,
+                        calc_call_rho<d>(time_discounted_strike, n_d2),
+                        calc_put_rho<d>(time_discounted_strike, n_minus_d2)),
+                    op.rhos.data() + i, count);
+            }
+            if constexpr (Outputs & kTheta) {
+                store<Mode>(
+                    hn::IfThenElse(
+                        is_call,
+                        calc_call_theta<d>(
+                            theta_decay, underlying, dividend_e_qt, n_d1,
+                            rate_discounted_strike, n_d2),
+                        calc_put_theta<d>(
+                            theta_decay, underlying, dividend_e_qt,
+                            n_minus_d1, rate_discounted_strike, n_minus_d2)),
+                    op.thetas.data() + i, count);
+            }
+        }
+        if constexpr (L == Legs::kCall || L == Legs::kCallAndPut) {
+            if constexpr (Outputs & kPrice) {
+                store<Mode>(
+                    calc_call_price(
+                        underlying, e_qt, n_d1, discounted_strike, n_d2),
+                    op.prices.data() + i, count);
+            }
+            if constexpr (Outputs & kDelta) {
+                store<Mode>(
+                    calc_call_delta(e_qt, n_d1), op.deltas.data() + i, count);
+            }
+            if constexpr (Outputs & kRho) {
+                store<Mode>(
+                    calc_call_rho<d>(time_discounted_strike, n_d2),
+                    op.rhos.data() + i, count);
+            }
+            if constexpr (Outputs & kTheta) {
+                store<Mode>(
+                    calc_call_theta<d>(
+                        theta_decay, underlying, dividend_e_qt, n_d1,
+                        rate_discounted_strike, n_d2),
+                    op.thetas.data() + i, count);
+            }
+        }
+        if constexpr (L == Legs::kPut || L == Legs::kCallAndPut) {
+            const VecT n_minus_d1 = calc_n_minus<d>(n_d1);
+            const VecT n_minus_d2 = calc_n_minus<d>(n_d2);
+
+            if constexpr (Outputs & kPrice) {
+                store<Mode>(
                     calc_put_price(
-                        underlying, e_qt, n_minus_d1, strike, e_rt, n_minus_d2),
-                    d, op.prices.data() + i);
-                hn::Store(
-                    calc_put_delta<d>(e_qt, n_minus_d1), d,
-                    op.deltas.data() + i);
-                hn::Store(
-                    calc_put_rho<d>(strike, time_to_expiry, e_rt, n_minus_d2),
-                    d, op.rhos.data() + i);
+                        underlying, e_qt, n_minus_d1, discounted_strike,
+                        n_minus_d2),
+                    put.prices.data() + i, count);
             }
+            if constexpr (Outputs & kDelta) {
+                store<Mode>(
+                    calc_put_delta<d>(e_qt, n_minus_d1),
+                    put.deltas.data() + i, count);
+            }
+            if constexpr (Outputs & kRho) {
+                store<Mode>(
+                    calc_put_rho<d>(time_discounted_strike, n_minus_d2),
+                    put.rhos.data() + i, count);
+            }
+            if constexpr (Outputs & kTheta) {
+                store<Mode>(
+                    calc_put_theta<d>(
+                        theta_decay, underlying, dividend_e_qt, n_minus_d1,
+                        rate_discounted_strike, n_minus_d2),
+                    put.thetas.data() + i, count);
+            }
+        }
 
-            const VecT pdf_d1 = FastMathHelper::normal_pdf<VecT, T, D, d>(d1);
-            hn::Store(
-                calc_gamma(e_qt, strike, sigma_root_t, pdf_d1), d,
-                op.gammas.data() + i);
-            hn::Store(
-                calc_vega<d>(underlying, e_qt, time_to_expiry, pdf_d1), d,
-                op.vegas.data() + i);
+        if constexpr (Outputs & kGamma) {
+            store<Mode>(
+                calc_gamma(e_qt, underlying, sigma_root_t, pdf_d1),
+                op.gammas.data() + i, count);
+        }
+        if constexpr (Outputs & kVega) {
+            store<Mode>(vega, op.vegas.data() + i, count);
+        }
+    }
+
+    template <Access Mode>
+    [[nodiscard]] static inline VecT load(const T* from, size_t count)
+    {
+        constexpr D d;
+        if constexpr (Mode == Access::kAligned || Mode == Access::kStreamed) {
+            return hn::Load(d, from);
+        } else if constexpr (Mode == Access::kUnaligned) {
+            return hn::LoadU(d, from);
+        } else {
+            return hn::LoadN(d, from, count);
+        }
+    }
+
+    template <Access Mode>
+    static inline void store(const VecT& v, T* to, size_t count)
+    {
+        constexpr D d;
+        if constexpr (Mode == Access::kAligned) {
+            hn::Store(v, d, to);
+        } else if constexpr (Mode == Access::kStreamed) {
+            hn::Stream(v, d, to);
+        } else if constexpr (Mode == Access::kUnaligned) {
+            hn::StoreU(v, d, to);
+        } else {
+            hn::StoreN(v, d, to, count);
         }
     }
 
+    // (log(S / K) + (r - q) * T) / (sigma * sqrt(T)) + sigma * sqrt(T) / 2
     template <D d>
     [[nodiscard]] static inline VecT calc_d1(
         const VecT& underlying, const VecT& strike, const VecT& risk_free_rate,
-        const VecT& time_to_expiry, const VecT& sigma_root_t)
+        const VecT& dividend_yield, const VecT& time_to_expiry,
+        const VecT& sigma_root_t)
     {
         return hn::Add(
             hn::Div(
-                hn::Add(
-                    hn::Log(d, hn::Div(underlying, strike)),
-                    hn::Mul(risk_free_rate, time_to_expiry)),
+                hn::MulAdd(
+                    hn::Sub(risk_free_rate, dividend_yield), time_to_expiry,
+                    FastMathHelper::log<VecT, T, D, d, A>(
+                        hn::Div(underlying, strike))),
                 sigma_root_t),
             hn::Mul(hn::Set(d, static_cast<T>(0.5)), sigma_root_t));
     }
@@ -122,21 +716,92 @@ class FastBlackScholes
         return hn::Sub(d1, sigma_root_t);
     }
 
+    // Precision::kMixed: N(d1) and N(d2) from one float vector holding the
+    // tails N(-|d1|) and N(-|d2|), so the CDF runs on twice the lanes. The
+    // tails keep float's relative precision and 1 - tail is taken in double
+    // for positive d, so N(d) only carries float error on min(N, 1 - N).
+    // Deep in the money, S e^(-qT) N(d1) - K e^(-rT) N(d2) then carries
+    // float error on the time value only, not on S and K. The discount
+    // factors and log(S / K) stay in double.
+    template <D d>
+    static inline void calc_normal_cdfs(
+        const VecT& d1, const VecT& d2, VecT& n_d1, VecT& n_d2)
+    {
+        VecT tail_d1, tail_d2;
+        if constexpr (HWY_TARGET == HWY_SCALAR) {
+            // A single lane has no halves to combine, one CDF per tail
+            using DH = hn::Rebind<float, D>;
+            using VecH = hn::Vec<DH>;
+            constexpr DH dh;
+            tail_d1 = hn::PromoteTo(
+                d, FastMathHelper::normal_cdf<VecH, float, DH, dh, A>(
+                       hn::DemoteTo(dh, hn::Neg(hn::Abs(d1)))));
+            tail_d2 = hn::PromoteTo(
+                d, FastMathHelper::normal_cdf<VecH, float, DH, dh, A>(
+                       hn::DemoteTo(dh, hn::Neg(hn::Abs(d2)))));
+        } else {
+            using DF = hn::Repartition<float, D>;
+            using DH = hn::Half<DF>;
+            using VecF = hn::Vec<DF>;
+            constexpr DF df;
+            constexpr DH dh;
+
+            const VecF tails =
+                FastMathHelper::normal_cdf<VecF, float, DF, df, A>(
+                    hn::Combine(
+                        df, hn::DemoteTo(dh, hn::Neg(hn::Abs(d2))),
+                        hn::DemoteTo(dh, hn::Neg(hn::Abs(d1)))));
+            tail_d1 = hn::PromoteTo(d, hn::LowerHalf(dh, tails));
+            tail_d2 = hn::PromoteTo(d, hn::UpperHalf(dh, tails));
+        }
+        const VecT zero = hn::Zero(d);
+        const VecT one = hn::Set(d, static_cast<T>(1.0));
+        n_d1 = hn::IfThenElse(
+            hn::Gt(d1, zero), hn::Sub(one, tail_d1), tail_d1);
+        n_d2 = hn::IfThenElse(
+            hn::Gt(d2, zero), hn::Sub(one, tail_d2), tail_d2);
+    }
+
+    // Precision::kMixed evaluates the PDF in float; its relative error stays
+    // at float precision, which is all gamma, vega and theta need.
+    template <D d>
+    [[nodiscard]] static inline VecT calc_normal_pdf(const VecT& x)
+    {
+        if constexpr (P == Precision::kMixed) {
+            using DH = hn::Rebind<float, D>;
+            constexpr DH dh;
+            return hn::PromoteTo(
+                d, FastMathHelper::normal_pdf<hn::Vec<DH>, float, DH, dh, A>(
+                       hn::DemoteTo(dh, x)));
+        } else {
+            return FastMathHelper::normal_pdf<VecT, T, D, d, A>(x);
+        }
+    }
+
+    // Put-call symmetry: N(-x) = 1 - N(x)
+    template <D d>
+    [[nodiscard]] static inline VecT calc_n_minus(const VecT& n)
+    {
+        return hn::Mul(
+            hn::Set(d, static_cast<T>(-1.0)),
+            hn::Sub(n, hn::Set(d, static_cast<T>(1.0))));
+    }
+
     [[nodiscard]] static inline VecT calc_call_price(
         const VecT& underlying, const VecT& e_qt, const VecT& n_d1,
-        const VecT& strike, const VecT& e_rt, const VecT& n_d2)
+        const VecT& discounted_strike, const VecT& n_d2)
     {
         return hn::Sub(
             hn::Mul(hn::Mul(underlying, e_qt), n_d1),
-            hn::Mul(hn::Mul(strike, e_rt), n_d2));
+            hn::Mul(discounted_strike, n_d2));
     }
 
     [[nodiscard]] static inline VecT calc_put_price(
         const VecT& underlying, const VecT& e_qt, const VecT& n_minus_d1,
-        const VecT& strike, const VecT& e_rt, const VecT& n_minus_d2)
+        const VecT& discounted_strike, const VecT& n_minus_d2)
     {
         return hn::Sub(
-            hn::Mul(hn::Mul(strike, e_rt), n_minus_d2),
+            hn::Mul(discounted_strike, n_minus_d2),
             hn::Mul(hn::Mul(underlying, e_qt), n_minus_d1));
     }
 
@@ -163,37 +828,84 @@ class FastBlackScholes
 
     template <D d>
     [[nodiscard]] static inline VecT calc_vega(
-        VecT underlying, VecT e_qt, VecT time_to_expiry, VecT pdf_d1)
+        VecT underlying, VecT e_qt, VecT root_t, VecT pdf_d1)
     {
         return hn::Mul(
             hn::Set(d, C),
-            hn::Mul(
-                underlying,
-                hn::Mul(e_qt, hn::Mul(hn::Sqrt(time_to_expiry), pdf_d1))));
+            hn::Mul(underlying, hn::Mul(e_qt, hn::Mul(root_t, pdf_d1))));
     }
 
     template <D d>
     [[nodiscard]] static inline VecT calc_call_rho(
-        VecT strike, VecT time_to_expiry, VecT e_rt, VecT n_d2)
+        VecT time_discounted_strike, VecT n_d2)
     {
-        return hn::Mul(
-            hn::Set(d, C),
-            hn::Mul(strike, hn::Mul(time_to_expiry, hn::Mul(e_rt, n_d2))));
+        return hn::Mul(hn::Set(d, C), hn::Mul(time_discounted_strike, n_d2));
     }
 
     template <D d>
     [[nodiscard]] static inline VecT calc_put_rho(
-        VecT strike, VecT time_to_expiry, VecT e_rt, VecT n_minus_d2)
+        VecT time_discounted_strike, VecT n_minus_d2)
+    {
+        return hn::Mul(
+            hn::Set(d, C_minus), hn::Mul(time_discounted_strike, n_minus_d2));
+    }
+
+    // -S * e^(-qT) * pdf(d1) * sigma / (2 * sqrt(T)), with
+    // sigma / sqrt(T) = sigma_root_t / T
+    template <D d>
+    [[nodiscard]] static inline VecT calc_theta_decay(
+        VecT underlying, VecT e_qt, VecT sigma_root_t, VecT time_to_expiry,
+        VecT pdf_d1)
     {
         return hn::Mul(
-            hn::Set(d, C_minus),
+            hn::Set(d, static_cast<T>(-0.5)),
             hn::Mul(
-                strike, hn::Mul(time_to_expiry, hn::Mul(e_rt, n_minus_d2))));
+                hn::Mul(underlying, e_qt),
+                hn::Mul(pdf_d1, hn::Div(sigma_root_t, time_to_expiry))));
     }
 
-   protected:
+    template <D d>
+    [[nodiscard]] static inline VecT calc_call_theta(
+        VecT theta_decay, VecT underlying, VecT dividend_e_qt, VecT n_d1,
+        VecT rate_discounted_strike, VecT n_d2)
+    {
+        return hn::Mul(
+            hn::Set(d, C_theta),
+            hn::Sub(
+                hn::Add(
+                    theta_decay,
+                    hn::Mul(hn::Mul(underlying, dividend_e_qt), n_d1)),
+                hn::Mul(rate_discounted_strike, n_d2)));
+    }
+
+    template <D d>
+    [[nodiscard]] static inline VecT calc_put_theta(
+        VecT theta_decay, VecT underlying, VecT dividend_e_qt, VecT n_minus_d1,
+        VecT rate_discounted_strike, VecT n_minus_d2)
+    {
+        return hn::Mul(
+            hn::Set(d, C_theta),
+            hn::Sub(
+                hn::Add(
+                    theta_decay, hn::Mul(rate_discounted_strike, n_minus_d2)),
+                hn::Mul(hn::Mul(underlying, dividend_e_qt), n_minus_d1)));
+    }
+
+    // Vega and rho per 1%, shared with the other engines
     static constexpr T C = 1.0 / 100.0;
     static constexpr T C_minus = -1.0 / 100.0;
+    // Theta per calendar day
+    static constexpr T C_theta = 1.0 / 365.0;
 };
 
-}  // namespace fast_option_pricer
\ No newline at end of file
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+
+#if HWY_TARGET == HWY_STATIC_TARGET
+using HWY_NAMESPACE::FastBlackScholes;
+#endif
+
+}  // namespace fast_option_pricer
+HWY_AFTER_NAMESPACE();
+
+#endif  // FAST_OPTION_PRICER_FAST_BLACK_SCHOLES_H_
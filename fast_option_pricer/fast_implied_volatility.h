@@ -0,0 +1,227 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+// Per-target include guard, see hwy/highway.h and math-inl.h
+#if defined(FAST_OPTION_PRICER_FAST_IMPLIED_VOLATILITY_H_) == \
+    defined(HWY_TARGET_TOGGLE)
+#ifdef FAST_OPTION_PRICER_FAST_IMPLIED_VOLATILITY_H_
+#undef FAST_OPTION_PRICER_FAST_IMPLIED_VOLATILITY_H_
+#else
+#define FAST_OPTION_PRICER_FAST_IMPLIED_VOLATILITY_H_
+#endif
+
+#include <hwy/highway.h>
+#include <limits>
+#include <type_traits>
+#include "common.h"
+#include "fast_black_scholes.h"
+#include "fast_math_helper.h"
+#include "math-inl.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace fast_option_pricer {
+namespace HWY_NAMESPACE {
+
+namespace hn = hwy::HWY_NAMESPACE;
+
+// Inverts quoted prices into the volatilities FastBlackScholes would price
+// them at, one vector of quotes at a time. Starts from the Corrado-Miller
+// approximation and runs Newton steps on the exact vega of the model, with a
+// per-lane bracket and bisection whenever a step would leave it. Lanes that
+// have converged are masked out, and a vector stops as soon as all have.
+// Quotes outside the prices at zero and infinite volatility come out NaN.
+template <IsFloatOrDouble T = double, typename D = hn::ScalableTag<T>>
+class FastImpliedVolatility
+{
+   public:
+    using VecT = hn::Vec<D>;
+    using Pricer = FastBlackScholes<T, D>;
+    using Access = typename Pricer::Access;
+
+    // Upper end of the search bracket
+    static constexpr T kMaxVolatility = 10.0;
+    // A lane has converged once a step moves its volatility by less
+    static constexpr T kTolerance = std::is_same_v<T, float> ? 1e-5 : 1e-11;
+    // Newton from the initial guess takes a handful of steps, the rest is
+    // room for lanes that fall back to bisection.
+    static constexpr size_t kMaxIterations =
+        std::is_same_v<T, float> ? 24 : 48;
+
+    static void implied_volatility(const ImpliedVolatilityView<T>& iv)
+    {
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+
+        size_t i = 0;
+        for (; i + lanes <= iv.num_options; i += lanes) {
+            solve_vector<Access::kUnaligned>(iv, i, lanes);
+        }
+        // Remainder of a batch that is not a multiple of lanes
+        if (i < iv.num_options) {
+            solve_vector<Access::kPartial>(iv, i, iv.num_options - i);
+        }
+    }
+
+    // Solves quotes [i, i + count), count <= lanes
+    template <Access Mode>
+    static inline void solve_vector(
+        const ImpliedVolatilityView<T>& iv, size_t i, size_t count)
+    {
+        constexpr D d;
+        const VecT zero = hn::Zero(d);
+        const VecT half = hn::Set(d, static_cast<T>(0.5));
+
+        // Load quotes
+        const VecT target = load<Mode>(iv.prices.data() + i, count);
+        const VecT underlying = load<Mode>(iv.underlyings.data() + i, count);
+        const VecT strike = load<Mode>(iv.strikes.data() + i, count);
+        const VecT risk_free_rate =
+            load<Mode>(iv.risk_free_rates.data() + i, count);
+        const VecT time_to_expiry =
+            load<Mode>(iv.times_to_expiry.data() + i, count);
+        const VecT dividend_yield =
+            load<Mode>(iv.dividend_yields.data() + i, count);
+        const VecT option_type =
+            iv.option_types.empty()
+                ? hn::Set(d, OptionType<T>::kCall)
+                : load<Mode>(iv.option_types.data() + i, count);
+        const auto is_call = hn::Gt(option_type, zero);
+
+        // Everything that does not depend on the volatility
+        const VecT root_t = hn::Sqrt(time_to_expiry);
+        const VecT e_qt = hn::Exp(
+            d, hn::Mul(
+                   hn::Set(d, static_cast<T>(-1.0)),
+                   hn::Mul(time_to_expiry, dividend_yield)));
+        const VecT e_rt = hn::Exp(
+            d, hn::Mul(
+                   hn::Set(d, static_cast<T>(-1.0)),
+                   hn::Mul(time_to_expiry, risk_free_rate)));
+        const VecT underlying_e_qt = hn::Mul(underlying, e_qt);
+        const VecT strike_e_rt = hn::Mul(strike, e_rt);
+        // Numerator of d1, see FastBlackScholes::calc_d1
+        const VecT log_moneyness = hn::MulAdd(
+            hn::Sub(risk_free_rate, dividend_yield), time_to_expiry,
+            hn::Log(d, hn::Div(underlying, strike)));
+
+        // Prices at zero and infinite volatility bound the attainable ones
+        const auto in_the_money = hn::Gt(log_moneyness, zero);
+        const VecT intrinsic = hn::IfThenElse(
+            is_call, hn::Sub(underlying_e_qt, strike_e_rt),
+            hn::Sub(strike_e_rt, underlying_e_qt));
+        const VecT lower = hn::IfThenElseZero(
+            hn::Not(hn::Xor(is_call, in_the_money)), intrinsic);
+        const VecT upper =
+            hn::IfThenElse(is_call, underlying_e_qt, strike_e_rt);
+        const auto valid =
+            hn::And(hn::Gt(target, lower), hn::Lt(target, upper));
+
+        VecT sigma = initial_guess<d>(
+            target, is_call, underlying_e_qt, strike_e_rt, root_t);
+        VecT lo = zero;
+        VecT hi = hn::Set(d, kMaxVolatility);
+        auto done = hn::Not(valid);
+        for (size_t it = 0; it < kMaxIterations && !hn::AllTrue(d, done);
+             ++it) {
+            const VecT sigma_root_t = hn::Mul(sigma, root_t);
+            const VecT d1 = hn::Add(
+                hn::Div(log_moneyness, sigma_root_t),
+                hn::Mul(half, sigma_root_t));
+            const VecT d2 = Pricer::calc_d2(d1, sigma_root_t);
+            const VecT n_d1 = FastMathHelper::normal_cdf<VecT, T, D, d>(d1);
+            const VecT n_d2 = FastMathHelper::normal_cdf<VecT, T, D, d>(d2);
+            const VecT price = hn::IfThenElse(
+                is_call,
+                Pricer::calc_call_price(
+                    underlying, e_qt, n_d1, strike_e_rt, n_d2),
+                Pricer::calc_put_price(
+                    underlying, e_qt, Pricer::template calc_n_minus<d>(n_d1),
+                    strike_e_rt, Pricer::template calc_n_minus<d>(n_d2)));
+            const VecT error = hn::Sub(price, target);
+
+            // dPrice/dSigma, S * e^(-qT) * pdf(d1) * sqrt(T)
+            const VecT vega = hn::Mul(
+                hn::Mul(
+                    underlying_e_qt,
+                    FastMathHelper::normal_pdf<VecT, T, D, d>(d1)),
+                root_t);
+
+            // Prices rise with volatility, so the error says which end of
+            // the bracket sigma replaces
+            const auto too_high = hn::Gt(error, zero);
+            hi = hn::IfThenElse(too_high, sigma, hi);
+            lo = hn::IfThenElse(too_high, lo, sigma);
+
+            // Bisect where Newton overshoots the bracket or vega vanishes
+            const VecT newton = hn::Sub(sigma, hn::Div(error, vega));
+            const auto inside = hn::And(hn::Gt(newton, lo), hn::Lt(newton, hi));
+            const VecT next =
+                hn::IfThenElse(inside, newton, hn::Mul(half, hn::Add(lo, hi)));
+
+            const auto converged = hn::Le(
+                hn::Abs(hn::Sub(next, sigma)), hn::Set(d, kTolerance));
+            sigma = hn::IfThenElse(done, sigma, next);
+            done = hn::Or(done, converged);
+        }
+
+        store<Mode>(
+            hn::IfThenElse(
+                valid, sigma,
+                hn::Set(d, std::numeric_limits<T>::quiet_NaN())),
+            iv.volatilities.data() + i, count);
+    }
+
+    // Corrado-Miller, on the call price given by put-call parity for puts:
+    // sigma * sqrt(T) ~ sqrt(2 pi) / (S' + K') *
+    //     (C - (S' - K') / 2 + sqrt((C - (S' - K') / 2)^2 - (S' - K')^2 / pi))
+    // with S' = S e^(-qT) and K' = K e^(-rT). Clamped into the bracket.
+    template <D d>
+    [[nodiscard]] static inline VecT initial_guess(
+        const VecT& target, const hn::Mask<D>& is_call,
+        const VecT& underlying_e_qt, const VecT& strike_e_rt,
+        const VecT& root_t)
+    {
+        const VecT spread = hn::Sub(underlying_e_qt, strike_e_rt);
+        const VecT call_price =
+            hn::IfThenElse(is_call, target, hn::Add(target, spread));
+        const VecT x = hn::NegMulAdd(
+            hn::Set(d, static_cast<T>(0.5)), spread, call_price);
+        const VecT discriminant = hn::NegMulAdd(
+            hn::Set(d, static_cast<T>(0.31830988618379067)),
+            hn::Mul(spread, spread), hn::Mul(x, x));
+        const VecT guess = hn::Div(
+            hn::Mul(
+                hn::Set(d, static_cast<T>(2.5066282746310002)),
+                hn::Add(x, hn::Sqrt(hn::Max(discriminant, hn::Zero(d))))),
+            hn::Mul(hn::Add(underlying_e_qt, strike_e_rt), root_t));
+        return hn::Min(
+            hn::Max(guess, hn::Set(d, static_cast<T>(0.01))),
+            hn::Set(d, static_cast<T>(0.5) * kMaxVolatility));
+    }
+
+   private:
+    template <Access Mode>
+    [[nodiscard]] static inline VecT load(const T* from, size_t count)
+    {
+        return Pricer::template load<Mode>(from, count);
+    }
+
+    template <Access Mode>
+    static inline void store(const VecT& v, T* to, size_t count)
+    {
+        Pricer::template store<Mode>(v, to, count);
+    }
+};
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+
+#if HWY_TARGET == HWY_STATIC_TARGET
+using HWY_NAMESPACE::FastImpliedVolatility;
+#endif
+
+}  // namespace fast_option_pricer
+HWY_AFTER_NAMESPACE();
+
+#endif  // FAST_OPTION_PRICER_FAST_IMPLIED_VOLATILITY_H_
@@ -2,44 +2,195 @@
 // Created by Karolis Spukas on 10/2/2024.
 //
 
-#pragma once
+// Per-target include guard, see hwy/highway.h and math-inl.h
+#if defined(FAST_OPTION_PRICER_FAST_MATH_HELPER_H_) == \
+    defined(HWY_TARGET_TOGGLE)
+#ifdef FAST_OPTION_PRICER_FAST_MATH_HELPER_H_
+#undef FAST_OPTION_PRICER_FAST_MATH_HELPER_H_
+#else
+#define FAST_OPTION_PRICER_FAST_MATH_HELPER_H_
+#endif
 
 #include <hwy/highway.h>
+#include <limits>
+#include "common.h"
 #include "math-inl.h"
 
+HWY_BEFORE_NAMESPACE();
 namespace fast_option_pricer {
+namespace HWY_NAMESPACE {
 
 namespace hn = hwy::HWY_NAMESPACE;
 
+// Vector exp, log, normal CDF and PDF at a selectable Accuracy. The cheaper
+// tiers keep the usual range reductions but evaluate lower degree
+// polynomials; coefficients are minimax fits, the CDF is Abramowitz & Stegun
+// 26.2.17 (kFast) and 26.2.16 (kFastest). Max errors in double recorded by
+// the AccuracyTiers tests, relative for exp on [-50, 2] and log on
+// [0.01, 100], absolute for the CDF on [-10, 10]. kExact is Highway's and
+// only checked against a bound:
+//
+//             exp       log       normal_cdf
+// kExact      < 4e-16   < 4e-16   < 4e-16
+// kFast       1.0e-7    1.2e-7    8.4e-8
+// kFastest    5.3e-6    1.2e-7    1.1e-5
 class FastMathHelper
 {
    public:
-    template <typename VecT, typename T, unsigned long Lanes, typename D, D d>
-    [[nodiscard]] static inline VecT normal_cdf(const VecT& x)
+    template <
+        typename VecT, typename T, typename D, D d,
+        Accuracy A = Accuracy::kExact>
+    [[nodiscard]] static inline VecT exp(const VecT& x)
     {
-        VecT res = hn::Div(
-            hn::Mul(hn::Set(d, static_cast<T>(-1.0)), x),
-            hn::Sqrt(hn::Set(d, static_cast<T>(2.0))));
-
-        // Highway math-inl.h does not have erf or erfc
-        std::array<T, Lanes> tmp;
-        hn::Store(res, d, tmp.data());
-        for (auto& el : tmp) {
-            el = std::erfc(el);
+        if constexpr (A == Accuracy::kExact) {
+            return hn::Exp(d, x);
+        } else {
+            hn::impl::ExpImpl<T> impl;
+
+            // Same reduction as hn::Exp: x = q * ln(2) + r, |r| <= ln(2) / 2
+            const auto q = impl.ToInt32(
+                d, hn::MulAdd(
+                       x, hn::Set(d, static_cast<T>(1.4426950408889634)),
+                       hn::Or(
+                           hn::Set(d, static_cast<T>(0.5)),
+                           hn::And(x, hn::Set(d, static_cast<T>(-0.0))))));
+            const VecT r = impl.ExpReduce(d, x, q);
+
+            // e^r = 1 + r + r^2 * P(r)
+            VecT p;
+            if constexpr (A == Accuracy::kFast) {
+                p = hn::impl::Estrin(
+                    r, hn::Set(d, static_cast<T>(0.49999231790146836)),
+                    hn::Set(d, static_cast<T>(0.16667114465596508)),
+                    hn::Set(d, static_cast<T>(0.04189011336158931)),
+                    hn::Set(d, static_cast<T>(0.008312524917304874)));
+            } else {
+                p = hn::impl::Estrin(
+                    r, hn::Set(d, static_cast<T>(0.5000511603018585)),
+                    hn::Set(d, static_cast<T>(0.1675351402251131)),
+                    hn::Set(d, static_cast<T>(0.04127774765005143)));
+            }
+            const VecT y = impl.LoadExpShortRange(
+                d,
+                hn::Add(
+                    hn::MulAdd(p, hn::Mul(r, r), r),
+                    hn::Set(d, static_cast<T>(1.0))),
+                q);
+            return hn::IfThenElseZero(
+                hn::Ge(
+                    x, hn::Set(
+                           d, static_cast<T>(
+                                  sizeof(T) == 4 ? -104.0 : -1000.0))),
+                y);
         }
+    }
 
-        res = hn::Mul(hn::Set(d, 0.5), hn::Load(d, tmp.data()));
-        return res;
+    // The cheaper tiers expect positive normal x, e.g. S / K
+    template <
+        typename VecT, typename T, typename D, D d,
+        Accuracy A = Accuracy::kExact>
+    [[nodiscard]] static inline VecT log(const VecT& x)
+    {
+        if constexpr (A == Accuracy::kExact) {
+            return hn::Log(d, x);
+        } else {
+            using TI = hwy::MakeSigned<T>;
+            constexpr hn::Rebind<TI, D> di;
+            constexpr int kMantissaBits = std::numeric_limits<T>::digits - 1;
+            const VecT one = hn::Set(d, static_cast<T>(1.0));
+
+            // x = 2^e * m with m in [sqrt(2) / 2, sqrt(2)), found by
+            // subtracting the bits of sqrt(2) / 2 from those of x
+            const auto bits = hn::BitCast(di, x);
+            const auto e = hn::ShiftRight<kMantissaBits>(hn::Sub(
+                bits, hn::Set(
+                          di, static_cast<TI>(
+                                  sizeof(T) == 4 ? 0x3F3504F3
+                                                 : 0x3FE6A09E667F3BCD))));
+            const VecT m = hn::BitCast(
+                d, hn::Sub(bits, hn::ShiftLeft<kMantissaBits>(e)));
+
+            // log(m) = 2 * atanh(z) = 2 * z * P(z^2), z = (m - 1) / (m + 1).
+            // kFastest keeps this degree too: d1 divides log(S / K) by
+            // sigma * sqrt(T), which amplifies its error for short expiries.
+            const VecT z = hn::Div(hn::Sub(m, one), hn::Add(m, one));
+            const VecT z2 = hn::Mul(z, z);
+            const VecT p = hn::MulAdd(
+                hn::MulAdd(
+                    z2, hn::Set(d, static_cast<T>(0.20648193296905926)),
+                    hn::Set(d, static_cast<T>(0.33326111687691967))),
+                z2, hn::Set(d, static_cast<T>(1.0000001186923306)));
+            return hn::MulAdd(
+                hn::ConvertTo(d, e),
+                hn::Set(d, static_cast<T>(0.6931471805599453)),
+                hn::Mul(hn::Add(z, z), p));
+        }
     }
 
-    template <typename VecT, typename T, typename D, D d>
+    template <
+        typename VecT, typename T, typename D, D d,
+        Accuracy A = Accuracy::kExact>
+    [[nodiscard]] static inline VecT normal_cdf(const VecT& x)
+    {
+        if constexpr (A == Accuracy::kExact) {
+            return hn::NormalCdf(d, x);
+        } else {
+            // N(-|x|) = pdf(|x|) * t * P(t), t = 1 / (1 + p * |x|)
+            const VecT one = hn::Set(d, static_cast<T>(1.0));
+            const VecT abs_x = hn::Abs(x);
+            VecT t;
+            VecT p;
+            if constexpr (A == Accuracy::kFast) {
+                t = hn::Div(
+                    one, hn::MulAdd(
+                             hn::Set(d, static_cast<T>(0.2316419)), abs_x,
+                             one));
+                p = hn::MulAdd(
+                    hn::MulAdd(
+                        hn::MulAdd(
+                            hn::MulAdd(
+                                hn::Set(d, static_cast<T>(1.330274429)), t,
+                                hn::Set(d, static_cast<T>(-1.821255978))),
+                            t, hn::Set(d, static_cast<T>(1.781477937))),
+                        t, hn::Set(d, static_cast<T>(-0.356563782))),
+                    t, hn::Set(d, static_cast<T>(0.319381530)));
+            } else {
+                t = hn::Div(
+                    one, hn::MulAdd(
+                             hn::Set(d, static_cast<T>(0.33267)), abs_x, one));
+                p = hn::MulAdd(
+                    hn::MulAdd(
+                        hn::Set(d, static_cast<T>(0.9372980)), t,
+                        hn::Set(d, static_cast<T>(-0.1201676))),
+                    t, hn::Set(d, static_cast<T>(0.4361836)));
+            }
+            const VecT lower_tail =
+                hn::Mul(normal_pdf<VecT, T, D, d, A>(abs_x), hn::Mul(t, p));
+            return hn::IfThenElse(
+                hn::Lt(x, hn::Zero(d)), lower_tail, hn::Sub(one, lower_tail));
+        }
+    }
+
+    template <
+        typename VecT, typename T, typename D, D d,
+        Accuracy A = Accuracy::kExact>
     [[nodiscard]] static inline VecT normal_pdf(const VecT& x)
     {
         return hn::Mul(
             hn::Set(d, static_cast<T>(0.3989422804014327)),
-            hn::Exp(
-                d, hn::Mul(hn::Set(d, static_cast<T>(-0.5)), hn::Mul(x, x))));
+            exp<VecT, T, D, d, A>(
+                hn::Mul(hn::Set(d, static_cast<T>(-0.5)), hn::Mul(x, x))));
     }
 };
 
-}  // namespace fast_option_pricer
\ No newline at end of file
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+
+#if HWY_TARGET == HWY_STATIC_TARGET
+using HWY_NAMESPACE::FastMathHelper;
+#endif
+
+}  // namespace fast_option_pricer
+HWY_AFTER_NAMESPACE();
+
+#endif  // FAST_OPTION_PRICER_FAST_MATH_HELPER_H_
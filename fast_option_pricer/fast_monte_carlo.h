@@ -0,0 +1,579 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+// Per-target include guard, see hwy/highway.h and math-inl.h
+#if defined(FAST_OPTION_PRICER_FAST_MONTE_CARLO_H_) == \
+    defined(HWY_TARGET_TOGGLE)
+#ifdef FAST_OPTION_PRICER_FAST_MONTE_CARLO_H_
+#undef FAST_OPTION_PRICER_FAST_MONTE_CARLO_H_
+#else
+#define FAST_OPTION_PRICER_FAST_MONTE_CARLO_H_
+#endif
+
+#include <hwy/highway.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+#include "common.h"
+#include "fast_black_scholes.h"
+#include "fast_math_helper.h"
+#include "fast_philox.h"
+#include "math-inl.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace fast_option_pricer {
+namespace HWY_NAMESPACE {
+
+namespace hn = hwy::HWY_NAMESPACE;
+
+// Monte Carlo prices of European, Asian and lookback options under geometric
+// Brownian motion, see PathPayoff. Options run one at a time with one path
+// per lane: a vector holds the log moves of as many paths as there are
+// lanes, so paths are laid out SoA and every step is a FastPhilox draw and a
+// MulAdd. Paths are never stored;
+// payoffs go straight into per-lane sums and sums of squares, which are
+// reduced every kPathsPerBlock paths so float sums keep their digits.
+// Path-dependent payoffs fold every step into running averages and extremes
+// on the way, see path_payoffs.
+//
+// The underlying drifts at r - q. accumulate and finish split a run into
+// path ranges, e.g. one per thread, see ParallelBlackScholes.
+template <
+    IsFloatOrDouble T = double, typename D = hn::ScalableTag<T>,
+    Accuracy A = Accuracy::kExact>
+class FastMonteCarlo
+{
+   public:
+    using VecT = hn::Vec<D>;
+    using Pricer = FastBlackScholes<T, D, A>;
+    using Access = typename Pricer::Access;
+    using Legs = typename Pricer::Legs;
+    using Philox = FastPhilox<T, D, A>;
+
+    static constexpr size_t kPathsPerBlock = 4096;
+
+    // Writes the estimates to op.prices, and their standard errors to
+    // standard_errors unless it is empty
+    template <bool Call = true>
+    static void price(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        std::span<T> standard_errors = {})
+    {
+        constexpr Legs L = Call ? Legs::kCall : Legs::kPut;
+        price_legs<L>(op, settings, standard_errors);
+    }
+
+    // See FastBlackScholes::price_mixed
+    static void price_mixed(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        std::span<T> standard_errors = {})
+    {
+        assert(op.num_options == op.option_types.size());
+        price_legs<Legs::kMixed>(op, settings, standard_errors);
+    }
+
+    // Adds the payoffs of paths [first_path, first_path + num_paths) of
+    // option i to sums[i], and their squares to sums_of_squares[i].
+    // Payoffs are not discounted, see finish.
+    template <bool Call = true>
+    static void accumulate(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        size_t first_path, size_t num_paths, std::span<T> sums,
+        std::span<T> sums_of_squares)
+    {
+        constexpr Legs L = Call ? Legs::kCall : Legs::kPut;
+        accumulate_legs<L>(
+            op, settings, first_path, num_paths, sums, sums_of_squares);
+    }
+
+    static void accumulate_mixed(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        size_t first_path, size_t num_paths, std::span<T> sums,
+        std::span<T> sums_of_squares)
+    {
+        assert(op.num_options == op.option_types.size());
+        accumulate_legs<Legs::kMixed>(
+            op, settings, first_path, num_paths, sums, sums_of_squares);
+    }
+
+    // Discounted means of the sums of all settings.num_paths payoffs of
+    // every option into op.prices, and their standard errors into
+    // standard_errors unless it is empty
+    static void finish(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        std::span<const T> sums, std::span<const T> sums_of_squares,
+        std::span<T> standard_errors = {})
+    {
+        assert(op.has_outputs(kPrice));
+        assert(op.num_options <= sums.size());
+        assert(op.num_options <= sums_of_squares.size());
+        assert(
+            standard_errors.empty() ||
+            op.num_options <= standard_errors.size());
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+
+        size_t i = 0;
+        for (; i + lanes <= op.num_options; i += lanes) {
+            finish_vector<Access::kUnaligned>(
+                op, settings, sums, sums_of_squares, standard_errors, i,
+                lanes);
+        }
+        // Remainder of a batch that is not a multiple of lanes
+        if (i < op.num_options) {
+            finish_vector<Access::kPartial>(
+                op, settings, sums, sums_of_squares, standard_errors, i,
+                op.num_options - i);
+        }
+    }
+
+    // Writes the underlying of option i at the end of step s of path p to
+    // paths[s * settings.num_paths + p], one row of paths per step
+    static void simulate(
+        const OptionPricingView<T>& op, size_t i,
+        const MonteCarloSettings& settings, std::span<T> paths)
+    {
+        assert(i < op.num_options);
+        assert(settings.num_steps * settings.num_paths <= paths.size());
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+
+        size_t p = 0;
+        for (; p + lanes <= settings.num_paths; p += lanes) {
+            simulate_vector<Access::kUnaligned>(op, i, settings, paths, p);
+        }
+        // Remainder of paths that are not a multiple of lanes
+        if (p < settings.num_paths) {
+            simulate_vector<Access::kPartial>(op, i, settings, paths, p);
+        }
+    }
+
+   private:
+    using DU = typename Philox::DU;
+    using VecU = typename Philox::VecU;
+
+    template <Legs L>
+    static void price_legs(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        std::span<T> standard_errors)
+    {
+        std::vector<T> sums(op.num_options, 0);
+        std::vector<T> sums_of_squares(op.num_options, 0);
+        accumulate_legs<L>(
+            op, settings, 0, settings.num_paths, sums, sums_of_squares);
+        finish(op, settings, sums, sums_of_squares, standard_errors);
+    }
+
+    template <Legs L>
+    static void accumulate_legs(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        size_t first_path, size_t num_paths, std::span<T> sums,
+        std::span<T> sums_of_squares)
+    {
+        assert(op.has_input_columns());
+        assert(op.num_options <= sums.size());
+        assert(op.num_options <= sums_of_squares.size());
+        // Path and option indices are 32-bit Philox counter words
+        assert(
+            first_path + num_paths <= std::numeric_limits<uint32_t>::max());
+        assert(op.num_options <= std::numeric_limits<uint32_t>::max());
+
+        const Kernel kernel = path_kernel(settings);
+        for (size_t i = 0; i < op.num_options; ++i) {
+            // +1 for calls and -1 for puts, see OptionType
+            T sign = L == Legs::kPut ? T{-1} : T{1};
+            if constexpr (L == Legs::kMixed) {
+                sign = op.option_types[i];
+            }
+            kernel(
+                op, i, sign, settings, first_path, num_paths, sums[i],
+                sums_of_squares[i]);
+        }
+    }
+
+    using Kernel = void (*)(
+        const OptionPricingView<T>&, size_t, T, const MonteCarloSettings&,
+        size_t, size_t, T&, T&);
+
+    // accumulate_option for the payoff and pairing of the settings
+    static inline Kernel path_kernel(const MonteCarloSettings& settings)
+    {
+        switch (settings.payoff) {
+            case PathPayoff::kArithmeticAsian:
+                return paired_kernel<PathPayoff::kArithmeticAsian>(settings);
+            case PathPayoff::kGeometricAsian:
+                return paired_kernel<PathPayoff::kGeometricAsian>(settings);
+            case PathPayoff::kFixedLookback:
+                return paired_kernel<PathPayoff::kFixedLookback>(settings);
+            case PathPayoff::kFloatingLookback:
+                return paired_kernel<PathPayoff::kFloatingLookback>(settings);
+            case PathPayoff::kEuropean:
+            default:
+                return paired_kernel<PathPayoff::kEuropean>(settings);
+        }
+    }
+
+    template <PathPayoff P>
+    static inline Kernel paired_kernel(const MonteCarloSettings& settings)
+    {
+        return settings.antithetic ? &accumulate_option<P, true>
+                                   : &accumulate_option<P, false>;
+    }
+
+    template <PathPayoff P, bool Antithetic>
+    static void accumulate_option(
+        const OptionPricingView<T>& op, size_t i, T sign,
+        const MonteCarloSettings& settings, size_t first_path,
+        size_t num_paths, T& sum, T& sum_of_squares)
+    {
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+        const VecT underlying = hn::Set(d, op.underlyings[i]);
+        const VecT strike = hn::Set(d, op.strikes[i]);
+        VecT drift, diffusion;
+        step_terms(op, i, settings, drift, diffusion);
+        // The geometric Asian controls the arithmetic one: both average the
+        // same path, and the mean of the geometric is known. Geometric
+        // Asians come out at that mean with no error.
+        const bool control = (P == PathPayoff::kArithmeticAsian ||
+                              P == PathPayoff::kGeometricAsian) &&
+                             settings.control_variate;
+        const VecT control_mean =
+            control ? geometric_asian(op, i, sign, settings) : hn::Zero(d);
+
+        for (size_t block = 0; block < num_paths; block += kPathsPerBlock) {
+            const size_t block_end =
+                std::min(num_paths, block + kPathsPerBlock);
+            VecT block_sum = hn::Zero(d);
+            VecT block_squares = hn::Zero(d);
+            for (size_t p = block; p < block_end; p += lanes) {
+                VecT payoff, geometric;
+                path_payoffs<P, Antithetic>(
+                    settings, i, first_path + p, sign, underlying, strike,
+                    drift, diffusion, payoff, geometric);
+                if (control) {
+                    payoff = hn::Add(hn::Sub(payoff, geometric), control_mean);
+                }
+                // Lanes past the end of the range simulated paths that
+                // belong to the next range
+                if (p + lanes > block_end) {
+                    payoff = hn::IfThenElseZero(
+                        hn::FirstN(d, block_end - p), payoff);
+                }
+                block_sum = hn::Add(block_sum, payoff);
+                block_squares = hn::MulAdd(payoff, payoff, block_squares);
+            }
+            sum += hn::ReduceSum(d, block_sum);
+            sum_of_squares += hn::ReduceSum(d, block_squares);
+        }
+    }
+
+    // Payoffs P of the paths [path, path + lanes) of option i, averaged
+    // with their mirrors when Antithetic. Every path only keeps running
+    // accumulators: the sums of the underlying and of its log moves over
+    // the monitoring dates, and its lowest and highest log moves, which
+    // start at 0 for the start of the path. 'geometric' gets the payoffs
+    // of the geometric Asian on the same paths for Asians.
+    template <PathPayoff P, bool Antithetic>
+    static inline void path_payoffs(
+        const MonteCarloSettings& settings, size_t i, size_t path, T sign,
+        const VecT& underlying, const VecT& strike, const VecT& drift,
+        const VecT& diffusion, VecT& payoff, VecT& geometric)
+    {
+        constexpr D d;
+        constexpr bool kAsian = P == PathPayoff::kArithmeticAsian ||
+                                P == PathPayoff::kGeometricAsian;
+        constexpr bool kLookback = P == PathPayoff::kFixedLookback ||
+                                   P == PathPayoff::kFloatingLookback;
+        VecT spot_sum = hn::Zero(d), log_sum = hn::Zero(d);
+        VecT low = hn::Zero(d), high = hn::Zero(d);
+        VecT mirror_spot_sum = hn::Zero(d), mirror_log_sum = hn::Zero(d);
+        VecT mirror_low = hn::Zero(d), mirror_high = hn::Zero(d);
+        const auto monitor = [&](const VecT& step_log_move, VecT& spots,
+                                 VecT& logs, VecT& lowest, VecT& highest) {
+            if constexpr (P == PathPayoff::kArithmeticAsian) {
+                spots = hn::Add(
+                    spots,
+                    FastMathHelper::exp<VecT, T, D, d, A>(step_log_move));
+            }
+            if constexpr (kAsian) {
+                logs = hn::Add(logs, step_log_move);
+            }
+            if constexpr (kLookback) {
+                lowest = hn::Min(lowest, step_log_move);
+                highest = hn::Max(highest, step_log_move);
+            }
+        };
+
+        VecT log_move, mirror_log_move;
+        simulate_paths<Antithetic>(
+            settings, i, path, drift, diffusion,
+            [&](size_t, const VecT& step_log_move,
+                const VecT& mirror_step_log_move) {
+                monitor(step_log_move, spot_sum, log_sum, low, high);
+                if constexpr (Antithetic) {
+                    monitor(
+                        mirror_step_log_move, mirror_spot_sum,
+                        mirror_log_sum, mirror_low, mirror_high);
+                }
+            },
+            log_move, mirror_log_move);
+
+        const T num_steps = static_cast<T>(settings.num_steps);
+        payoff = path_payoff<P>(
+            sign, underlying, strike, num_steps, log_move, spot_sum, log_sum,
+            low, high);
+        geometric = hn::Zero(d);
+        if constexpr (kAsian) {
+            geometric = path_payoff<PathPayoff::kGeometricAsian>(
+                sign, underlying, strike, num_steps, log_move, spot_sum,
+                log_sum, low, high);
+        }
+        if constexpr (Antithetic) {
+            const VecT half = hn::Set(d, static_cast<T>(0.5));
+            payoff = hn::Mul(
+                half, hn::Add(
+                          payoff, path_payoff<P>(
+                                      sign, underlying, strike, num_steps,
+                                      mirror_log_move, mirror_spot_sum,
+                                      mirror_log_sum, mirror_low,
+                                      mirror_high)));
+            if constexpr (kAsian) {
+                geometric = hn::Mul(
+                    half, hn::Add(
+                              geometric,
+                              path_payoff<PathPayoff::kGeometricAsian>(
+                                  sign, underlying, strike, num_steps,
+                                  mirror_log_move, mirror_spot_sum,
+                                  mirror_log_sum, mirror_low, mirror_high)));
+            }
+        }
+    }
+
+    // Payoff P from the accumulators of path_payoffs and the log move at
+    // expiry
+    template <PathPayoff P>
+    static inline VecT path_payoff(
+        T sign, const VecT& underlying, const VecT& strike, T num_steps,
+        const VecT& log_move, const VecT& spot_sum, const VecT& log_sum,
+        const VecT& low, const VecT& high)
+    {
+        constexpr D d;
+        const VecT signs = hn::Set(d, sign);
+        const bool call = sign > 0;
+        // Underlying after a log move of x
+        const auto spot = [&](const VecT& x) {
+            return hn::Mul(
+                underlying, FastMathHelper::exp<VecT, T, D, d, A>(x));
+        };
+        // max(+-(level - K), 0)
+        const auto vanilla = [&](const VecT& level) {
+            return hn::Max(
+                hn::Mul(signs, hn::Sub(level, strike)), hn::Zero(d));
+        };
+
+        if constexpr (P == PathPayoff::kArithmeticAsian) {
+            return vanilla(
+                hn::Mul(underlying, hn::Div(spot_sum, hn::Set(d, num_steps))));
+        } else if constexpr (P == PathPayoff::kGeometricAsian) {
+            return vanilla(
+                spot(hn::Div(log_sum, hn::Set(d, num_steps))));
+        } else if constexpr (P == PathPayoff::kFixedLookback) {
+            return vanilla(spot(call ? high : low));
+        } else if constexpr (P == PathPayoff::kFloatingLookback) {
+            return hn::Mul(
+                signs,
+                hn::Sub(spot(log_move), spot(call ? low : high)));
+        } else {
+            return vanilla(spot(log_move));
+        }
+    }
+
+    // Undiscounted price of the geometric Asian on option i. Its log is
+    // normal with mean log S + (r - q - sigma^2 / 2) dt (N + 1) / 2 and
+    // variance sigma^2 dt (N + 1) (2N + 1) / 6N over N steps of dt, so it
+    // prices like Black's formula on the forward e^(mean + variance / 2).
+    static inline VecT geometric_asian(
+        const OptionPricingView<T>& op, size_t i, T sign,
+        const MonteCarloSettings& settings)
+    {
+        constexpr D d;
+        const T num_steps = static_cast<T>(settings.num_steps);
+        const T dt = op.times_to_expiry[i] / num_steps;
+        const T volatility = op.volatilities[i];
+        const T half_variance = static_cast<T>(0.5) * volatility * volatility;
+        const VecT variance = hn::Set(
+            d, volatility * volatility * dt * (num_steps + 1) *
+                   (2 * num_steps + 1) / (6 * num_steps));
+        const VecT mean = hn::Add(
+            FastMathHelper::log<VecT, T, D, d, A>(
+                hn::Set(d, op.underlyings[i])),
+            hn::Set(
+                d, (op.risk_free_rates[i] - op.dividend_yields[i] -
+                    half_variance) *
+                       dt * (num_steps + 1) / 2));
+        const VecT strike = hn::Set(d, op.strikes[i]);
+        const VecT deviation = hn::Sqrt(variance);
+        const VecT forward = FastMathHelper::exp<VecT, T, D, d, A>(
+            hn::MulAdd(hn::Set(d, static_cast<T>(0.5)), variance, mean));
+        const VecT d1 = hn::Div(
+            hn::Add(
+                hn::Sub(mean, FastMathHelper::log<VecT, T, D, d, A>(strike)),
+                variance),
+            deviation);
+        const VecT d2 = hn::Sub(d1, deviation);
+        // F N(d1) - K N(d2) for calls, K N(-d2) - F N(-d1) for puts
+        const VecT signs = hn::Set(d, sign);
+        return hn::Mul(
+            signs,
+            hn::Sub(
+                hn::Mul(
+                    forward, FastMathHelper::normal_cdf<VecT, T, D, d, A>(
+                                 hn::Mul(signs, d1))),
+                hn::Mul(
+                    strike, FastMathHelper::normal_cdf<VecT, T, D, d, A>(
+                                hn::Mul(signs, d2)))));
+    }
+
+    // (r - q - sigma^2 / 2) * dt and sigma * sqrt(dt) of option i
+    static inline void step_terms(
+        const OptionPricingView<T>& op, size_t i,
+        const MonteCarloSettings& settings, VecT& drift, VecT& diffusion)
+    {
+        constexpr D d;
+        const T dt = op.times_to_expiry[i] / static_cast<T>(settings.num_steps);
+        const T volatility = op.volatilities[i];
+        drift = hn::Set(
+            d, (op.risk_free_rates[i] - op.dividend_yields[i] -
+                static_cast<T>(0.5) * volatility * volatility) *
+                   dt);
+        diffusion = hn::Set(d, volatility * std::sqrt(dt));
+    }
+
+    // Steps the paths [path, path + lanes) of option i to expiry, calling
+    // f(s, log_move, mirror_log_move) at the end of every step s with the
+    // log move of the underlying since the start. When Antithetic, every
+    // path has a mirror stepped on the negated normals, otherwise
+    // mirror_log_move stays 0. Leaves the log moves at expiry in log_move
+    // and mirror_log_move.
+    template <bool Antithetic, typename F>
+    static inline void simulate_paths(
+        const MonteCarloSettings& settings, size_t i, size_t path,
+        const VecT& drift, const VecT& diffusion, const F& f, VecT& log_move,
+        VecT& mirror_log_move)
+    {
+        constexpr D d;
+        constexpr DU du;
+        const VecU counter = hn::Iota(du, static_cast<uint32_t>(path));
+        log_move = hn::Zero(d);
+        mirror_log_move = hn::Zero(d);
+        const auto step = [&](size_t s, const VecT& z) {
+            log_move = hn::Add(log_move, hn::MulAdd(diffusion, z, drift));
+            if constexpr (Antithetic) {
+                mirror_log_move = hn::Add(
+                    mirror_log_move, hn::NegMulAdd(diffusion, z, drift));
+            }
+            f(s, log_move, mirror_log_move);
+        };
+        // Every draw is two normals, i.e. two steps
+        for (size_t s = 0; s < settings.num_steps; s += 2) {
+            VecT z0, z1;
+            Philox::normals(
+                settings.seed, counter, static_cast<uint32_t>(s / 2),
+                static_cast<uint32_t>(i), z0, z1);
+            step(s, z0);
+            if (s + 1 < settings.num_steps) {
+                step(s + 1, z1);
+            }
+        }
+    }
+
+    template <Access Mode>
+    static inline void simulate_vector(
+        const OptionPricingView<T>& op, size_t i,
+        const MonteCarloSettings& settings, std::span<T> paths, size_t p)
+    {
+        constexpr D d;
+        const size_t count =
+            Mode == Access::kPartial ? settings.num_paths - p : hn::Lanes(d);
+        const VecT underlying = hn::Set(d, op.underlyings[i]);
+        VecT drift, diffusion, log_move, mirror_log_move;
+        step_terms(op, i, settings, drift, diffusion);
+        simulate_paths<false>(
+            settings, i, p, drift, diffusion,
+            [&](size_t s, const VecT& step_log_move, const VecT&) {
+                store<Mode>(
+                    hn::Mul(
+                        underlying,
+                        FastMathHelper::exp<VecT, T, D, d, A>(step_log_move)),
+                    paths.data() + s * settings.num_paths + p, count);
+            },
+            log_move, mirror_log_move);
+    }
+
+    template <Access Mode>
+    static inline void finish_vector(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        std::span<const T> sums, std::span<const T> sums_of_squares,
+        std::span<T> standard_errors, size_t i, size_t count)
+    {
+        constexpr D d;
+        const VecT risk_free_rate =
+            load<Mode>(op.risk_free_rates.data() + i, count);
+        const VecT time_to_expiry =
+            load<Mode>(op.times_to_expiry.data() + i, count);
+        const VecT e_rt = FastMathHelper::exp<VecT, T, D, d, A>(
+            hn::Neg(hn::Mul(time_to_expiry, risk_free_rate)));
+        const VecT num_paths =
+            hn::Set(d, static_cast<T>(settings.num_paths));
+        const VecT mean =
+            hn::Div(load<Mode>(sums.data() + i, count), num_paths);
+        store<Mode>(hn::Mul(e_rt, mean), op.prices.data() + i, count);
+
+        if (!standard_errors.empty()) {
+            // Sample variance of the payoffs over the paths, then the
+            // variance of their mean
+            const VecT variance = hn::Max(
+                hn::NegMulAdd(
+                    mean, mean,
+                    hn::Div(
+                        load<Mode>(sums_of_squares.data() + i, count),
+                        num_paths)),
+                hn::Zero(d));
+            const VecT error = hn::Sqrt(hn::Div(
+                variance,
+                hn::Sub(num_paths, hn::Set(d, static_cast<T>(1.0)))));
+            store<Mode>(
+                hn::Mul(e_rt, error), standard_errors.data() + i, count);
+        }
+    }
+
+    template <Access Mode>
+    [[nodiscard]] static inline VecT load(const T* from, size_t count)
+    {
+        return Pricer::template load<Mode>(from, count);
+    }
+
+    template <Access Mode>
+    static inline void store(const VecT& v, T* to, size_t count)
+    {
+        Pricer::template store<Mode>(v, to, count);
+    }
+};
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+
+#if HWY_TARGET == HWY_STATIC_TARGET
+using HWY_NAMESPACE::FastMonteCarlo;
+#endif
+
+}  // namespace fast_option_pricer
+HWY_AFTER_NAMESPACE();
+
+#endif  // FAST_OPTION_PRICER_FAST_MONTE_CARLO_H_
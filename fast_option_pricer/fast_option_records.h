@@ -0,0 +1,157 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+// Per-target include guard, see hwy/highway.h and math-inl.h
+#if defined(FAST_OPTION_PRICER_FAST_OPTION_RECORDS_H_) == \
+    defined(HWY_TARGET_TOGGLE)
+#ifdef FAST_OPTION_PRICER_FAST_OPTION_RECORDS_H_
+#undef FAST_OPTION_PRICER_FAST_OPTION_RECORDS_H_
+#else
+#define FAST_OPTION_PRICER_FAST_OPTION_RECORDS_H_
+#endif
+
+#include <hwy/highway.h>
+#include <cassert>
+#include <span>
+#include "aligned_option_pricing.h"
+#include "common.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace fast_option_pricer {
+namespace HWY_NAMESPACE {
+
+namespace hn = hwy::HWY_NAMESPACE;
+
+// Converts between a struct based feed and the pricers' columns with vector
+// shuffles instead of a scalar scatter/gather pass.
+//
+// A vector of OptionRecords is 8 * lanes values. LoadInterleaved4 over the
+// first half gives vectors holding fields f and f + 4 of lanes / 2 records,
+// alternating; ConcatEven/ConcatOdd with the same vector of the second half
+// split them into whole columns. Results go the other way:
+// InterleaveWholeLower/InterleaveWholeUpper pair fields f and f + 3, and
+// StoreInterleaved3 writes lanes / 2 OptionResults per call. The per-block
+// InterleaveLower/Upper would mix up options on vectors wider than 128 bits.
+template <IsFloatOrDouble T = double, typename D = hn::ScalableTag<T>>
+class FastOptionRecords
+{
+    static_assert(sizeof(OptionRecord<T>) == 8 * sizeof(T));
+    static_assert(sizeof(OptionResult<T>) == 6 * sizeof(T));
+
+   public:
+    using VecT = hn::Vec<D>;
+
+    // Resizes 'op' to records.size() and fills its input columns
+    static void ingest(
+        std::span<const OptionRecord<T>> records, AlignedOptionPricing<T>& op)
+    {
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+        op.resize(records.size());
+        const T* from = reinterpret_cast<const T*>(records.data());
+
+        size_t i = 0;
+        if constexpr (HWY_TARGET != HWY_SCALAR) {
+            for (; i + lanes <= records.size(); i += lanes) {
+                VecT lo0, lo1, lo2, lo3, hi0, hi1, hi2, hi3;
+                hn::LoadInterleaved4(d, from + 8 * i, lo0, lo1, lo2, lo3);
+                hn::LoadInterleaved4(
+                    d, from + 8 * i + 4 * lanes, hi0, hi1, hi2, hi3);
+                // Columns are aligned and i is a multiple of lanes
+                hn::Store(
+                    hn::ConcatEven(d, hi0, lo0), d,
+                    op.underlyings().data() + i);
+                hn::Store(
+                    hn::ConcatEven(d, hi1, lo1), d, op.strikes().data() + i);
+                hn::Store(
+                    hn::ConcatEven(d, hi2, lo2), d,
+                    op.risk_free_rates().data() + i);
+                hn::Store(
+                    hn::ConcatEven(d, hi3, lo3), d,
+                    op.volatilities().data() + i);
+                hn::Store(
+                    hn::ConcatOdd(d, hi0, lo0), d,
+                    op.times_to_expiry().data() + i);
+                hn::Store(
+                    hn::ConcatOdd(d, hi1, lo1), d,
+                    op.dividend_yields().data() + i);
+                hn::Store(
+                    hn::ConcatOdd(d, hi2, lo2), d,
+                    op.option_types().data() + i);
+            }
+        }
+        // Remainder of a batch that is not a multiple of lanes
+        for (; i < records.size(); ++i) {
+            const OptionRecord<T>& r = records[i];
+            op.underlyings()[i] = r.underlying;
+            op.strikes()[i] = r.strike;
+            op.risk_free_rates()[i] = r.risk_free_rate;
+            op.volatilities()[i] = r.volatility;
+            op.times_to_expiry()[i] = r.time_to_expiry;
+            op.dividend_yields()[i] = r.dividend_yield;
+            op.option_types()[i] = r.option_type;
+        }
+    }
+
+    static void write_results(
+        OptionPricing<T>& op, std::span<OptionResult<T>> results)
+    {
+        write_results(op.view(), results);
+    }
+
+    static void write_results(
+        AlignedOptionPricing<T>& op, std::span<OptionResult<T>> results)
+    {
+        write_results(op.view(), results);
+    }
+
+    // Writes every output of the first op.num_options options to 'results'
+    static void write_results(
+        const OptionPricingView<T>& op, std::span<OptionResult<T>> results)
+    {
+        assert(op.has_outputs(kAllOutputs));
+        assert(op.num_options <= results.size());
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+        T* to = reinterpret_cast<T*>(results.data());
+
+        size_t i = 0;
+        if constexpr (HWY_TARGET != HWY_SCALAR) {
+            for (; i + lanes <= op.num_options; i += lanes) {
+                const VecT price = hn::LoadU(d, op.prices.data() + i);
+                const VecT delta = hn::LoadU(d, op.deltas.data() + i);
+                const VecT vega = hn::LoadU(d, op.vegas.data() + i);
+                const VecT theta = hn::LoadU(d, op.thetas.data() + i);
+                const VecT gamma = hn::LoadU(d, op.gammas.data() + i);
+                const VecT rho = hn::LoadU(d, op.rhos.data() + i);
+                hn::StoreInterleaved3(
+                    hn::InterleaveWholeLower(d, price, theta),
+                    hn::InterleaveWholeLower(d, delta, gamma),
+                    hn::InterleaveWholeLower(d, vega, rho), d, to + 6 * i);
+                hn::StoreInterleaved3(
+                    hn::InterleaveWholeUpper(d, price, theta),
+                    hn::InterleaveWholeUpper(d, delta, gamma),
+                    hn::InterleaveWholeUpper(d, vega, rho), d,
+                    to + 6 * i + 3 * lanes);
+            }
+        }
+        // Remainder of a batch that is not a multiple of lanes
+        for (; i < op.num_options; ++i) {
+            results[i] = {op.prices[i], op.deltas[i], op.vegas[i],
+                          op.thetas[i], op.gammas[i], op.rhos[i]};
+        }
+    }
+};
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+
+#if HWY_TARGET == HWY_STATIC_TARGET
+using HWY_NAMESPACE::FastOptionRecords;
+#endif
+
+}  // namespace fast_option_pricer
+HWY_AFTER_NAMESPACE();
+
+#endif  // FAST_OPTION_PRICER_FAST_OPTION_RECORDS_H_
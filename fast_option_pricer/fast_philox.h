@@ -0,0 +1,149 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+// Per-target include guard, see hwy/highway.h and math-inl.h
+#if defined(FAST_OPTION_PRICER_FAST_PHILOX_H_) == defined(HWY_TARGET_TOGGLE)
+#ifdef FAST_OPTION_PRICER_FAST_PHILOX_H_
+#undef FAST_OPTION_PRICER_FAST_PHILOX_H_
+#else
+#define FAST_OPTION_PRICER_FAST_PHILOX_H_
+#endif
+
+#include <hwy/highway.h>
+#include <cstdint>
+#include "common.h"
+#include "fast_math_helper.h"
+#include "math-inl.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace fast_option_pricer {
+namespace HWY_NAMESPACE {
+
+namespace hn = hwy::HWY_NAMESPACE;
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+// 3"), a counter-based generator: the output is a bijection of a 128-bit
+// counter under a 64-bit key, with no state carried between draws. Every
+// lane hashes a counter of its own, so draws are reproducible from their
+// counters alone, whichever vector width, thread or order produced them.
+//
+// normals turns one block of four 32-bit words per lane into two standard
+// normals with the Box-Muller transform, from uniforms of 53 bits in double
+// and 24 bits in float.
+template <
+    IsFloatOrDouble T = double, typename D = hn::ScalableTag<T>,
+    Accuracy A = Accuracy::kExact>
+class FastPhilox
+{
+   public:
+    using VecT = hn::Vec<D>;
+    using DU = hn::Rebind<uint32_t, D>;
+    using VecU = hn::Vec<DU>;
+
+    // Replaces the counters (c0, c1, c2, c3) of every lane by their
+    // Philox4x32-10 hash under key (k0, k1)
+    static inline void hash(
+        VecU& c0, VecU& c1, VecU& c2, VecU& c3, uint32_t k0, uint32_t k1)
+    {
+        constexpr DU du;
+        const VecU multiplier0 = hn::Set(du, kMultiplier0);
+        const VecU multiplier1 = hn::Set(du, kMultiplier1);
+        for (size_t round = 0; round < kRounds; ++round) {
+            const VecU high0 = hn::MulHigh(multiplier0, c0);
+            const VecU low0 = hn::Mul(multiplier0, c0);
+            const VecU high1 = hn::MulHigh(multiplier1, c2);
+            const VecU low1 = hn::Mul(multiplier1, c2);
+            c0 = hn::Xor(hn::Xor(high1, c1), hn::Set(du, k0));
+            c1 = low1;
+            c2 = hn::Xor(hn::Xor(high0, c3), hn::Set(du, k1));
+            c3 = low0;
+            k0 += kWeyl0;
+            k1 += kWeyl1;
+        }
+    }
+
+    // Two independent standard normals per lane from the counters
+    // (c0, c1, c2, 0) under 'seed'
+    static inline void normals(
+        uint64_t seed, const VecU& c0, uint32_t c1, uint32_t c2, VecT& z0,
+        VecT& z1)
+    {
+        constexpr D d;
+        constexpr DU du;
+        VecU w0 = c0;
+        VecU w1 = hn::Set(du, c1);
+        VecU w2 = hn::Set(du, c2);
+        VecU w3 = hn::Zero(du);
+        hash(
+            w0, w1, w2, w3, static_cast<uint32_t>(seed),
+            static_cast<uint32_t>(seed >> 32));
+
+        // Uniforms on (0, 1), never 0 for the log
+        VecT u0, u1;
+        if constexpr (sizeof(T) == 8) {
+            u0 = uniform(w0, w1);
+            u1 = uniform(w2, w3);
+        } else {
+            u0 = uniform(w0);
+            u1 = uniform(w1);
+        }
+
+        // r * (cos, sin) of 2 pi u1, r = sqrt(-2 log u0)
+        const VecT radius = hn::Sqrt(hn::Mul(
+            hn::Set(d, static_cast<T>(-2.0)),
+            FastMathHelper::log<VecT, T, D, d, A>(u0)));
+        VecT sine, cosine;
+        hn::SinCos(
+            d, hn::Mul(hn::Set(d, static_cast<T>(6.283185307179586)), u1),
+            sine, cosine);
+        z0 = hn::Mul(radius, cosine);
+        z1 = hn::Mul(radius, sine);
+    }
+
+   private:
+    static constexpr size_t kRounds = 10;
+    static constexpr uint32_t kMultiplier0 = 0xD2511F53u;
+    static constexpr uint32_t kMultiplier1 = 0xCD9E8D57u;
+    // Key schedule, the golden ratio and sqrt(3) - 1 in 0.32 fixed point
+    static constexpr uint32_t kWeyl0 = 0x9E3779B9u;
+    static constexpr uint32_t kWeyl1 = 0xBB67AE85u;
+
+    // (k + 0.5) / 2^53 from the top 53 bits k of high:low
+    static inline VecT uniform(const VecU& high, const VecU& low)
+    {
+        constexpr D d;
+        constexpr hn::Rebind<uint64_t, D> du64;
+        constexpr hn::Rebind<int64_t, D> di64;
+        const auto bits = hn::ShiftRight<11>(hn::Or(
+            hn::ShiftLeft<32>(hn::PromoteTo(du64, high)),
+            hn::PromoteTo(du64, low)));
+        return hn::MulAdd(
+            hn::ConvertTo(d, hn::BitCast(di64, bits)),
+            hn::Set(d, static_cast<T>(0x1.0p-53)),
+            hn::Set(d, static_cast<T>(0x1.0p-54)));
+    }
+
+    // (k + 0.5) / 2^24 from the top 24 bits k of 'word'
+    static inline VecT uniform(const VecU& word)
+    {
+        constexpr D d;
+        constexpr hn::Rebind<int32_t, D> di32;
+        return hn::MulAdd(
+            hn::ConvertTo(d, hn::BitCast(di32, hn::ShiftRight<8>(word))),
+            hn::Set(d, static_cast<T>(0x1.0p-24)),
+            hn::Set(d, static_cast<T>(0x1.0p-25)));
+    }
+};
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+
+#if HWY_TARGET == HWY_STATIC_TARGET
+using HWY_NAMESPACE::FastPhilox;
+#endif
+
+}  // namespace fast_option_pricer
+HWY_AFTER_NAMESPACE();
+
+#endif  // FAST_OPTION_PRICER_FAST_PHILOX_H_
@@ -0,0 +1,88 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+// Per-target include guard, see hwy/highway.h and math-inl.h
+#if defined(FAST_OPTION_PRICER_FAST_PORTFOLIO_H_) == \
+    defined(HWY_TARGET_TOGGLE)
+#ifdef FAST_OPTION_PRICER_FAST_PORTFOLIO_H_
+#undef FAST_OPTION_PRICER_FAST_PORTFOLIO_H_
+#else
+#define FAST_OPTION_PRICER_FAST_PORTFOLIO_H_
+#endif
+
+#include <hwy/highway.h>
+#include <cassert>
+#include <span>
+#include "common.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace fast_option_pricer {
+namespace HWY_NAMESPACE {
+
+namespace hn = hwy::HWY_NAMESPACE;
+
+// Reductions over priced columns, e.g. the greeks of a book
+template <IsFloatOrDouble T = double, typename D = hn::ScalableTag<T>>
+class FastPortfolio
+{
+   public:
+    using VecT = hn::Vec<D>;
+
+    // Sums every output of 'op' weighted by the position held in each option
+    [[nodiscard]] static OptionResult<T> aggregate(
+        const OptionPricingView<T>& op, std::span<const T> positions)
+    {
+        assert(op.has_outputs(kAllOutputs));
+        assert(op.num_options <= positions.size());
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+
+        VecT price = hn::Zero(d);
+        VecT delta = hn::Zero(d);
+        VecT vega = hn::Zero(d);
+        VecT theta = hn::Zero(d);
+        VecT gamma = hn::Zero(d);
+        VecT rho = hn::Zero(d);
+        const auto accumulate = [&](const VecT& position, size_t i,
+                                    const auto& load) {
+            price = hn::MulAdd(position, load(op.prices.data() + i), price);
+            delta = hn::MulAdd(position, load(op.deltas.data() + i), delta);
+            vega = hn::MulAdd(position, load(op.vegas.data() + i), vega);
+            theta = hn::MulAdd(position, load(op.thetas.data() + i), theta);
+            gamma = hn::MulAdd(position, load(op.gammas.data() + i), gamma);
+            rho = hn::MulAdd(position, load(op.rhos.data() + i), rho);
+        };
+
+        size_t i = 0;
+        for (; i + lanes <= op.num_options; i += lanes) {
+            accumulate(
+                hn::LoadU(d, positions.data() + i), i,
+                [&](const T* from) { return hn::LoadU(d, from); });
+        }
+        // Remainder of a batch that is not a multiple of lanes. LoadN zeroes
+        // the lanes past the end, so they add nothing.
+        if (i < op.num_options) {
+            const size_t count = op.num_options - i;
+            accumulate(
+                hn::LoadN(d, positions.data() + i, count), i,
+                [&](const T* from) { return hn::LoadN(d, from, count); });
+        }
+
+        return {hn::ReduceSum(d, price), hn::ReduceSum(d, delta),
+                hn::ReduceSum(d, vega),  hn::ReduceSum(d, theta),
+                hn::ReduceSum(d, gamma), hn::ReduceSum(d, rho)};
+    }
+};
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+
+#if HWY_TARGET == HWY_STATIC_TARGET
+using HWY_NAMESPACE::FastPortfolio;
+#endif
+
+}  // namespace fast_option_pricer
+HWY_AFTER_NAMESPACE();
+
+#endif  // FAST_OPTION_PRICER_FAST_PORTFOLIO_H_
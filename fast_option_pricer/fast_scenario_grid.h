@@ -0,0 +1,261 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+// Per-target include guard, see hwy/highway.h and math-inl.h
+#if defined(FAST_OPTION_PRICER_FAST_SCENARIO_GRID_H_) == \
+    defined(HWY_TARGET_TOGGLE)
+#ifdef FAST_OPTION_PRICER_FAST_SCENARIO_GRID_H_
+#undef FAST_OPTION_PRICER_FAST_SCENARIO_GRID_H_
+#else
+#define FAST_OPTION_PRICER_FAST_SCENARIO_GRID_H_
+#endif
+
+#include <hwy/aligned_allocator.h>
+#include <hwy/highway.h>
+#include <cassert>
+#include <cmath>
+#include <span>
+#include <vector>
+#include "common.h"
+#include "fast_black_scholes.h"
+#include "fast_math_helper.h"
+#include "math-inl.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace fast_option_pricer {
+namespace HWY_NAMESPACE {
+
+namespace hn = hwy::HWY_NAMESPACE;
+
+// Revalues a book of calls and puts (see FastBlackScholes::price_mixed) in
+// every scenario of a ScenarioGridView. Each vector of options is loaded
+// once and runs all scenarios while its inputs stay in registers. sqrt(T),
+// e^(-qT), e^(-rT), K * e^(-rT), log(S / K) + (r - q)T and the base price are
+// computed once per option; a spot shock only adds log(1 + shock) to
+// log(S / K) and a vol shock only changes sigma * sqrt(T), so a scenario
+// costs d1/d2 and the two CDFs.
+//
+// P&L is the scenario price less the price at the unshocked inputs, which
+// is the one FastBlackScholes::price_mixed computes.
+template <
+    IsFloatOrDouble T = double, typename D = hn::ScalableTag<T>,
+    Accuracy A = Accuracy::kExact>
+class FastScenarioGrid
+{
+   public:
+    using VecT = hn::Vec<D>;
+    using Pricer = FastBlackScholes<T, D, A>;
+    using Access = typename Pricer::Access;
+
+    static void revalue(
+        const OptionPricingView<T>& op, const ScenarioGridView<T>& grid,
+        std::span<T> pnl)
+    {
+        revalue(op, grid, pnl, op.num_options);
+    }
+
+    // Writes the P&L of option i in scenario s to pnl[s * stride + i], i.e.
+    // one column per scenario. A stride larger than op.num_options lets
+    // chunks of a batch write into the cube of the whole batch.
+    static void revalue(
+        const OptionPricingView<T>& op, const ScenarioGridView<T>& grid,
+        std::span<T> pnl, size_t stride)
+    {
+        assert(stride >= op.num_options);
+        assert(
+            grid.num_scenarios() == 0 ||
+            (grid.num_scenarios() - 1) * stride + op.num_options <=
+                pnl.size());
+        const std::vector<T> log_moves = spot_log_moves(grid);
+        for_each_vector(op, [&]<Access Mode>(size_t i, size_t count) {
+            revalue_vector<Mode>(
+                op, grid, log_moves, i, count,
+                [&](size_t s, const VecT& v) {
+                    Pricer::template store<Mode>(
+                        v, pnl.data() + s * stride + i, count);
+                });
+        });
+    }
+
+    // Sets totals[s] to the P&L of the book in scenario s, with every
+    // option's P&L weighted by the position held in it
+    static void aggregate(
+        const OptionPricingView<T>& op, const ScenarioGridView<T>& grid,
+        std::span<const T> positions, std::span<T> totals)
+    {
+        assert(op.num_options <= positions.size());
+        assert(grid.num_scenarios() <= totals.size());
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+        const std::vector<T> log_moves = spot_log_moves(grid);
+
+        // One vector of partial sums per scenario
+        const auto sums =
+            hwy::AllocateAligned<T>(grid.num_scenarios() * lanes);
+        for (size_t s = 0; s < grid.num_scenarios(); ++s) {
+            hn::Store(hn::Zero(d), d, sums.get() + s * lanes);
+        }
+        for_each_vector(op, [&]<Access Mode>(size_t i, size_t count) {
+            const VecT position = load<Mode>(positions.data() + i, count);
+            revalue_vector<Mode>(
+                op, grid, log_moves, i, count,
+                [&](size_t s, const VecT& v) {
+                    // Lanes past the end of a partial vector priced zeroed
+                    // inputs, i.e. NaN, which a zero position does not mask
+                    const VecT masked =
+                        Mode == Access::kPartial
+                            ? hn::IfThenElseZero(hn::FirstN(d, count), v)
+                            : v;
+                    T* sum = sums.get() + s * lanes;
+                    hn::Store(
+                        hn::MulAdd(position, masked, hn::Load(d, sum)), d,
+                        sum);
+                });
+        });
+        for (size_t s = 0; s < grid.num_scenarios(); ++s) {
+            totals[s] = hn::ReduceSum(d, hn::Load(d, sums.get() + s * lanes));
+        }
+    }
+
+   private:
+    // log(1 + shock) of every spot shock
+    [[nodiscard]] static std::vector<T> spot_log_moves(
+        const ScenarioGridView<T>& grid)
+    {
+        std::vector<T> log_moves(grid.spot_shocks.size(), 0);
+        for (size_t j = 0; j < grid.spot_shocks.size(); ++j) {
+            log_moves[j] = std::log1p(grid.spot_shocks[j]);
+        }
+        return log_moves;
+    }
+
+    // Calls f.template operator()<Mode>(i, count) for every vector of 'op'.
+    // Positions and P&L columns are the caller's, so no aligned vectors.
+    template <typename F>
+    static void for_each_vector(const OptionPricingView<T>& op, const F& f)
+    {
+        assert(op.num_options == op.option_types.size());
+        assert(op.has_input_columns());
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+
+        size_t i = 0;
+        for (; i + lanes <= op.num_options; i += lanes) {
+            f.template operator()<Access::kUnaligned>(i, lanes);
+        }
+        // Remainder of a batch that is not a multiple of lanes
+        if (i < op.num_options) {
+            f.template operator()<Access::kPartial>(i, op.num_options - i);
+        }
+    }
+
+    // Passes the P&L of options [i, i + count) in every scenario to
+    // sink(s, pnl)
+    template <Access Mode, typename Sink>
+    static inline void revalue_vector(
+        const OptionPricingView<T>& op, const ScenarioGridView<T>& grid,
+        const std::vector<T>& log_moves, size_t i, size_t count,
+        const Sink& sink)
+    {
+        constexpr D d;
+        const VecT underlying = load<Mode>(op.underlyings.data() + i, count);
+        const VecT strike = load<Mode>(op.strikes.data() + i, count);
+        const VecT risk_free_rate =
+            load<Mode>(op.risk_free_rates.data() + i, count);
+        const VecT volatility = load<Mode>(op.volatilities.data() + i, count);
+        const VecT time_to_expiry =
+            load<Mode>(op.times_to_expiry.data() + i, count);
+        const VecT dividend_yield =
+            load<Mode>(op.dividend_yields.data() + i, count);
+        const auto is_call = hn::Gt(
+            load<Mode>(op.option_types.data() + i, count), hn::Zero(d));
+
+        const VecT root_t = hn::Sqrt(time_to_expiry);
+        const VecT minus_one = hn::Set(d, static_cast<T>(-1.0));
+        const VecT e_qt = FastMathHelper::exp<VecT, T, D, d, A>(
+            hn::Mul(minus_one, hn::Mul(time_to_expiry, dividend_yield)));
+        const VecT strike_e_rt = hn::Mul(
+            strike,
+            FastMathHelper::exp<VecT, T, D, d, A>(
+                hn::Mul(minus_one, hn::Mul(time_to_expiry, risk_free_rate))));
+        // log(S / K) + (r - q)T, the numerator of d1 less its variance term
+        const VecT log_forward = hn::MulAdd(
+            hn::Sub(risk_free_rate, dividend_yield), time_to_expiry,
+            FastMathHelper::log<VecT, T, D, d, A>(
+                hn::Div(underlying, strike)));
+        const VecT base = price(
+            is_call, hn::Mul(underlying, e_qt), strike_e_rt, log_forward,
+            hn::Mul(volatility, root_t));
+
+        const VecT min_volatility =
+            hn::Set(d, ScenarioGridView<T>::kMinVolatility);
+        for (size_t k = 0; k < grid.vol_shocks.size(); ++k) {
+            const VecT shocked_volatility = hn::Max(
+                hn::Add(volatility, hn::Set(d, grid.vol_shocks[k])),
+                min_volatility);
+            const VecT sigma_root_t = hn::Mul(shocked_volatility, root_t);
+            for (size_t j = 0; j < grid.spot_shocks.size(); ++j) {
+                const VecT underlying_e_qt = hn::Mul(
+                    hn::Mul(
+                        underlying,
+                        hn::Set(
+                            d,
+                            static_cast<T>(1.0) + grid.spot_shocks[j])),
+                    e_qt);
+                sink(
+                    grid.scenario(j, k),
+                    hn::Sub(
+                        price(
+                            is_call, underlying_e_qt, strike_e_rt,
+                            hn::Add(log_forward, hn::Set(d, log_moves[j])),
+                            sigma_root_t),
+                        base));
+            }
+        }
+    }
+
+    // Price of a call or put per lane, see FastBlackScholes::store_outputs
+    template <typename M>
+    [[nodiscard]] static inline VecT price(
+        const M& is_call, const VecT& underlying_e_qt,
+        const VecT& strike_e_rt, const VecT& log_forward,
+        const VecT& sigma_root_t)
+    {
+        constexpr D d;
+        const VecT d1 = hn::Add(
+            hn::Div(log_forward, sigma_root_t),
+            hn::Mul(hn::Set(d, static_cast<T>(0.5)), sigma_root_t));
+        const VecT d2 = Pricer::calc_d2(d1, sigma_root_t);
+        const VecT n_d1 = FastMathHelper::normal_cdf<VecT, T, D, d, A>(d1);
+        const VecT n_d2 = FastMathHelper::normal_cdf<VecT, T, D, d, A>(d2);
+        return hn::IfThenElse(
+            is_call,
+            hn::Sub(
+                hn::Mul(underlying_e_qt, n_d1), hn::Mul(strike_e_rt, n_d2)),
+            hn::Sub(
+                hn::Mul(
+                    strike_e_rt, Pricer::template calc_n_minus<d>(n_d2)),
+                hn::Mul(
+                    underlying_e_qt,
+                    Pricer::template calc_n_minus<d>(n_d1))));
+    }
+
+    template <Access Mode>
+    [[nodiscard]] static inline VecT load(const T* from, size_t count)
+    {
+        return Pricer::template load<Mode>(from, count);
+    }
+};
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+
+#if HWY_TARGET == HWY_STATIC_TARGET
+using HWY_NAMESPACE::FastScenarioGrid;
+#endif
+
+}  // namespace fast_option_pricer
+HWY_AFTER_NAMESPACE();
+
+#endif  // FAST_OPTION_PRICER_FAST_SCENARIO_GRID_H_
@@ -0,0 +1,301 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+// Per-target include guard, see hwy/highway.h and math-inl.h
+#if defined(FAST_OPTION_PRICER_FAST_SPOT_TICK_H_) == \
+    defined(HWY_TARGET_TOGGLE)
+#ifdef FAST_OPTION_PRICER_FAST_SPOT_TICK_H_
+#undef FAST_OPTION_PRICER_FAST_SPOT_TICK_H_
+#else
+#define FAST_OPTION_PRICER_FAST_SPOT_TICK_H_
+#endif
+
+#include <hwy/highway.h>
+#include <cassert>
+#include "aligned_option_pricing.h"
+#include "common.h"
+#include "fast_black_scholes.h"
+#include "fast_math_helper.h"
+#include "math-inl.h"
+#include "spot_cache.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace fast_option_pricer {
+namespace HWY_NAMESPACE {
+
+namespace hn = hwy::HWY_NAMESPACE;
+
+// Reprices a chain when only its underlyings move. cache_inputs evaluates
+// what FastBlackScholes computes from strikes, rates, dividend yields,
+// volatilities and times to expiry: sigma * sqrt(T), (r - q) * T, 1 / K,
+// e^(-qT), and the discounted strike terms of the price, theta and rho (see
+// FastBlackScholes::store_outputs). Each tick then loads the underlyings and
+// the cache only, and costs one log(S / K), d1/d2, the CDFs and the output
+// math per option.
+// log(S) - log(K) would save the log of the strike too, but cancels to a few
+// float ulp of log(S) when S is close to K, which d1 amplifies by
+// 1 / (sigma * sqrt(T)). S * (1 / K) keeps FastBlackScholes' accuracy and
+// agrees with it to rounding.
+template <
+    IsFloatOrDouble T = double, typename D = hn::ScalableTag<T>,
+    Accuracy A = Accuracy::kExact>
+class FastSpotTick
+{
+   public:
+    using VecT = hn::Vec<D>;
+    using Pricer = FastBlackScholes<T, D, A>;
+    using Access = typename Pricer::Access;
+    using Legs = typename Pricer::Legs;
+
+    static void cache_inputs(AlignedOptionPricing<T>& op, SpotCache<T>& cache)
+    {
+        cache_inputs(op.view(), cache);
+    }
+
+    // Resizes 'cache' to op.num_options and fills it from the inputs of
+    // 'op'. Must run again whenever an input other than the underlying
+    // changes.
+    static void cache_inputs(
+        const OptionPricingView<T>& op, SpotCache<T>& cache)
+    {
+        assert(op.has_input_columns());
+        cache.resize(op.num_options);
+        for_each_vector(op, cache, [&]<Access Mode>(size_t i, size_t count) {
+            cache_vector<Mode>(op, cache, i, count);
+        });
+    }
+
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    static void price(AlignedOptionPricing<T>& op, SpotCache<T>& cache)
+    {
+        price<Call, Outputs>(op.view(), cache);
+    }
+
+    // Prices 'op' at its current underlyings, with everything else taken
+    // from 'cache', see FastBlackScholes::price
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    static void price(const OptionPricingView<T>& op, SpotCache<T>& cache)
+    {
+        constexpr Legs L = Call ? Legs::kCall : Legs::kPut;
+        price_legs<L, Outputs>(op, cache);
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_mixed(AlignedOptionPricing<T>& op, SpotCache<T>& cache)
+    {
+        price_mixed<Outputs>(op.view(), cache);
+    }
+
+    // See FastBlackScholes::price_mixed
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_mixed(
+        const OptionPricingView<T>& op, SpotCache<T>& cache)
+    {
+        assert(op.num_options == op.option_types.size());
+        price_legs<Legs::kMixed, Outputs>(op, cache);
+    }
+
+   private:
+    template <Legs L, uint32_t Outputs>
+    static void price_legs(const OptionPricingView<T>& op, SpotCache<T>& cache)
+    {
+        assert(op.has_outputs(Outputs));
+        assert(op.num_options == cache.num_options());
+        const PutPricingView<T> put(op);
+        for_each_vector(op, cache, [&]<Access Mode>(size_t i, size_t count) {
+            tick_vector<L, Outputs, Mode>(op, put, cache, i, count);
+        });
+    }
+
+    // Calls f.template operator()<Mode>(i, count) for every vector of 'op',
+    // with aligned full vectors where the columns of 'op' allow them, see
+    // FastBlackScholes::price_legs. The columns of 'cache' always do.
+    template <typename F>
+    static void for_each_vector(
+        const OptionPricingView<T>& op, const SpotCache<T>& cache, const F& f)
+    {
+        constexpr D d;
+        const size_t lanes = hn::Lanes(d);
+
+        const size_t padded = hwy::RoundUpTo(op.num_options, lanes);
+        if (op.aligned_to(lanes * sizeof(T)) &&
+            op.padded_num_options >= padded &&
+            cache.padded_num_options() >= padded) {
+            for (size_t i = 0; i < op.num_options; i += lanes) {
+                f.template operator()<Access::kAligned>(i, lanes);
+            }
+            return;
+        }
+
+        size_t i = 0;
+        for (; i + lanes <= op.num_options; i += lanes) {
+            f.template operator()<Access::kUnaligned>(i, lanes);
+        }
+        // Remainder of a batch that is not a multiple of lanes
+        if (i < op.num_options) {
+            f.template operator()<Access::kPartial>(i, op.num_options - i);
+        }
+    }
+
+    template <Access Mode>
+    static inline void cache_vector(
+        const OptionPricingView<T>& op, SpotCache<T>& cache, size_t i,
+        size_t count)
+    {
+        constexpr D d;
+        const VecT strike = load<Mode>(op.strikes.data() + i, count);
+        const VecT risk_free_rate =
+            load<Mode>(op.risk_free_rates.data() + i, count);
+        const VecT volatility = load<Mode>(op.volatilities.data() + i, count);
+        const VecT time_to_expiry =
+            load<Mode>(op.times_to_expiry.data() + i, count);
+        const VecT dividend_yield =
+            load<Mode>(op.dividend_yields.data() + i, count);
+
+        const VecT root_t = hn::Sqrt(time_to_expiry);
+        const VecT sigma_root_t = hn::Mul(volatility, root_t);
+        const VecT minus_one = hn::Set(d, static_cast<T>(-1.0));
+        const VecT e_qt = FastMathHelper::exp<VecT, T, D, d, A>(
+            hn::Mul(minus_one, hn::Mul(time_to_expiry, dividend_yield)));
+        const VecT discounted_strike = hn::Mul(
+            strike,
+            FastMathHelper::exp<VecT, T, D, d, A>(
+                hn::Mul(minus_one, hn::Mul(time_to_expiry, risk_free_rate))));
+        store<Mode>(
+            hn::Div(hn::Set(d, static_cast<T>(1.0)), strike),
+            cache.inverse_strikes().data() + i, count);
+        store<Mode>(
+            hn::Mul(hn::Sub(risk_free_rate, dividend_yield), time_to_expiry),
+            cache.drifts().data() + i, count);
+        store<Mode>(sigma_root_t, cache.sigma_root_ts().data() + i, count);
+        store<Mode>(root_t, cache.root_ts().data() + i, count);
+        store<Mode>(
+            hn::Div(sigma_root_t, time_to_expiry),
+            cache.decay_rates().data() + i, count);
+        store<Mode>(e_qt, cache.e_qts().data() + i, count);
+        store<Mode>(
+            hn::Mul(dividend_yield, e_qt), cache.dividend_e_qts().data() + i,
+            count);
+        store<Mode>(
+            discounted_strike, cache.discounted_strikes().data() + i, count);
+        store<Mode>(
+            hn::Mul(risk_free_rate, discounted_strike),
+            cache.rate_discounted_strikes().data() + i, count);
+        store<Mode>(
+            hn::Mul(time_to_expiry, discounted_strike),
+            cache.time_discounted_strikes().data() + i, count);
+    }
+
+    // FastBlackScholes::price_vector with the cached intermediates
+    template <Legs L, uint32_t Outputs, Access Mode>
+    static inline void tick_vector(
+        const OptionPricingView<T>& op, const PutPricingView<T>& put,
+        SpotCache<T>& cache, size_t i, size_t count)
+    {
+        constexpr D d;
+        constexpr bool kNeedsN_d1 = Outputs & (kPrice | kDelta | kTheta);
+        constexpr bool kNeedsN_d2 = Outputs & (kPrice | kTheta | kRho);
+        constexpr bool kNeedsPdf_d1 = Outputs & (kVega | kTheta | kGamma);
+
+        constexpr bool kNeedsE_rt = Outputs & (kPrice | kTheta | kRho);
+
+        const VecT underlying = load<Mode>(op.underlyings.data() + i, count);
+        const VecT sigma_root_t =
+            load<Mode>(cache.sigma_root_ts().data() + i, count);
+        const VecT e_qt = load<Mode>(cache.e_qts().data() + i, count);
+        // Only the outputs that need them load these
+        const VecT dividend_e_qt =
+            (Outputs & kTheta)
+                ? load<Mode>(cache.dividend_e_qts().data() + i, count)
+                : hn::Zero(d);
+        const VecT discounted_strike =
+            kNeedsE_rt
+                ? load<Mode>(cache.discounted_strikes().data() + i, count)
+                : hn::Zero(d);
+        const VecT rate_discounted_strike =
+            (Outputs & kTheta)
+                ? load<Mode>(
+                      cache.rate_discounted_strikes().data() + i, count)
+                : hn::Zero(d);
+        const VecT time_discounted_strike =
+            (Outputs & kRho)
+                ? load<Mode>(
+                      cache.time_discounted_strikes().data() + i, count)
+                : hn::Zero(d);
+
+        const VecT d1 = hn::Add(
+            hn::Div(
+                hn::Add(
+                    FastMathHelper::log<VecT, T, D, d, A>(hn::Mul(
+                        underlying,
+                        load<Mode>(cache.inverse_strikes().data() + i, count))),
+                    load<Mode>(cache.drifts().data() + i, count)),
+                sigma_root_t),
+            hn::Mul(hn::Set(d, static_cast<T>(0.5)), sigma_root_t));
+        const VecT d2 = Pricer::calc_d2(d1, sigma_root_t);
+        const VecT n_d1 = kNeedsN_d1
+                              ? FastMathHelper::normal_cdf<VecT, T, D, d, A>(d1)
+                              : hn::Zero(d);
+        const VecT n_d2 = kNeedsN_d2
+                              ? FastMathHelper::normal_cdf<VecT, T, D, d, A>(d2)
+                              : hn::Zero(d);
+        const VecT pdf_d1 =
+            kNeedsPdf_d1 ? FastMathHelper::normal_pdf<VecT, T, D, d, A>(d1)
+                         : hn::Zero(d);
+
+        // See FastBlackScholes::calc_theta_decay and calc_vega
+        const VecT underlying_e_qt = hn::Mul(underlying, e_qt);
+        const VecT theta_decay =
+            (Outputs & kTheta)
+                ? hn::Mul(
+                      hn::Set(d, static_cast<T>(-0.5)),
+                      hn::Mul(
+                          underlying_e_qt,
+                          hn::Mul(
+                              pdf_d1,
+                              load<Mode>(
+                                  cache.decay_rates().data() + i, count))))
+                : hn::Zero(d);
+        // Per 1% of volatility
+        const VecT vega =
+            (Outputs & kVega)
+                ? hn::Mul(
+                      hn::Set(d, static_cast<T>(0.01)),
+                      hn::Mul(
+                          underlying_e_qt,
+                          hn::Mul(
+                              load<Mode>(cache.root_ts().data() + i, count),
+                              pdf_d1)))
+                : hn::Zero(d);
+
+        Pricer::template store_outputs<L, Outputs, Mode>(
+            op, put, i, count, underlying, sigma_root_t, e_qt, dividend_e_qt,
+            discounted_strike, rate_discounted_strike, time_discounted_strike,
+            n_d1, n_d2, pdf_d1, theta_decay, vega);
+    }
+
+    template <Access Mode>
+    [[nodiscard]] static inline VecT load(const T* from, size_t count)
+    {
+        return Pricer::template load<Mode>(from, count);
+    }
+
+    template <Access Mode>
+    static inline void store(const VecT& v, T* to, size_t count)
+    {
+        Pricer::template store<Mode>(v, to, count);
+    }
+};
+
+// NOLINTNEXTLINE(google-readability-namespace-comments)
+}  // namespace HWY_NAMESPACE
+
+#if HWY_TARGET == HWY_STATIC_TARGET
+using HWY_NAMESPACE::FastSpotTick;
+#endif
+
+}  // namespace fast_option_pricer
+HWY_AFTER_NAMESPACE();
+
+#endif  // FAST_OPTION_PRICER_FAST_SPOT_TICK_H_
@@ -183,6 +183,36 @@ HWY_NOINLINE V CallCos(const D d, VecArg<V> x) {
   return Cos(d, x);
 }
 
+/**
+ * Highway SIMD version of std::erf(x).
+ *
+ * Valid Lane Types: float32, float64
+ *        Max Error: ULP = 3
+ *      Valid Range: float32[-FLT_MAX, +FLT_MAX], float64[-DBL_MAX, +DBL_MAX]
+ * @return error function of 'x'
+ */
+template <class D, class V>
+HWY_INLINE V Erf(D d, V x);
+template <class D, class V>
+HWY_NOINLINE V CallErf(const D d, VecArg<V> x) {
+  return Erf(d, x);
+}
+
+/**
+ * Highway SIMD version of std::erfc(x).
+ *
+ * Valid Lane Types: float32, float64
+ *        Max Error: ULP = 5
+ *      Valid Range: float32[-FLT_MAX, +FLT_MAX], float64[-DBL_MAX, +DBL_MAX]
+ * @return complementary error function of 'x'
+ */
+template <class D, class V>
+HWY_INLINE V Erfc(D d, V x);
+template <class D, class V>
+HWY_NOINLINE V CallErfc(const D d, VecArg<V> x) {
+  return Erfc(d, x);
+}
+
 /**
  * Highway SIMD version of std::exp(x).
  *
@@ -273,6 +303,25 @@ HWY_NOINLINE V CallLog2(const D d, VecArg<V> x) {
   return Log2(d, x);
 }
 
+/**
+ * Standard normal cumulative distribution function, 0.5 * erfc(-x / sqrt(2)).
+ *
+ * Unlike composing Erfc with a scaled argument, the rounding error of
+ * x / sqrt(2) is carried into the exp(-z^2) term, so the lower tail keeps
+ * full relative precision, with or without FMA. N(-inf) = 0, N(+inf) = 1.
+ *
+ * Valid Lane Types: float32, float64
+ *        Max Error: ULP = 6
+ *      Valid Range: float32[-FLT_MAX, +FLT_MAX], float64[-DBL_MAX, +DBL_MAX]
+ * @return probability that a standard normal variable is at most 'x'
+ */
+template <class D, class V>
+HWY_INLINE V NormalCdf(D d, V x);
+template <class D, class V>
+HWY_NOINLINE V CallNormalCdf(const D d, VecArg<V> x) {
+  return NormalCdf(d, x);
+}
+
 /**
  * Highway SIMD version of std::sin(x).
  *
@@ -535,6 +584,8 @@ struct AtanImpl {};
 template <class FloatOrDouble>
 struct CosSinImpl {};
 template <class FloatOrDouble>
+struct ErfImpl {};
+template <class FloatOrDouble>
 struct ExpImpl {};
 template <class FloatOrDouble>
 struct LogImpl {};
@@ -944,6 +995,143 @@ struct LogImpl<double> {
 
 #endif
 
+template <>
+struct ErfImpl<float> {
+  // erfc(x) is below the smallest subnormal for x beyond this.
+  static constexpr float kMaxArg = 10.0f;
+
+  // Keeps the top 12 significand bits so that Mul(hi, hi) is exact.
+  template <class D, class V>
+  HWY_INLINE V SplitHi(D d, V x) {
+    const RebindToUnsigned<D> du;
+    return BitCast(d, And(BitCast(du, x), Set(du, 0xFFFFF000u)));
+  }
+};
+
+#if HWY_HAVE_FLOAT64 && HWY_HAVE_INTEGER64
+template <>
+struct ErfImpl<double> {
+  // erfc(x) is below the smallest subnormal for x beyond this.
+  static constexpr double kMaxArg = 28.0;
+
+  // Keeps the top 26 significand bits so that Mul(hi, hi) is exact.
+  template <class D, class V>
+  HWY_INLINE V SplitHi(D d, V x) {
+    const RebindToUnsigned<D> du;
+    return BitCast(d, And(BitCast(du, x), Set(du, 0xFFFFFFFFF8000000ull)));
+  }
+};
+#endif
+
+// Rational approximations for erf/erfc from Boost.Math (53-bit variant).
+// Interval 0 ([0, 0.5)) approximates erf(a) = a * (Y + P(a^2) / Q(a^2)),
+// intervals 1..4 ([0.5, 1.5), [1.5, 2.5), [2.5, 4.5), [4.5, inf)) approximate
+// erfc(a) = exp(-a^2) / a * (Y + P(t) / Q(t)), with t = a - {0.5, 1.5, 3.5}
+// and t = 1 / a respectively. Shorter polynomials are padded with zeros so
+// that all lanes share one evaluation with per-lane coefficients.
+constexpr size_t kErfIntervals = 5;
+constexpr size_t kErfDegree = 6;
+constexpr double kErfY[kErfIntervals] = {
+    1.044948577880859375, 0.405935764312744140625, 0.50672817230224609375,
+    0.5405750274658203125, 0.5579090118408203125};
+constexpr double kErfP[kErfDegree + 1][kErfIntervals] = {
+    {0.0834305892146531832907, -0.098090592216281240205,
+     -0.0243500476207698441272, 0.00295276716530971662634,
+     0.00628057170626964891937},
+    {-0.338165134459360935041, 0.178114665841120341155,
+     0.0386540375035707201728, 0.0137384425896355332126,
+     0.0175389834052493308818},
+    {-0.0509990735146777432841, 0.191003695796775433986,
+     0.04394818964209516296, 0.00840807615555585383007,
+     -0.212652252872804219852},
+    {-0.00772758345802133288487, 0.0888900368967884466578,
+     0.0175679436311802092299, 0.00212825620914618649141,
+     -0.687717681153649930619},
+    {-0.000322780120964605683831, 0.0195049001251218801359,
+     0.00323962406290842133584, 0.000250269961544794627958,
+     -2.5518551727311523996},
+    {0.0, 0.00180424538297014223957, 0.000235839115596880717416,
+     0.113212406648847561139e-4, -3.22729451764143718517},
+    {0.0, 0.0, 0.0, 0.0, -2.8175401114513378771}};
+constexpr double kErfQ[kErfDegree + 1][kErfIntervals] = {
+    {1.0, 1.0, 1.0, 1.0, 1.0},
+    {0.455004033050794024546, 1.84759070983002217845, 1.53991494948552447182,
+     1.04217814166938418171, 2.79257750980575282228},
+    {0.0875222600142252549554, 1.42628004845511324508,
+     0.982403709157920235114, 0.442597659481563127003,
+     11.0567237927800161565},
+    {0.00858571925074406212772, 0.578052804889902404909,
+     0.325732924782444448493, 0.0958492726301061423444,
+     15.930646027911794143},
+    {0.000370900071787748000569, 0.12385097467900864233,
+     0.0563921837420478160373, 0.0105982906484876531489,
+     22.9367376522880577224},
+    {0.0, 0.0113385233577001411017, 0.00410369723978904575884,
+     0.000479411269521714493907, 13.5064170191802889145},
+    {0.0, 0.337511472483094676155e-5, 0.0, 0.0, 5.48409182238641741584}};
+
+// Picks c[i] in every lane that lies in interval i. The masks are nested
+// (m4 implies m3 implies ...), so later blends override earlier ones.
+template <class D, class M>
+HWY_INLINE Vec<D> ErfSelect(D d, M m1, M m2, M m3, M m4,
+                            const double (&c)[kErfIntervals]) {
+  using T = TFromD<D>;
+  Vec<D> v = IfThenElse(m1, Set(d, static_cast<T>(c[1])),
+                        Set(d, static_cast<T>(c[0])));
+  v = IfThenElse(m2, Set(d, static_cast<T>(c[2])), v);
+  v = IfThenElse(m3, Set(d, static_cast<T>(c[3])), v);
+  return IfThenElse(m4, Set(d, static_cast<T>(c[4])), v);
+}
+
+// Shared kernel for Erf, Erfc and NormalCdf. For a in [0, kMaxArg] with
+// a + a_lo the exact argument, returns erfc(a) and sets 'erf_small' to
+// erf(a) for lanes in interval 0 (flagged by 'is_small').
+template <class D, class V, class M>
+HWY_INLINE V ErfcKernel(D d, V a, V a_lo, V& erf_small, M& is_small) {
+  using T = TFromD<D>;
+  ErfImpl<T> impl;
+
+  const V kOne = Set(d, static_cast<T>(1.0));
+  const M m1 = Ge(a, Set(d, static_cast<T>(0.5)));
+  const M m2 = Ge(a, Set(d, static_cast<T>(1.5)));
+  const M m3 = Ge(a, Set(d, static_cast<T>(2.5)));
+  const M m4 = Ge(a, Set(d, static_cast<T>(4.5)));
+  is_small = Not(m1);
+
+  constexpr double kOffsets[kErfIntervals] = {0.0, 0.5, 1.5, 3.5, 0.0};
+  const V t = IfThenElse(
+      m4, Div(kOne, a),
+      IfThenElse(m1, Sub(a, ErfSelect(d, m1, m2, m3, m4, kOffsets)),
+                 Mul(a, a)));
+
+  V p = ErfSelect(d, m1, m2, m3, m4, kErfP[kErfDegree]);
+  V q = ErfSelect(d, m1, m2, m3, m4, kErfQ[kErfDegree]);
+  for (size_t i = kErfDegree; i-- > 0;) {
+    p = MulAdd(p, t, ErfSelect(d, m1, m2, m3, m4, kErfP[i]));
+    q = MulAdd(q, t, ErfSelect(d, m1, m2, m3, m4, kErfQ[i]));
+  }
+  const V w = Add(ErfSelect(d, m1, m2, m3, m4, kErfY), Div(p, q));
+  erf_small = Mul(a, w);
+
+  // exp(-(a + a_lo)^2) = exp(-hi^2) * exp(-e), where hi^2 is exact and
+  // e = lo * (a + hi) + 2 * a * a_lo is small enough for a Taylor series.
+  const V hi = impl.SplitHi(d, a);
+  const V e = MulAdd(Add(a, a), a_lo, Mul(Sub(a, hi), Add(a, hi)));
+  const V exp_e = MulAdd(
+      e,
+      MulAdd(e,
+             MulAdd(e,
+                    MulAdd(e, Set(d, static_cast<T>(1.0 / 24.0)),
+                           Set(d, static_cast<T>(-1.0 / 6.0))),
+                    Set(d, static_cast<T>(0.5))),
+             Set(d, static_cast<T>(-1.0))),
+      kOne);
+  const V exp_a2 = Mul(Exp(d, Neg(Mul(hi, hi))), exp_e);
+
+  return IfThenElse(is_small, NegMulAdd(a, w, kOne),
+                    Div(Mul(w, exp_a2), a));
+}
+
 template <class D, class V, bool kAllowSubnormals = true>
 HWY_INLINE V Log(const D d, V x) {
   // http://git.musl-libc.org/cgit/musl/tree/src/math/log.c for more info.
@@ -1406,6 +1594,35 @@ HWY_INLINE V Cos(const D d, V x) {
       d, Xor(impl.CosReduce(d, y, q), impl.CosSignFromQuadrant(d, q)));
 }
 
+template <class D, class V>
+HWY_INLINE V Erf(const D d, V x) {
+  using T = TFromD<D>;
+  using M = MFromD<D>;
+
+  const V kOne = Set(d, static_cast<T>(1.0));
+  const V a = Min(Abs(x), Set(d, static_cast<T>(impl::ErfImpl<T>::kMaxArg)));
+
+  V erf_small;
+  M is_small;
+  const V erfc = impl::ErfcKernel(d, a, Zero(d), erf_small, is_small);
+  return CopySignToAbs(IfThenElse(is_small, erf_small, Sub(kOne, erfc)), x);
+}
+
+template <class D, class V>
+HWY_INLINE V Erfc(const D d, V x) {
+  using T = TFromD<D>;
+  using M = MFromD<D>;
+
+  const V a = Min(Abs(x), Set(d, static_cast<T>(impl::ErfImpl<T>::kMaxArg)));
+
+  V erf_small;
+  M is_small;
+  const V erfc = impl::ErfcKernel(d, a, Zero(d), erf_small, is_small);
+  // erfc(-a) = 2 - erfc(a)
+  return IfThenElse(Lt(x, Zero(d)), Sub(Set(d, static_cast<T>(2.0)), erfc),
+                    erfc);
+}
+
 template <class D, class V>
 HWY_INLINE V Exp(const D d, V x) {
   using T = TFromD<D>;
@@ -1485,6 +1702,53 @@ HWY_INLINE V Log2(const D d, V x) {
   return Mul(Log(d, x), Set(d, static_cast<T>(1.44269504088896340735992)));
 }
 
+template <class D, class V>
+HWY_INLINE V NormalCdf(const D d, V x) {
+  using T = TFromD<D>;
+  using M = MFromD<D>;
+
+  constexpr bool kIsF32 = (sizeof(T) == 4);
+
+  // kInvSqrt2Hi + kInvSqrt2Lo ~= 1 / sqrt(2)
+  const V kInvSqrt2Hi =
+      Set(d, kIsF32 ? static_cast<T>(0.707106769084930419921875f)
+                    : static_cast<T>(0.70710678118654757274));
+  const V kInvSqrt2Lo = Set(d, kIsF32 ? static_cast<T>(1.2101617e-08f)
+                                      : static_cast<T>(-4.833646656726457e-17));
+  const V kHalf = Set(d, static_cast<T>(0.5));
+  const V kOne = Set(d, static_cast<T>(1.0));
+
+  // N(x) = 0.5 * erfc(-x / sqrt(2)); a + a_lo = |x| / sqrt(2) exactly enough
+  // that the exp(-a^2) term does not amplify the rounding of the division.
+  // The rounding error of |x| * kInvSqrt2Hi comes from Dekker's product on
+  // halves that multiply exactly, so it does not need a fused MulSub.
+  impl::ErfImpl<T> erf_impl;
+  const V abs_x = Abs(x);
+  const V a_unclamped = Mul(abs_x, kInvSqrt2Hi);
+  const V x_hi = erf_impl.SplitHi(d, abs_x);
+  const V x_lo = Sub(abs_x, x_hi);
+  const V c_hi = erf_impl.SplitHi(d, kInvSqrt2Hi);
+  const V c_lo = Sub(kInvSqrt2Hi, c_hi);
+  const V product_lo = Add(
+      Add(Add(Sub(Mul(x_hi, c_hi), a_unclamped), Mul(x_hi, c_lo)),
+          Mul(x_lo, c_hi)),
+      Mul(x_lo, c_lo));
+  const V kMaxArg = Set(d, static_cast<T>(impl::ErfImpl<T>::kMaxArg));
+  // Beyond kMaxArg the tail is 0; a_lo would be NaN at infinity and
+  // overflow the Taylor term of ErfcKernel for huge |x|
+  const M beyond_max = Gt(a_unclamped, kMaxArg);
+  const V a_lo =
+      IfThenZeroElse(beyond_max, Add(Mul(abs_x, kInvSqrt2Lo), product_lo));
+  const V a = Min(a_unclamped, kMaxArg);
+
+  V erf_small;
+  M is_small;
+  const V half_erfc = IfThenZeroElse(
+      beyond_max,
+      Mul(kHalf, impl::ErfcKernel(d, a, a_lo, erf_small, is_small)));
+  return IfThenElse(Lt(x, Zero(d)), half_erfc, Sub(kOne, half_erfc));
+}
+
 template <class D, class V>
 HWY_INLINE V Sin(const D d, V x) {
   using T = TFromD<D>;
@@ -4,7 +4,11 @@
 
 #pragma
 
+#include <algorithm>
+#include <cassert>
 #include <cmath>
+#include <limits>
+#include "aligned_option_pricing.h"
 #include "common.h"
 #include "naive_math_helper.h"
 
@@ -14,9 +18,165 @@ template <IsFloatOrDouble T = double>
 class NaiveBlackScholes
 {
    public:
-    template <bool Call = true>
+    // Outputs (see Output) selects what is stored, like FastBlackScholes
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
     static void price(OptionPricing<T>& op)
     {
+        price<Call, Outputs>(op.view());
+    }
+
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    static void price(AlignedOptionPricing<T>& op)
+    {
+        price<Call, Outputs>(op.view());
+    }
+
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    static void price(const OptionPricingView<T>& op)
+    {
+        constexpr Legs L = Call ? Legs::kCall : Legs::kPut;
+        price_legs<L, Outputs>(op, PutPricingView<T>(op));
+    }
+
+    // Prices both legs in one pass: call outputs, gammas and vegas go to
+    // 'op', put outputs to 'put'.
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_call_put(OptionPricing<T>& op, PutPricing<T>& put)
+    {
+        price_call_put<Outputs>(op.view(), put.view());
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_call_put(
+        const OptionPricingView<T>& op, const PutPricingView<T>& put)
+    {
+        assert(put.has_outputs(Outputs, op.num_options));
+        price_legs<Legs::kCallAndPut, Outputs>(op, put);
+    }
+
+    // Prices a book that mixes calls and puts, as given by op.option_types
+    // (see OptionType).
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_mixed(OptionPricing<T>& op)
+    {
+        price_mixed<Outputs>(op.view());
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_mixed(AlignedOptionPricing<T>& op)
+    {
+        price_mixed<Outputs>(op.view());
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    static void price_mixed(const OptionPricingView<T>& op)
+    {
+        assert(op.num_options == op.option_types.size());
+        price_legs<Legs::kMixed, Outputs>(op, PutPricingView<T>(op));
+    }
+
+    // Scalar counterpart of FastImpliedVolatility: same initial guess,
+    // safeguarded Newton and tolerances, one quote at a time.
+    static void implied_volatility(const ImpliedVolatilityView<T>& iv)
+    {
+        constexpr T kMaxVolatility = 10.0;
+        constexpr T kTolerance = std::is_same_v<T, float> ? 1e-5 : 1e-11;
+        constexpr size_t kMaxIterations = std::is_same_v<T, float> ? 24 : 48;
+
+        for (size_t i = 0; i < iv.num_options; ++i) {
+            const T target = iv.prices[i];
+            const T underlying = iv.underlyings[i];
+            const T strike = iv.strikes[i];
+            const T time_to_expiry = iv.times_to_expiry[i];
+            const bool is_call = iv.option_types.empty() ||
+                                 iv.option_types[i] > static_cast<T>(0.0);
+
+            const T root_t = std::sqrt(time_to_expiry);
+            const T e_qt = exp(-time_to_expiry * iv.dividend_yields[i]);
+            const T e_rt = exp(-time_to_expiry * iv.risk_free_rates[i]);
+            const T underlying_e_qt = underlying * e_qt;
+            const T strike_e_rt = strike * e_rt;
+            const T log_moneyness =
+                std::log(underlying / strike) +
+                (iv.risk_free_rates[i] - iv.dividend_yields[i]) *
+                    time_to_expiry;
+
+            // Prices at zero and infinite volatility bound the attainable ones
+            const bool in_the_money = log_moneyness > static_cast<T>(0.0);
+            const T intrinsic = is_call ? underlying_e_qt - strike_e_rt
+                                        : strike_e_rt - underlying_e_qt;
+            const T lower =
+                is_call == in_the_money ? intrinsic : static_cast<T>(0.0);
+            const T upper = is_call ? underlying_e_qt : strike_e_rt;
+            if (!(target > lower && target < upper)) {
+                iv.volatilities[i] = std::numeric_limits<T>::quiet_NaN();
+                continue;
+            }
+
+            // Corrado-Miller
+            const T spread = underlying_e_qt - strike_e_rt;
+            const T x = (is_call ? target : target + spread) -
+                        static_cast<T>(0.5) * spread;
+            const T discriminant =
+                x * x - static_cast<T>(0.31830988618379067) * spread * spread;
+            T sigma = static_cast<T>(2.5066282746310002) *
+                      (x + std::sqrt(std::max(discriminant, T{0}))) /
+                      ((underlying_e_qt + strike_e_rt) * root_t);
+            sigma = std::min(
+                std::max(sigma, static_cast<T>(0.01)),
+                static_cast<T>(0.5) * kMaxVolatility);
+
+            T lo = 0;
+            T hi = kMaxVolatility;
+            for (size_t it = 0; it < kMaxIterations; ++it) {
+                const T sigma_root_t = sigma * root_t;
+                const T d1 = log_moneyness / sigma_root_t +
+                             static_cast<T>(0.5) * sigma_root_t;
+                const T d2 = calc_d2(d1, sigma_root_t);
+                const T n_d1 = NaiveMathHelper::normal_cdf<T>(d1);
+                const T n_d2 = NaiveMathHelper::normal_cdf<T>(d2);
+                const T price =
+                    is_call
+                        ? calc_call_price(
+                              underlying, e_qt, n_d1, strike, e_rt, n_d2)
+                        : calc_put_price(
+                              underlying, e_qt, 1 - n_d1, strike, e_rt,
+                              1 - n_d2);
+                const T error = price - target;
+                // dPrice/dSigma, see FastImpliedVolatility
+                const T vega = underlying_e_qt *
+                               NaiveMathHelper::normal_pdf<T>(d1) * root_t;
+
+                (error > static_cast<T>(0.0) ? hi : lo) = sigma;
+                const T newton = sigma - error / vega;
+                const T next = newton > lo && newton < hi
+                                   ? newton
+                                   : static_cast<T>(0.5) * (lo + hi);
+                const bool converged = std::abs(next - sigma) <= kTolerance;
+                sigma = next;
+                if (converged) {
+                    break;
+                }
+            }
+            iv.volatilities[i] = sigma;
+        }
+    }
+
+    enum class Legs
+    {
+        kCall,
+        kPut,
+        kCallAndPut,
+        kMixed  // per op.option_types
+    };
+
+    // Put outputs go to 'put', which aliases the outputs of 'op' when
+    // pricing puts only.
+    template <Legs L, uint32_t Outputs>
+    static void price_legs(
+        const OptionPricingView<T>& op, const PutPricingView<T>& put)
+    {
+        assert(op.has_outputs(Outputs));
         for (size_t i = 0; i < op.num_options; ++i) {
             // Calculate shared constants
             const T sigma_root_t =
@@ -26,44 +186,83 @@ class NaiveBlackScholes
 
             const T d1 = calc_d1(
                 op.underlyings[i], op.strikes[i], op.risk_free_rates[i],
-                op.times_to_expiry[i], sigma_root_t);
+                op.dividend_yields[i], op.times_to_expiry[i], sigma_root_t);
             const T n_d1 = NaiveMathHelper::normal_cdf<T>(d1);
 
             const T d2 = calc_d2(d1, sigma_root_t);
             const T n_d2 = NaiveMathHelper::normal_cdf<T>(d2);
 
+            const T pdf_d1 = NaiveMathHelper::normal_pdf<T>(d1);
+            const T theta_decay = calc_theta_decay(
+                op.underlyings[i], e_qt, sigma_root_t, op.times_to_expiry[i],
+                pdf_d1);
+
             // Actual price, greeks etc
-            if constexpr (Call) {
-                op.prices[i] = calc_call_price(
-                    op.underlyings[i], e_qt, n_d1, op.strikes[i], e_rt, n_d2);
-                op.deltas[i] = calc_call_delta(e_qt, n_d1);
-                op.rhos[i] = calc_call_rho(
-                    op.strikes[i], op.times_to_expiry[i], e_rt, n_d2);
-            } else {
+            const bool is_call = L == Legs::kMixed
+                                     ? op.option_types[i] > static_cast<T>(0.0)
+                                     : L != Legs::kPut;
+            const bool is_put = L == Legs::kMixed ? !is_call : L != Legs::kCall;
+            if (is_call) {
+                if constexpr (Outputs & kPrice) {
+                    op.prices[i] = calc_call_price(
+                        op.underlyings[i], e_qt, n_d1, op.strikes[i], e_rt,
+                        n_d2);
+                }
+                if constexpr (Outputs & kDelta) {
+                    op.deltas[i] = calc_call_delta(e_qt, n_d1);
+                }
+                if constexpr (Outputs & kRho) {
+                    op.rhos[i] = calc_call_rho(
+                        op.strikes[i], op.times_to_expiry[i], e_rt, n_d2);
+                }
+                if constexpr (Outputs & kTheta) {
+                    op.thetas[i] = calc_call_theta(
+                        theta_decay, op.underlyings[i], e_qt,
+                        op.dividend_yields[i], n_d1, op.strikes[i], e_rt,
+                        op.risk_free_rates[i], n_d2);
+                }
+            }
+            if (is_put) {
                 const T n_minus_d1 = -(n_d1 - static_cast<T>(1.0));
                 const T n_minus_d2 = -(n_d2 - static_cast<T>(1.0));
-                op.prices[i] = calc_put_price(
-                    op.underlyings[i], e_qt, n_minus_d1, op.strikes[i], e_rt,
-                    n_minus_d2);
-                op.deltas[i] = calc_put_delta(e_qt, n_minus_d1);
-                op.rhos[i] = calc_put_rho(
-                    op.strikes[i], op.times_to_expiry[i], e_rt, n_minus_d2);
+                if constexpr (Outputs & kPrice) {
+                    put.prices[i] = calc_put_price(
+                        op.underlyings[i], e_qt, n_minus_d1, op.strikes[i],
+                        e_rt, n_minus_d2);
+                }
+                if constexpr (Outputs & kDelta) {
+                    put.deltas[i] = calc_put_delta(e_qt, n_minus_d1);
+                }
+                if constexpr (Outputs & kRho) {
+                    put.rhos[i] = calc_put_rho(
+                        op.strikes[i], op.times_to_expiry[i], e_rt,
+                        n_minus_d2);
+                }
+                if constexpr (Outputs & kTheta) {
+                    put.thetas[i] = calc_put_theta(
+                        theta_decay, op.underlyings[i], e_qt,
+                        op.dividend_yields[i], n_minus_d1, op.strikes[i],
+                        e_rt, op.risk_free_rates[i], n_minus_d2);
+                }
             }
 
-            const T pdf_d1 = NaiveMathHelper::normal_pdf<T>(d1);
-            op.gammas[i] =
-                calc_gamma(e_qt, op.strikes[i], sigma_root_t, pdf_d1);
-            op.vegas[i] = calc_vega(
-                op.underlyings[i], e_qt, op.times_to_expiry[i], pdf_d1);
+            if constexpr (Outputs & kGamma) {
+                op.gammas[i] = calc_gamma(
+                    e_qt, op.underlyings[i], sigma_root_t, pdf_d1);
+            }
+            if constexpr (Outputs & kVega) {
+                op.vegas[i] = calc_vega(
+                    op.underlyings[i], e_qt, op.times_to_expiry[i], pdf_d1);
+            }
         }
     }
 
     [[nodiscard]] static inline T calc_d1(
-        T underlying, T strike, T risk_free_rate, T time_to_expiry,
-        T sigma_root_t)
+        T underlying, T strike, T risk_free_rate, T dividend_yield,
+        T time_to_expiry, T sigma_root_t)
     {
         return ((std::log(underlying / strike) +
-                 risk_free_rate * time_to_expiry) /
+                 (risk_free_rate - dividend_yield) * time_to_expiry) /
                 sigma_root_t) +
                static_cast<T>(0.5) * sigma_root_t;
     }
@@ -119,9 +318,36 @@ class NaiveBlackScholes
         return C_minus * strike * time_to_expiry * e_rt * n_minus_d2;
     }
 
+    [[nodiscard]] static inline T calc_theta_decay(
+        T underlying, T e_qt, T sigma_root_t, T time_to_expiry, T pdf_d1)
+    {
+        return static_cast<T>(-0.5) * underlying * e_qt * pdf_d1 *
+               sigma_root_t / time_to_expiry;
+    }
+
+    [[nodiscard]] static inline T calc_call_theta(
+        T theta_decay, T underlying, T e_qt, T dividend_yield, T n_d1,
+        T strike, T e_rt, T risk_free_rate, T n_d2)
+    {
+        return C_theta *
+               (theta_decay + dividend_yield * underlying * e_qt * n_d1 -
+                risk_free_rate * strike * e_rt * n_d2);
+    }
+
+    [[nodiscard]] static inline T calc_put_theta(
+        T theta_decay, T underlying, T e_qt, T dividend_yield, T n_minus_d1,
+        T strike, T e_rt, T risk_free_rate, T n_minus_d2)
+    {
+        return C_theta *
+               (theta_decay + risk_free_rate * strike * e_rt * n_minus_d2 -
+                dividend_yield * underlying * e_qt * n_minus_d1);
+    }
+
    protected:
     static constexpr T C = 1.0 / 100.0;
     static constexpr T C_minus = -1.0 / 100.0;
+    // Theta per calendar day
+    static constexpr T C_theta = 1.0 / 365.0;
 };
 
 }  // namespace fast_option_pricer
@@ -15,7 +15,7 @@ struct NaiveMathHelper
     template <typename T>
     [[nodiscard]] static inline T normal_cdf(T x)
     {
-        constexpr T sqrt_2 = 1.41421356237;
+        constexpr T sqrt_2 = 1.4142135623730950488;
         return static_cast<T>(0.5) * std::erfc(-x / sqrt_2);
     }
 
@@ -0,0 +1,257 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+#pragma once
+
+#include <hwy/base.h>
+#include <algorithm>
+#include <span>
+#include <vector>
+#include "aligned_option_pricing.h"
+#include "common.h"
+#include "dynamic_black_scholes.h"
+#include "thread_pool.h"
+
+namespace fast_option_pricer {
+
+// Splits a batch into chunks and prices them with DynamicBlackScholes on the
+// threads of a ThreadPool. Chunks are a whole number of HWY_ALIGNMENT bytes
+// per column, so every chunk starts where an aligned column allows aligned
+// loads/stores, and are small enough that a chunk's columns stay in L2.
+template <IsFloatOrDouble T = double>
+class ParallelBlackScholes
+{
+   public:
+    // About 12 columns * 8192 doubles = 768 KiB per chunk
+    static constexpr size_t kDefaultChunkSize = 8192;
+    // Paths of every option per Monte Carlo task
+    static constexpr size_t kMonteCarloPathsPerTask = 16384;
+
+    explicit ParallelBlackScholes(
+        ThreadPool& pool, size_t chunk_size = kDefaultChunkSize)
+        : pool_(pool),
+          chunk_size_(hwy::RoundUpTo(
+              std::max<size_t>(chunk_size, 1), HWY_ALIGNMENT / sizeof(T)))
+    {
+    }
+
+    [[nodiscard]] size_t chunk_size() const
+    {
+        return chunk_size_;
+    }
+
+    // Outputs is kAllOutputs or kPrice, see DynamicBlackScholes.
+    // Stores::kAuto is decided on the whole batch, not per chunk.
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    void price(OptionPricing<T>& op, Stores stores = Stores::kCached) const
+    {
+        price<Call, Outputs>(op.view(), stores);
+    }
+
+    // Also marks every option of 'op' clean, see reprice_dirty
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    void price(
+        AlignedOptionPricing<T>& op, Stores stores = Stores::kCached) const
+    {
+        price<Call, Outputs>(op.view(), stores);
+        op.mark_all_clean();
+    }
+
+    template <bool Call = true, uint32_t Outputs = kAllOutputs>
+    void price(
+        const OptionPricingView<T>& op, Stores stores = Stores::kCached) const
+    {
+        // Before subview, which expects every column to span the batch
+        require_outputs(op, Outputs);
+        const Stores chunk_stores =
+            batch_stores(stores, op, pass_columns(Outputs, false, false));
+        for_each_chunk(op.num_options, [&](size_t begin, size_t count) {
+            DynamicBlackScholes<T>::template price<Call, Outputs>(
+                op.subview(begin, count), chunk_stores);
+        });
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    void price_call_put(
+        OptionPricing<T>& op, PutPricing<T>& put,
+        Stores stores = Stores::kCached) const
+    {
+        price_call_put<Outputs>(op.view(), put.view(), stores);
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    void price_call_put(
+        const OptionPricingView<T>& op, const PutPricingView<T>& put,
+        Stores stores = Stores::kCached) const
+    {
+        require_outputs(op, Outputs);
+        require_outputs(put, Outputs, op.num_options);
+        const Stores chunk_stores =
+            batch_stores(stores, op, pass_columns(Outputs, false, true));
+        for_each_chunk(op.num_options, [&](size_t begin, size_t count) {
+            DynamicBlackScholes<T>::template price_call_put<Outputs>(
+                op.subview(begin, count),
+                put.subview(begin, count, op.num_options), chunk_stores);
+        });
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    void price_mixed(
+        OptionPricing<T>& op, Stores stores = Stores::kCached) const
+    {
+        price_mixed<Outputs>(op.view(), stores);
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    void price_mixed(
+        AlignedOptionPricing<T>& op, Stores stores = Stores::kCached) const
+    {
+        price_mixed<Outputs>(op.view(), stores);
+        op.mark_all_clean();
+    }
+
+    template <uint32_t Outputs = kAllOutputs>
+    void price_mixed(
+        const OptionPricingView<T>& op, Stores stores = Stores::kCached) const
+    {
+        require_outputs(op, Outputs);
+        const Stores chunk_stores =
+            batch_stores(stores, op, pass_columns(Outputs, true, false));
+        for_each_chunk(op.num_options, [&](size_t begin, size_t count) {
+            DynamicBlackScholes<T>::template price_mixed<Outputs>(
+                op.subview(begin, count), chunk_stores);
+        });
+    }
+
+    // See FastScenarioGrid::revalue. Chunks write their options' rows of
+    // every scenario column of 'pnl'.
+    void revalue_scenarios(
+        const OptionPricingView<T>& op, const ScenarioGridView<T>& grid,
+        std::span<T> pnl) const
+    {
+        for_each_chunk(op.num_options, [&](size_t begin, size_t count) {
+            DynamicBlackScholes<T>::revalue_scenarios(
+                op.subview(begin, count), grid, pnl.subspan(begin),
+                op.num_options);
+        });
+    }
+
+    // See FastScenarioGrid::aggregate. Chunks sum into totals of their own,
+    // which are added up once every chunk is done.
+    void aggregate_scenarios(
+        const OptionPricingView<T>& op, const ScenarioGridView<T>& grid,
+        std::span<const T> positions, std::span<T> totals) const
+    {
+        const size_t num_scenarios = grid.num_scenarios();
+        std::vector<T> chunk_totals(
+            hwy::DivCeil(op.num_options, chunk_size_) * num_scenarios, 0);
+        for_each_chunk(op.num_options, [&](size_t begin, size_t count) {
+            DynamicBlackScholes<T>::aggregate_scenarios(
+                op.subview(begin, count), grid,
+                positions.subspan(begin, count),
+                std::span<T>(chunk_totals)
+                    .subspan(begin / chunk_size_ * num_scenarios));
+        });
+        std::fill(totals.begin(), totals.begin() + num_scenarios, T{0});
+        for (size_t c = 0; c < chunk_totals.size(); c += num_scenarios) {
+            for (size_t s = 0; s < num_scenarios; ++s) {
+                totals[s] += chunk_totals[c + s];
+            }
+        }
+    }
+
+    // See FastMonteCarlo::price. Tasks simulate fixed ranges of
+    // kMonteCarloPathsPerTask paths of every option, and their sums are added
+    // up in task order, so prices do not depend on the number of threads.
+    template <bool Call = true>
+    void price_monte_carlo(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        std::span<T> standard_errors = {}) const
+    {
+        for_each_path_range(
+            op, settings, standard_errors,
+            [&](size_t first_path, size_t num_paths, std::span<T> sums,
+                std::span<T> sums_of_squares) {
+                DynamicBlackScholes<T>::template accumulate_monte_carlo<Call>(
+                    op, settings, first_path, num_paths, sums,
+                    sums_of_squares);
+            });
+    }
+
+    void price_monte_carlo_mixed(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        std::span<T> standard_errors = {}) const
+    {
+        for_each_path_range(
+            op, settings, standard_errors,
+            [&](size_t first_path, size_t num_paths, std::span<T> sums,
+                std::span<T> sums_of_squares) {
+                DynamicBlackScholes<T>::accumulate_monte_carlo_mixed(
+                    op, settings, first_path, num_paths, sums,
+                    sums_of_squares);
+            });
+    }
+
+   private:
+    // Stores of every chunk of 'op'. A chunk's columns fit in L2, so kAuto
+    // has to be decided on the batch they were cut from.
+    [[nodiscard]] static Stores batch_stores(
+        Stores stores, const OptionPricingView<T>& op, size_t columns)
+    {
+        return streams_outputs(stores, op.num_options * columns * sizeof(T))
+                   ? Stores::kStreaming
+                   : Stores::kCached;
+    }
+
+    template <typename F>
+    void for_each_chunk(size_t num_options, const F& f) const
+    {
+        const size_t num_chunks = hwy::DivCeil(num_options, chunk_size_);
+        pool_.run(num_chunks, [&](size_t chunk) {
+            const size_t begin = chunk * chunk_size_;
+            f(begin, std::min(chunk_size_, num_options - begin));
+        });
+    }
+
+    // Calls f(first_path, num_paths, sums, sums_of_squares) for every range
+    // of kMonteCarloPathsPerTask paths, with sums of the range's own, then
+    // prices 'op' from their totals
+    template <typename F>
+    void for_each_path_range(
+        const OptionPricingView<T>& op, const MonteCarloSettings& settings,
+        std::span<T> standard_errors, const F& f) const
+    {
+        const size_t num_options = op.num_options;
+        const size_t num_tasks =
+            hwy::DivCeil(settings.num_paths, kMonteCarloPathsPerTask);
+        std::vector<T> task_sums(num_tasks * num_options, 0);
+        std::vector<T> task_squares(num_tasks * num_options, 0);
+        pool_.run(num_tasks, [&](size_t task) {
+            const size_t first_path = task * kMonteCarloPathsPerTask;
+            f(first_path,
+              std::min(
+                  kMonteCarloPathsPerTask, settings.num_paths - first_path),
+              std::span<T>(task_sums)
+                  .subspan(task * num_options, num_options),
+              std::span<T>(task_squares)
+                  .subspan(task * num_options, num_options));
+        });
+
+        std::vector<T> sums(num_options, 0);
+        std::vector<T> sums_of_squares(num_options, 0);
+        for (size_t task = 0; task < num_tasks; ++task) {
+            for (size_t i = 0; i < num_options; ++i) {
+                sums[i] += task_sums[task * num_options + i];
+                sums_of_squares[i] += task_squares[task * num_options + i];
+            }
+        }
+        DynamicBlackScholes<T>::finish_monte_carlo(
+            op, settings, sums, sums_of_squares, standard_errors);
+    }
+
+    ThreadPool& pool_;
+    const size_t chunk_size_;
+};
+
+}  // namespace fast_option_pricer
@@ -0,0 +1,143 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+#pragma once
+
+#include <hwy/aligned_allocator.h>
+#include <hwy/base.h>
+#include <span>
+#include "common.h"
+
+namespace fast_option_pricer {
+
+// Per-option intermediates of FastBlackScholes that do not depend on the
+// underlying, filled by FastSpotTick::cache_inputs and read by every spot
+// tick until strikes, rates, dividend yields, volatilities or times to expiry
+// change. A tick reads the underlyings and these columns only. Columns
+// are aligned and padded like those of AlignedOptionPricing.
+template <IsFloatOrDouble T>
+class SpotCache
+{
+   public:
+    explicit SpotCache(size_t num_options = 0)
+    {
+        resize(num_options);
+    }
+
+    // Only allocates if num_options exceeds capacity(), in which case the
+    // contents of all columns are unspecified.
+    void resize(size_t num_options)
+    {
+        if (num_options > capacity_) {
+            capacity_ = hwy::RoundUpTo(num_options, kColumnPadding);
+            data_ = hwy::AllocateAligned<T>(kNumColumns * capacity_);
+        }
+        num_options_ = num_options;
+    }
+
+    [[nodiscard]] size_t num_options() const
+    {
+        return num_options_;
+    }
+
+    [[nodiscard]] size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    // 1 / K, so that d1 = (log(S * (1 / K)) + drift) / sigma_root_t + ...
+    [[nodiscard]] std::span<T> inverse_strikes()
+    {
+        return column(kInverseStrikes);
+    }
+
+    // (r - q) * T
+    [[nodiscard]] std::span<T> drifts()
+    {
+        return column(kDrifts);
+    }
+
+    // sigma * sqrt(T)
+    [[nodiscard]] std::span<T> sigma_root_ts()
+    {
+        return column(kSigmaRootTs);
+    }
+
+    // sqrt(T), for vega
+    [[nodiscard]] std::span<T> root_ts()
+    {
+        return column(kRootTs);
+    }
+
+    // sigma * sqrt(T) / T, for the time decay part of theta
+    [[nodiscard]] std::span<T> decay_rates()
+    {
+        return column(kDecayRates);
+    }
+
+    // e^(-qT)
+    [[nodiscard]] std::span<T> e_qts()
+    {
+        return column(kE_qts);
+    }
+
+    // q * e^(-qT), for theta
+    [[nodiscard]] std::span<T> dividend_e_qts()
+    {
+        return column(kDividendE_qts);
+    }
+
+    // K * e^(-rT)
+    [[nodiscard]] std::span<T> discounted_strikes()
+    {
+        return column(kDiscountedStrikes);
+    }
+
+    // r * K * e^(-rT), for theta
+    [[nodiscard]] std::span<T> rate_discounted_strikes()
+    {
+        return column(kRateDiscountedStrikes);
+    }
+
+    // T * K * e^(-rT), for rho
+    [[nodiscard]] std::span<T> time_discounted_strikes()
+    {
+        return column(kTimeDiscountedStrikes);
+    }
+
+    // Options that can be read and written, including the padding
+    [[nodiscard]] size_t padded_num_options() const
+    {
+        return hwy::RoundUpTo(num_options_, kColumnPadding);
+    }
+
+    static constexpr size_t kColumnPadding = HWY_ALIGNMENT / sizeof(T);
+
+   private:
+    enum Column : size_t
+    {
+        kInverseStrikes,
+        kDrifts,
+        kSigmaRootTs,
+        kRootTs,
+        kDecayRates,
+        kE_qts,
+        kDividendE_qts,
+        kDiscountedStrikes,
+        kRateDiscountedStrikes,
+        kTimeDiscountedStrikes,
+        kNumColumns
+    };
+
+    [[nodiscard]] std::span<T> column(size_t c)
+    {
+        return {data_.get() + c * capacity_, num_options_};
+    }
+
+    size_t num_options_{0};
+    size_t capacity_{0};
+    hwy::AlignedFreeUniquePtr<T[]> data_;
+};
+
+}  // namespace fast_option_pricer
@@ -0,0 +1,108 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace fast_option_pricer {
+
+namespace {
+
+// Pool whose tasks the current thread is running, if any
+thread_local const ThreadPool* running_pool = nullptr;
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t num_threads)
+{
+    const size_t num_workers = std::max<size_t>(num_threads, 1) - 1;
+    workers_.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        workers_.emplace_back([this] { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(size_t num_tasks, const std::function<void(size_t)>& task)
+{
+    // A task of this pool holds run_mutex_ through its caller, and the other
+    // threads may be waiting for it to finish
+    if (workers_.empty() || num_tasks <= 1 || running_pool == this) {
+        for (size_t i = 0; i < num_tasks; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        num_tasks_ = num_tasks;
+        next_task_.store(0, std::memory_order_relaxed);
+        num_busy_ = workers_.size();
+        ++generation_;
+    }
+    start_.notify_all();
+
+    run_tasks();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return num_busy_ == 0; });
+    task_ = nullptr;
+}
+
+size_t ThreadPool::default_num_threads()
+{
+    return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+void ThreadPool::work()
+{
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+        }
+
+        run_tasks();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--num_busy_ == 0) {
+            done_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::run_tasks()
+{
+    const ThreadPool* const outer_pool = std::exchange(running_pool, this);
+    // Tasks are claimed one at a time, so uneven tasks still balance
+    for (size_t i = next_task_.fetch_add(1, std::memory_order_relaxed);
+         i < num_tasks_;
+         i = next_task_.fetch_add(1, std::memory_order_relaxed)) {
+        (*task_)(i);
+    }
+    running_pool = outer_pool;
+}
+
+}  // namespace fast_option_pricer
@@ -0,0 +1,62 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fast_option_pricer {
+
+// Fixed set of worker threads that live as long as the pool, so running a
+// batch of tasks costs a wake-up rather than thread creation. The calling
+// thread works on the batch too.
+class ThreadPool
+{
+   public:
+    // num_threads counts the calling thread, so 1 runs everything inline
+    explicit ThreadPool(size_t num_threads = default_num_threads());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    [[nodiscard]] size_t num_threads() const
+    {
+        return workers_.size() + 1;
+    }
+
+    // Calls task(i) once for every i in [0, num_tasks), spread over all
+    // threads, and returns when every call has returned. Tasks must not
+    // throw. Concurrent run() calls are serialized. A task may call run() on
+    // its own pool, which then runs the nested batch inline on that task's
+    // thread; tasks of two pools must not call run() on each other.
+    void run(size_t num_tasks, const std::function<void(size_t)>& task);
+
+    // One thread per hardware thread
+    [[nodiscard]] static size_t default_num_threads();
+
+   private:
+    void work();
+    void run_tasks();
+
+    std::vector<std::thread> workers_;
+    std::mutex run_mutex_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* task_{nullptr};
+    size_t num_tasks_{0};
+    std::atomic<size_t> next_task_{0};
+    uint64_t generation_{0};
+    size_t num_busy_{0};
+    bool stop_{false};
+};
+
+}  // namespace fast_option_pricer
@@ -5,12 +5,30 @@
 #include <benchmark/benchmark.h>
 #include <gtest/gtest.h>
 #include <hwy/highway.h>
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <span>
+#include <type_traits>
 #include <vector>
+#include "aligned_option_pricing.h"
+#include "blocked_black_scholes.h"
+#include "cache_info.h"
 #include "common.h"
+#include "dynamic_black_scholes.h"
+#include "fast_barone_adesi_whaley.h"
+#include "fast_binomial_tree.h"
 #include "fast_black_scholes.h"
+#include "fast_implied_volatility.h"
+#include "fast_monte_carlo.h"
+#include "fast_option_records.h"
+#include "fast_philox.h"
+#include "fast_scenario_grid.h"
+#include "fast_spot_tick.h"
 #include "naive_black_scholes.h"
+#include "parallel_black_scholes.h"
+#include "thread_pool.h"
 
 namespace fast_option_pricer {
 
@@ -19,13 +37,16 @@ namespace hn = hwy::HWY_NAMESPACE;
 template <typename T>
 struct RandomInput
 {
-    explicit RandomInput(unsigned int seed = 1)
-        : underlyings(num_options, 0),
+    explicit RandomInput(
+        unsigned int seed = 1, size_t num_options = 10000000)
+        : num_options(num_options),
+          underlyings(num_options, 0),
           strikes(num_options, 0),
           risk_free_rates(num_options, 0),
           volatilities(num_options, 0),
           times_to_expiry(num_options, 0),
-          dividend_yields(num_options, 0)
+          dividend_yields(num_options, 0),
+          option_types(num_options, 0)
     {
         std::srand(seed);
         for (size_t i = 0; i < num_options; ++i) {
@@ -36,6 +57,11 @@ struct RandomInput
             times_to_expiry[i] = rng(251.0) / 252.0;
             dividend_yields[i] = rng(0.10);
         }
+        for (size_t i = 0; i < num_options; ++i) {
+            option_types[i] = rng(1.0) < static_cast<T>(0.5)
+                                  ? OptionType<T>::kCall
+                                  : OptionType<T>::kPut;
+        }
     }
 
     [[nodiscard]] T rng(float HI)
@@ -43,15 +69,40 @@ struct RandomInput
         return static_cast<T>(std::rand()) / (static_cast<T>(RAND_MAX / HI));
     }
 
-    size_t num_options{10000000};
+    size_t num_options;
     std::vector<T> underlyings;
     std::vector<T> strikes;
     std::vector<T> risk_free_rates;
     std::vector<T> volatilities;
     std::vector<T> times_to_expiry;
     std::vector<T> dividend_yields;
+    std::vector<T> option_types;
 };
 
+template <typename T>
+static void CopyInputs(const RandomInput<T>& r, AlignedOptionPricing<T>& op)
+{
+    op.resize(r.num_options);
+    std::copy(
+        r.underlyings.begin(), r.underlyings.end(), op.underlyings().begin());
+    std::copy(r.strikes.begin(), r.strikes.end(), op.strikes().begin());
+    std::copy(
+        r.risk_free_rates.begin(), r.risk_free_rates.end(),
+        op.risk_free_rates().begin());
+    std::copy(
+        r.volatilities.begin(), r.volatilities.end(),
+        op.volatilities().begin());
+    std::copy(
+        r.times_to_expiry.begin(), r.times_to_expiry.end(),
+        op.times_to_expiry().begin());
+    std::copy(
+        r.dividend_yields.begin(), r.dividend_yields.end(),
+        op.dividend_yields().begin());
+    std::copy(
+        r.option_types.begin(), r.option_types.end(),
+        op.option_types().begin());
+}
+
 template <typename T>
 static void BM_NaivePrice(benchmark::State& state)
 {
@@ -84,106 +135,3108 @@ static void BM_FastPrice(benchmark::State& state)
     }
 }
 
-BENCHMARK(BM_FastPrice<double>);
-BENCHMARK(BM_NaivePrice<double>);
-BENCHMARK(BM_FastPrice<float>);
-BENCHMARK(BM_NaivePrice<float>);
-
-TEST(BlackScholesTestDouble, ComparePrice)
+template <typename T>
+static void BM_DynamicPrice(benchmark::State& state)
 {
-    // Assign
-    using T = double;
-    RandomInput<T> r{};
-    OptionPricing<T> fast_op_call(
+    // Perform setup here
+    RandomInput<T> r;
+    OptionPricing<T> dynamic_op(
         r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
         r.times_to_expiry, r.dividend_yields);
-    OptionPricing<T> fast_op_put(
+    state.SetLabel(dispatched_target_name());
+
+    for (auto _ : state) {
+        // This code gets timed
+        DynamicBlackScholes<T>::template price<true>(dynamic_op);
+        DynamicBlackScholes<T>::template price<false>(dynamic_op);
+    }
+}
+
+template <typename T>
+static void BM_FastPriceSize(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r{1, static_cast<size_t>(state.range(0))};
+    OptionPricing<T> fast_op(
         r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
         r.times_to_expiry, r.dividend_yields);
-    OptionPricing<T> naive_op_call(
+
+    for (auto _ : state) {
+        // This code gets timed
+        FastBlackScholes<T, hn::ScalableTag<T>>::template price<true>(fast_op);
+        FastBlackScholes<T, hn::ScalableTag<T>>::template price<false>(fast_op);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T>
+static void BM_FastPriceAligned(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r;
+    AlignedOptionPricing<T> fast_op;
+    CopyInputs(r, fast_op);
+
+    for (auto _ : state) {
+        // This code gets timed
+        FastBlackScholes<T, hn::ScalableTag<T>>::template price<true>(fast_op);
+        FastBlackScholes<T, hn::ScalableTag<T>>::template price<false>(fast_op);
+    }
+}
+
+template <typename T>
+static void BM_FastPriceCallPut(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r;
+    OptionPricing<T> fast_op(
         r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
         r.times_to_expiry, r.dividend_yields);
-    OptionPricing<T> naive_op_put(
+    PutPricing<T> fast_put(r.num_options);
+
+    for (auto _ : state) {
+        // This code gets timed
+        FastBlackScholes<T, hn::ScalableTag<T>>::price_call_put(
+            fast_op, fast_put);
+    }
+}
+
+template <typename T>
+static void BM_FastPriceMixed(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r;
+    OptionPricing<T> fast_op(
         r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
-        r.times_to_expiry, r.dividend_yields);
+        r.times_to_expiry, r.dividend_yields, r.option_types);
 
-    // Act
-    FastBlackScholes<T, hn::ScalableTag<T>>::price<true>(fast_op_call);
-    NaiveBlackScholes<T>::price<true>(naive_op_call);
-    FastBlackScholes<T, hn::ScalableTag<T>>::price<false>(fast_op_put);
-    NaiveBlackScholes<T>::price<false>(naive_op_put);
+    for (auto _ : state) {
+        // This code gets timed
+        FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(fast_op);
+    }
+}
 
-    // Assert
-    EXPECT_EQ(fast_op_call.prices.size(), naive_op_call.prices.size());
-    EXPECT_EQ(fast_op_call.deltas.size(), naive_op_call.deltas.size());
-    EXPECT_EQ(fast_op_call.vegas.size(), naive_op_call.vegas.size());
-    EXPECT_EQ(fast_op_call.thetas.size(), naive_op_call.thetas.size());
-    EXPECT_EQ(fast_op_call.gammas.size(), naive_op_call.gammas.size());
-    EXPECT_EQ(fast_op_call.rhos.size(), naive_op_call.rhos.size());
-    EXPECT_EQ(fast_op_put.prices.size(), naive_op_put.prices.size());
-    EXPECT_EQ(fast_op_put.deltas.size(), naive_op_put.deltas.size());
-    EXPECT_EQ(fast_op_put.vegas.size(), naive_op_put.vegas.size());
-    EXPECT_EQ(fast_op_put.thetas.size(), naive_op_put.thetas.size());
-    EXPECT_EQ(fast_op_put.gammas.size(), naive_op_put.gammas.size());
-    EXPECT_EQ(fast_op_put.rhos.size(), naive_op_put.rhos.size());
-    for (auto i = 0; i < fast_op_call.prices.size(); ++i) {
-        EXPECT_NEAR(fast_op_call.prices[i], naive_op_call.prices[i], 1e-5);
-        EXPECT_NEAR(fast_op_call.deltas[i], naive_op_call.deltas[i], 1e-5);
-        EXPECT_NEAR(fast_op_call.vegas[i], naive_op_call.vegas[i], 1e-5);
-        EXPECT_NEAR(fast_op_call.thetas[i], naive_op_call.thetas[i], 1e-5);
-        EXPECT_NEAR(fast_op_call.gammas[i], naive_op_call.gammas[i], 1e-5);
-        EXPECT_NEAR(fast_op_call.rhos[i], naive_op_call.rhos[i], 1e-5);
-        EXPECT_NEAR(fast_op_put.prices[i], naive_op_put.prices[i], 1e-5);
-        EXPECT_NEAR(fast_op_put.deltas[i], naive_op_put.deltas[i], 1e-5);
-        EXPECT_NEAR(fast_op_put.vegas[i], naive_op_put.vegas[i], 1e-5);
-        EXPECT_NEAR(fast_op_put.thetas[i], naive_op_put.thetas[i], 1e-5);
-        EXPECT_NEAR(fast_op_put.gammas[i], naive_op_put.gammas[i], 1e-5);
-        EXPECT_NEAR(fast_op_put.rhos[i], naive_op_put.rhos[i], 1e-5);
+// Mixed book at each Accuracy
+template <typename T, Accuracy A>
+static void BM_FastPriceAccuracy(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r;
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+
+    for (auto _ : state) {
+        // This code gets timed
+        FastBlackScholes<T, hn::ScalableTag<T>, A>::price_mixed(fast_op);
     }
+    state.SetItemsProcessed(state.iterations() * r.num_options);
 }
 
-TEST(BlackScholesTestFloat, CompareFloatDouble)
+// 10M options are far larger than the last level cache, so streaming the
+// outputs saves the read for ownership of every output line
+template <typename T, Stores S>
+static void BM_FastPriceStores(benchmark::State& state)
 {
-    // Assign
-    RandomInput<double> r1{};
-    OptionPricing<double> fast_op_double(
-        r1.underlyings, r1.strikes, r1.risk_free_rates, r1.volatilities,
-        r1.times_to_expiry, r1.dividend_yields);
-    OptionPricing<double> naive_op_double(
-        r1.underlyings, r1.strikes, r1.risk_free_rates, r1.volatilities,
-        r1.times_to_expiry, r1.dividend_yields);
-    RandomInput<float> r2{};
-    OptionPricing<float> fast_op_float(
-        r2.underlyings, r2.strikes, r2.risk_free_rates, r2.volatilities,
-        r2.times_to_expiry, r2.dividend_yields);
-    OptionPricing<float> naive_op_float(
-        r2.underlyings, r2.strikes, r2.risk_free_rates, r2.volatilities,
-        r2.times_to_expiry, r2.dividend_yields);
+    // Perform setup here
+    RandomInput<T> r;
+    AlignedOptionPricing<T> fast_op;
+    CopyInputs(r, fast_op);
 
-    // Act
-    FastBlackScholes<double, hn::ScalableTag<double>>::price<true>(
-        fast_op_double);
-    FastBlackScholes<float, hn::ScalableTag<float>>::price<true>(fast_op_float);
-    FastBlackScholes<double, hn::ScalableTag<double>>::price<true>(
-        naive_op_double);
-    FastBlackScholes<float, hn::ScalableTag<float>>::price<true>(
-        naive_op_float);
+    for (auto _ : state) {
+        // This code gets timed
+        FastBlackScholes<
+            T, hn::ScalableTag<T>, Accuracy::kExact, Precision::kFull,
+            S>::price_mixed(fast_op);
+    }
+    state.SetItemsProcessed(state.iterations() * r.num_options);
+}
 
-    // Assert
-    EXPECT_EQ(fast_op_double.prices.size(), fast_op_float.prices.size());
-    EXPECT_EQ(fast_op_double.prices.size(), naive_op_double.prices.size());
-    EXPECT_EQ(fast_op_double.prices.size(), naive_op_float.prices.size());
-    EXPECT_EQ(fast_op_double.deltas.size(), fast_op_float.deltas.size());
-    EXPECT_EQ(fast_op_double.deltas.size(), naive_op_double.deltas.size());
-    EXPECT_EQ(fast_op_double.deltas.size(), naive_op_float.deltas.size());
-    for (auto i = 0; i < fast_op_double.prices.size(); ++i) {
-        EXPECT_NEAR(fast_op_double.prices[i], fast_op_float.prices[i], 1e-2);
-        EXPECT_NEAR(fast_op_double.prices[i], naive_op_double.prices[i], 1e-2);
-        EXPECT_NEAR(fast_op_double.prices[i], naive_op_float.prices[i], 1e-2);
-        EXPECT_NEAR(fast_op_double.deltas[i], fast_op_float.deltas[i], 1e-2);
-        EXPECT_NEAR(fast_op_double.deltas[i], naive_op_double.deltas[i], 1e-2);
-        EXPECT_NEAR(fast_op_double.deltas[i], naive_op_float.deltas[i], 1e-2);
+// An intraday cycle that moves state.range(0) percent of the book, against
+// BM_FastPriceMixed revaluing all of it
+template <typename T>
+static void BM_FastRepriceDirty(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r;
+    AlignedOptionPricing<T> fast_op;
+    CopyInputs(r, fast_op);
+    FastBlackScholes<T, hn::ScalableTag<T>>::reprice_dirty_mixed(fast_op);
+    const size_t num_changed = r.num_options * state.range(0) / 100;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (size_t k = 0; k < num_changed; ++k) {
+            const size_t i = std::rand() % r.num_options;
+            fast_op.set_underlying(i, r.rng(500.0));
+        }
+        state.ResumeTiming();
+        // This code gets timed
+        FastBlackScholes<T, hn::ScalableTag<T>>::reprice_dirty_mixed(fast_op);
+    }
+    state.SetItemsProcessed(state.iterations() * num_changed);
+}
+
+// A 50k option chain repriced after its underlying ticks, in full or with
+// the intermediates that do not depend on the underlying cached
+template <typename T, bool Cached>
+static void BM_FastSpotTick(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r{1, 50000};
+    AlignedOptionPricing<T> fast_op;
+    CopyInputs(r, fast_op);
+    SpotCache<T> cache;
+    FastSpotTick<T, hn::ScalableTag<T>>::cache_inputs(fast_op, cache);
+    T spot = 250;
+
+    for (auto _ : state) {
+        // This code gets timed
+        spot += static_cast<T>(0.01);
+        std::fill(
+            fast_op.underlyings().begin(), fast_op.underlyings().end(), spot);
+        if constexpr (Cached) {
+            FastSpotTick<T, hn::ScalableTag<T>>::price_mixed(fast_op, cache);
+        } else {
+            FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(fast_op);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * r.num_options);
+}
+
+// A book whose rates, dividend yields and expiries come from 64 expiry
+// buckets, against BM_FastPriceMixed reading them per option
+template <typename T>
+static void BM_FastPriceBucketed(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r;
+    constexpr size_t kNumBuckets = 64;
+    const std::vector<T> bucket_rates(
+        r.risk_free_rates.begin(), r.risk_free_rates.begin() + kNumBuckets);
+    const std::vector<T> bucket_yields(
+        r.dividend_yields.begin(), r.dividend_yields.begin() + kNumBuckets);
+    const std::vector<T> bucket_expiries(
+        r.times_to_expiry.begin(), r.times_to_expiry.begin() + kNumBuckets);
+    std::vector<BucketIndex<T>> buckets(r.num_options, 0);
+    for (size_t i = 0; i < r.num_options; ++i) {
+        buckets[i] = std::rand() % kNumBuckets;
+    }
+    const TermStructureView<T> ts(
+        bucket_rates, bucket_yields, bucket_expiries, buckets);
+    BucketTerms<T> terms;
+    FastBlackScholes<T, hn::ScalableTag<T>>::cache_bucket_terms(ts, terms);
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, {}, r.volatilities, {}, {}, r.option_types);
+
+    for (auto _ : state) {
+        // This code gets timed
+        FastBlackScholes<T, hn::ScalableTag<T>>::price_bucketed_mixed(
+            fast_op.view(), ts, terms);
+    }
+    state.SetItemsProcessed(state.iterations() * r.num_options);
+}
+
+// Position weighted P&L of a 100k option book on a 21 x 11 grid of spot and
+// vol shocks, with FastScenarioGrid or by repricing a shocked copy of the
+// book per scenario
+template <typename T, bool Grid>
+static void BM_ScenarioGrid(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r{1, 100000};
+    std::vector<T> spot_shocks(21, 0);
+    std::vector<T> vol_shocks(11, 0);
+    for (auto j = 0; j < spot_shocks.size(); ++j) {
+        spot_shocks[j] = static_cast<T>(0.01) * (static_cast<T>(j) - 10);
+    }
+    for (auto k = 0; k < vol_shocks.size(); ++k) {
+        vol_shocks[k] = static_cast<T>(0.01) * static_cast<T>(k);
+    }
+    const ScenarioGridView<T> grid{spot_shocks, vol_shocks};
+    const std::vector<T> positions(r.num_options, 1);
+    std::vector<T> totals(grid.num_scenarios(), 0);
+    OptionPricing<T> op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+
+    for (auto _ : state) {
+        // This code gets timed
+        if constexpr (Grid) {
+            FastScenarioGrid<T, hn::ScalableTag<T>>::aggregate(
+                op.view(), grid, positions, totals);
+        } else {
+            FastBlackScholes<T, hn::ScalableTag<T>>::template price_mixed<
+                kPrice>(op);
+            for (auto j = 0; j < spot_shocks.size(); ++j) {
+                for (auto k = 0; k < vol_shocks.size(); ++k) {
+                    std::vector<T> underlyings(r.underlyings);
+                    std::vector<T> volatilities(r.volatilities);
+                    for (auto i = 0; i < r.num_options; ++i) {
+                        underlyings[i] *= 1 + spot_shocks[j];
+                        volatilities[i] += vol_shocks[k];
+                    }
+                    OptionPricing<T> shocked_op(
+                        underlyings, r.strikes, r.risk_free_rates,
+                        volatilities, r.times_to_expiry, r.dividend_yields,
+                        r.option_types, kPrice);
+                    FastBlackScholes<T, hn::ScalableTag<T>>::
+                        template price_mixed<kPrice>(shocked_op);
+                    T total = 0;
+                    for (auto i = 0; i < r.num_options; ++i) {
+                        total += positions[i] *
+                                 (shocked_op.prices[i] - op.prices[i]);
+                    }
+                    totals[grid.scenario(j, k)] = total;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(totals.data());
+    }
+    state.SetItemsProcessed(
+        state.iterations() * r.num_options * grid.num_scenarios());
+}
+
+// A 1000 strike chain priced from its shared inputs, against
+// BM_FastPriceMixed on the same chain expanded into columns
+template <typename T, bool Chain>
+static void BM_FastPriceChain(benchmark::State& state)
+{
+    // Perform setup here
+    const StrikeChain<T> chain{100, 0.03, 0.5, 0.01};
+    RandomInput<T> r{1, 1000};
+    std::fill(r.underlyings.begin(), r.underlyings.end(), chain.underlying);
+    std::fill(
+        r.risk_free_rates.begin(), r.risk_free_rates.end(),
+        chain.risk_free_rate);
+    std::fill(
+        r.times_to_expiry.begin(), r.times_to_expiry.end(),
+        chain.time_to_expiry);
+    std::fill(
+        r.dividend_yields.begin(), r.dividend_yields.end(),
+        chain.dividend_yield);
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    OptionPricing<T> chain_op(
+        {}, r.strikes, {}, r.volatilities, {}, {}, r.option_types);
+
+    for (auto _ : state) {
+        // This code gets timed
+        if constexpr (Chain) {
+            FastBlackScholes<T, hn::ScalableTag<T>>::price_chain_mixed(
+                chain, chain_op.view());
+        } else {
+            FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(fast_op);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * r.num_options);
+}
+
+// American prices of a 10k option book on 200 step trees
+template <typename T>
+static void BM_FastBinomialTree(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r{1, 10000};
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+
+    for (auto _ : state) {
+        // This code gets timed
+        FastBinomialTree<T, hn::ScalableTag<T>>::template price_mixed<kPrice>(
+            fast_op.view(), 200);
+    }
+    state.SetItemsProcessed(state.iterations() * r.num_options);
+}
+
+template <typename T>
+static void BM_FastBaroneAdesiWhaley(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r;
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+
+    for (auto _ : state) {
+        // This code gets timed
+        FastBaroneAdesiWhaley<T, hn::ScalableTag<T>>::price_mixed(
+            fast_op.view());
+    }
+    state.SetItemsProcessed(state.iterations() * r.num_options);
+}
+
+// Items are paths, 64k per option
+template <typename T>
+static void BM_FastMonteCarlo(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r{1, 16};
+    const MonteCarloSettings settings{1 << 16, 1, 1};
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+
+    for (auto _ : state) {
+        // This code gets timed
+        FastMonteCarlo<T, hn::ScalableTag<T>>::price_mixed(
+            fast_op.view(), settings);
+    }
+    state.SetItemsProcessed(
+        state.iterations() * r.num_options * settings.num_paths);
+}
+
+// Items are antithetic pairs of 32 steps, 16k per option
+template <typename T, bool ControlVariate>
+static void BM_FastMonteCarloAsian(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r{1, 16};
+    MonteCarloSettings settings{1 << 14, 32, 1, PathPayoff::kArithmeticAsian};
+    settings.antithetic = true;
+    settings.control_variate = ControlVariate;
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+
+    for (auto _ : state) {
+        // This code gets timed
+        FastMonteCarlo<T, hn::ScalableTag<T>>::price_mixed(
+            fast_op.view(), settings);
     }
+    state.SetItemsProcessed(
+        state.iterations() * r.num_options * settings.num_paths);
+}
+
+// Double columns with float CDF/PDF lanes, compare with
+// BM_FastPriceAccuracy<double/float, kExact>
+static void BM_FastPriceMixedPrecision(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<double> r;
+    OptionPricing<double> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+
+    for (auto _ : state) {
+        // This code gets timed
+        FastBlackScholes<
+            double, hn::ScalableTag<double>, Accuracy::kExact,
+            Precision::kMixed>::price_mixed(fast_op);
+    }
+    state.SetItemsProcessed(state.iterations() * r.num_options);
+}
+
+template <typename T>
+static void BM_FastPriceOnly(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r;
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, {}, kPrice);
+
+    for (auto _ : state) {
+        // This code gets timed
+        FastBlackScholes<T, hn::ScalableTag<T>>::template price<true, kPrice>(
+            fast_op);
+        FastBlackScholes<T, hn::ScalableTag<T>>::template price<false, kPrice>(
+            fast_op);
+    }
+}
+
+template <typename T>
+static void BM_ParallelPrice(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r;
+    AlignedOptionPricing<T> parallel_op;
+    CopyInputs(r, parallel_op);
+    ThreadPool pool(state.range(0));
+    const ParallelBlackScholes<T> pricer(pool);
+
+    for (auto _ : state) {
+        // This code gets timed
+        pricer.template price<true>(parallel_op);
+        pricer.template price<false>(parallel_op);
+    }
+    state.SetItemsProcessed(state.iterations() * 2 * r.num_options);
+}
+
+// Call pass, put pass and a position weighted aggregation over a batch far
+// larger than the caches, in tiles of state.range(0) options, or in one tile
+// when that is 0. dram_bytes_per_option models the traffic: a whole batch
+// pass streams every column it touches from DRAM, a tiled pipeline streams
+// each column once. Stores count twice, for the read for ownership.
+template <typename T>
+static void BM_BlockedPipeline(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r{1, 4000000};
+    AlignedOptionPricing<T> op;
+    CopyInputs(r, op);
+    PutPricing<T> put(r.num_options);
+    const std::vector<T> positions(r.underlyings.begin(), r.underlyings.end());
+    OptionResult<T> totals{};
+    const size_t tile_size =
+        state.range(0) > 0 ? state.range(0) : r.num_options;
+    BlockedBlackScholes<T> pipeline(tile_size);
+    pipeline.template add_price<true>()
+        .add_put(put.view())
+        .add_aggregate(positions, totals);
+
+    for (auto _ : state) {
+        // This code gets timed
+        pipeline.run(op);
+        benchmark::DoNotOptimize(totals);
+    }
+    state.SetItemsProcessed(state.iterations() * r.num_options);
+    // Calls: 6 inputs, 6 outputs. Puts: 6 inputs, 4 put outputs plus vegas
+    // and gammas again. Aggregation: 6 outputs and the positions.
+    const size_t columns =
+        state.range(0) > 0 ? 6 + 2 * 10 + 1 : (6 + 2 * 6) * 2 + 6 + 1;
+    state.counters["dram_bytes_per_option"] =
+        static_cast<double>(columns * sizeof(T));
+}
+
+template <typename T>
+static std::vector<OptionRecord<T>> ToRecords(const RandomInput<T>& r)
+{
+    std::vector<OptionRecord<T>> records(r.num_options);
+    for (size_t i = 0; i < r.num_options; ++i) {
+        records[i] = {r.underlyings[i],     r.strikes[i],
+                      r.risk_free_rates[i], r.volatilities[i],
+                      r.times_to_expiry[i], r.dividend_yields[i],
+                      r.option_types[i],    0};
+    }
+    return records;
+}
+
+// The per-field loop a struct based feed would otherwise run
+template <typename T>
+static void BM_IngestRecordsScalar(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r{1, 1000000};
+    const std::vector<OptionRecord<T>> records = ToRecords(r);
+    AlignedOptionPricing<T> op(records.size());
+
+    for (auto _ : state) {
+        // This code gets timed
+        for (size_t i = 0; i < records.size(); ++i) {
+            op.underlyings()[i] = records[i].underlying;
+            op.strikes()[i] = records[i].strike;
+            op.risk_free_rates()[i] = records[i].risk_free_rate;
+            op.volatilities()[i] = records[i].volatility;
+            op.times_to_expiry()[i] = records[i].time_to_expiry;
+            op.dividend_yields()[i] = records[i].dividend_yield;
+            op.option_types()[i] = records[i].option_type;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * records.size());
+}
+
+template <typename T>
+static void BM_IngestRecords(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r{1, 1000000};
+    const std::vector<OptionRecord<T>> records = ToRecords(r);
+    AlignedOptionPricing<T> op(records.size());
+
+    for (auto _ : state) {
+        // This code gets timed
+        FastOptionRecords<T, hn::ScalableTag<T>>::ingest(records, op);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * records.size());
+}
+
+template <typename T>
+static void BM_WriteResults(benchmark::State& state)
+{
+    // Perform setup here
+    RandomInput<T> r{1, 1000000};
+    AlignedOptionPricing<T> op(r.num_options);
+    CopyInputs(r, op);
+    FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(op);
+    std::vector<OptionResult<T>> results(r.num_options);
+
+    for (auto _ : state) {
+        // This code gets timed
+        FastOptionRecords<T, hn::ScalableTag<T>>::write_results(op, results);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * r.num_options);
+}
+
+// Market prices of a random mixed book, to invert back into volatilities
+template <typename T>
+struct RandomQuotes
+{
+    explicit RandomQuotes(size_t num_options)
+        : input(1, num_options),
+          pricing(
+              input.underlyings, input.strikes, input.risk_free_rates,
+              input.volatilities, input.times_to_expiry, input.dividend_yields,
+              input.option_types),
+          volatilities(num_options, 0)
+    {
+        FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(pricing);
+    }
+
+    [[nodiscard]] ImpliedVolatilityView<T> view()
+    {
+        return {pricing.prices,          input.underlyings,
+                input.strikes,           input.risk_free_rates,
+                input.times_to_expiry,   input.dividend_yields,
+                volatilities,            input.option_types};
+    }
+
+    RandomInput<T> input;
+    OptionPricing<T> pricing;
+    std::vector<T> volatilities;
+};
+
+template <typename T>
+static void BM_NaiveImpliedVolatility(benchmark::State& state)
+{
+    // Perform setup here
+    RandomQuotes<T> q{1000000};
+
+    for (auto _ : state) {
+        // This code gets timed
+        NaiveBlackScholes<T>::implied_volatility(q.view());
+    }
+    state.SetItemsProcessed(state.iterations() * q.input.num_options);
+}
+
+template <typename T>
+static void BM_FastImpliedVolatility(benchmark::State& state)
+{
+    // Perform setup here
+    RandomQuotes<T> q{1000000};
+
+    for (auto _ : state) {
+        // This code gets timed
+        FastImpliedVolatility<T, hn::ScalableTag<T>>::implied_volatility(
+            q.view());
+    }
+    state.SetItemsProcessed(state.iterations() * q.input.num_options);
+}
+
+BENCHMARK(BM_FastPrice<double>);
+BENCHMARK(BM_FastPriceAligned<double>);
+BENCHMARK(BM_NaivePrice<double>);
+BENCHMARK(BM_DynamicPrice<double>);
+BENCHMARK(BM_FastPriceCallPut<double>);
+BENCHMARK(BM_FastPriceMixed<double>);
+BENCHMARK(BM_FastPriceOnly<double>);
+BENCHMARK(BM_FastPrice<float>);
+BENCHMARK(BM_FastPriceAligned<float>);
+BENCHMARK(BM_NaivePrice<float>);
+BENCHMARK(BM_DynamicPrice<float>);
+BENCHMARK(BM_FastPriceCallPut<float>);
+BENCHMARK(BM_FastPriceMixed<float>);
+BENCHMARK(BM_FastPriceBucketed<double>);
+BENCHMARK(BM_FastPriceBucketed<float>);
+BENCHMARK_TEMPLATE(BM_FastPriceChain, double, false);
+BENCHMARK_TEMPLATE(BM_FastPriceChain, double, true);
+BENCHMARK_TEMPLATE(BM_FastPriceChain, float, false);
+BENCHMARK_TEMPLATE(BM_FastPriceChain, float, true);
+BENCHMARK(BM_FastPriceOnly<float>);
+BENCHMARK_TEMPLATE(BM_FastPriceAccuracy, double, Accuracy::kExact);
+BENCHMARK_TEMPLATE(BM_FastPriceAccuracy, double, Accuracy::kFast);
+BENCHMARK_TEMPLATE(BM_FastPriceAccuracy, double, Accuracy::kFastest);
+BENCHMARK_TEMPLATE(BM_FastPriceAccuracy, float, Accuracy::kExact);
+BENCHMARK_TEMPLATE(BM_FastPriceAccuracy, float, Accuracy::kFast);
+BENCHMARK_TEMPLATE(BM_FastPriceAccuracy, float, Accuracy::kFastest);
+BENCHMARK(BM_FastPriceMixedPrecision);
+BENCHMARK_TEMPLATE(BM_FastPriceStores, double, Stores::kCached);
+BENCHMARK_TEMPLATE(BM_FastPriceStores, double, Stores::kStreaming);
+BENCHMARK_TEMPLATE(BM_FastPriceStores, float, Stores::kCached);
+BENCHMARK_TEMPLATE(BM_FastPriceStores, float, Stores::kStreaming);
+BENCHMARK(BM_IngestRecordsScalar<double>);
+BENCHMARK(BM_IngestRecords<double>);
+BENCHMARK(BM_WriteResults<double>);
+BENCHMARK(BM_IngestRecordsScalar<float>);
+BENCHMARK(BM_IngestRecords<float>);
+BENCHMARK(BM_WriteResults<float>);
+BENCHMARK(BM_NaiveImpliedVolatility<double>);
+BENCHMARK(BM_FastImpliedVolatility<double>);
+BENCHMARK(BM_NaiveImpliedVolatility<float>);
+BENCHMARK(BM_FastImpliedVolatility<float>);
+// Scaling with the number of threads, until memory bandwidth saturates
+BENCHMARK(BM_ParallelPrice<double>)
+    ->RangeMultiplier(2)
+    ->Range(1, ThreadPool::default_num_threads())
+    ->UseRealTime();
+BENCHMARK(BM_ParallelPrice<float>)
+    ->RangeMultiplier(2)
+    ->Range(1, ThreadPool::default_num_threads())
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_FastSpotTick, double, false);
+BENCHMARK_TEMPLATE(BM_FastSpotTick, double, true);
+BENCHMARK_TEMPLATE(BM_FastSpotTick, float, false);
+BENCHMARK_TEMPLATE(BM_FastSpotTick, float, true);
+BENCHMARK(BM_FastBinomialTree<double>);
+BENCHMARK(BM_FastBinomialTree<float>);
+BENCHMARK(BM_FastBaroneAdesiWhaley<double>);
+BENCHMARK(BM_FastBaroneAdesiWhaley<float>);
+BENCHMARK(BM_FastMonteCarlo<double>);
+BENCHMARK(BM_FastMonteCarlo<float>);
+BENCHMARK(BM_FastMonteCarloAsian<double, false>);
+BENCHMARK(BM_FastMonteCarloAsian<double, true>);
+BENCHMARK(BM_FastMonteCarloAsian<float, true>);
+BENCHMARK_TEMPLATE(BM_ScenarioGrid, double, false);
+BENCHMARK_TEMPLATE(BM_ScenarioGrid, double, true);
+BENCHMARK_TEMPLATE(BM_ScenarioGrid, float, false);
+BENCHMARK_TEMPLATE(BM_ScenarioGrid, float, true);
+// Percent of the book changed per cycle
+BENCHMARK(BM_FastRepriceDirty<double>)->Arg(1)->Arg(10);
+BENCHMARK(BM_FastRepriceDirty<float>)->Arg(1)->Arg(10);
+// The whole batch per stage vs. L2 sized tiles
+BENCHMARK(BM_BlockedPipeline<double>)->Arg(0)->Arg(2048);
+BENCHMARK(BM_BlockedPipeline<float>)->Arg(0)->Arg(4096);
+// Lane multiples vs. sizes that need a partial last vector
+BENCHMARK(BM_FastPriceSize<double>)->Arg(1024)->Arg(1027)->Arg(1000003);
+BENCHMARK(BM_FastPriceSize<float>)->Arg(1024)->Arg(1031)->Arg(1000003);
+
+TEST(BlackScholesTestDouble, ComparePrice)
+{
+    // Assign
+    using T = double;
+    RandomInput<T> r{};
+    OptionPricing<T> fast_op_call(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    OptionPricing<T> fast_op_put(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    OptionPricing<T> naive_op_call(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    OptionPricing<T> naive_op_put(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+
+    // Act
+    FastBlackScholes<T, hn::ScalableTag<T>>::price<true>(fast_op_call);
+    NaiveBlackScholes<T>::price<true>(naive_op_call);
+    FastBlackScholes<T, hn::ScalableTag<T>>::price<false>(fast_op_put);
+    NaiveBlackScholes<T>::price<false>(naive_op_put);
+
+    // Assert
+    EXPECT_EQ(fast_op_call.prices.size(), naive_op_call.prices.size());
+    EXPECT_EQ(fast_op_call.deltas.size(), naive_op_call.deltas.size());
+    EXPECT_EQ(fast_op_call.vegas.size(), naive_op_call.vegas.size());
+    EXPECT_EQ(fast_op_call.thetas.size(), naive_op_call.thetas.size());
+    EXPECT_EQ(fast_op_call.gammas.size(), naive_op_call.gammas.size());
+    EXPECT_EQ(fast_op_call.rhos.size(), naive_op_call.rhos.size());
+    EXPECT_EQ(fast_op_put.prices.size(), naive_op_put.prices.size());
+    EXPECT_EQ(fast_op_put.deltas.size(), naive_op_put.deltas.size());
+    EXPECT_EQ(fast_op_put.vegas.size(), naive_op_put.vegas.size());
+    EXPECT_EQ(fast_op_put.thetas.size(), naive_op_put.thetas.size());
+    EXPECT_EQ(fast_op_put.gammas.size(), naive_op_put.gammas.size());
+    EXPECT_EQ(fast_op_put.rhos.size(), naive_op_put.rhos.size());
+    for (auto i = 0; i < fast_op_call.prices.size(); ++i) {
+        EXPECT_NEAR(fast_op_call.prices[i], naive_op_call.prices[i], 1e-5);
+        EXPECT_NEAR(fast_op_call.deltas[i], naive_op_call.deltas[i], 1e-5);
+        EXPECT_NEAR(fast_op_call.vegas[i], naive_op_call.vegas[i], 1e-5);
+        EXPECT_NEAR(fast_op_call.thetas[i], naive_op_call.thetas[i], 1e-5);
+        EXPECT_NEAR(fast_op_call.gammas[i], naive_op_call.gammas[i], 1e-5);
+        EXPECT_NEAR(fast_op_call.rhos[i], naive_op_call.rhos[i], 1e-5);
+        EXPECT_NEAR(fast_op_put.prices[i], naive_op_put.prices[i], 1e-5);
+        EXPECT_NEAR(fast_op_put.deltas[i], naive_op_put.deltas[i], 1e-5);
+        EXPECT_NEAR(fast_op_put.vegas[i], naive_op_put.vegas[i], 1e-5);
+        EXPECT_NEAR(fast_op_put.thetas[i], naive_op_put.thetas[i], 1e-5);
+        EXPECT_NEAR(fast_op_put.gammas[i], naive_op_put.gammas[i], 1e-5);
+        EXPECT_NEAR(fast_op_put.rhos[i], naive_op_put.rhos[i], 1e-5);
+    }
+}
+
+TEST(BlackScholesTestFloat, CompareFloatDouble)
+{
+    // Assign
+    RandomInput<double> r1{};
+    OptionPricing<double> fast_op_double(
+        r1.underlyings, r1.strikes, r1.risk_free_rates, r1.volatilities,
+        r1.times_to_expiry, r1.dividend_yields);
+    OptionPricing<double> naive_op_double(
+        r1.underlyings, r1.strikes, r1.risk_free_rates, r1.volatilities,
+        r1.times_to_expiry, r1.dividend_yields);
+    RandomInput<float> r2{};
+    OptionPricing<float> fast_op_float(
+        r2.underlyings, r2.strikes, r2.risk_free_rates, r2.volatilities,
+        r2.times_to_expiry, r2.dividend_yields);
+    OptionPricing<float> naive_op_float(
+        r2.underlyings, r2.strikes, r2.risk_free_rates, r2.volatilities,
+        r2.times_to_expiry, r2.dividend_yields);
+
+    // Act
+    FastBlackScholes<double, hn::ScalableTag<double>>::price<true>(
+        fast_op_double);
+    FastBlackScholes<float, hn::ScalableTag<float>>::price<true>(fast_op_float);
+    FastBlackScholes<double, hn::ScalableTag<double>>::price<true>(
+        naive_op_double);
+    FastBlackScholes<float, hn::ScalableTag<float>>::price<true>(
+        naive_op_float);
+
+    // Assert
+    EXPECT_EQ(fast_op_double.prices.size(), fast_op_float.prices.size());
+    EXPECT_EQ(fast_op_double.prices.size(), naive_op_double.prices.size());
+    EXPECT_EQ(fast_op_double.prices.size(), naive_op_float.prices.size());
+    EXPECT_EQ(fast_op_double.deltas.size(), fast_op_float.deltas.size());
+    EXPECT_EQ(fast_op_double.deltas.size(), naive_op_double.deltas.size());
+    EXPECT_EQ(fast_op_double.deltas.size(), naive_op_float.deltas.size());
+    for (auto i = 0; i < fast_op_double.prices.size(); ++i) {
+        EXPECT_NEAR(fast_op_double.prices[i], fast_op_float.prices[i], 1e-2);
+        EXPECT_NEAR(fast_op_double.prices[i], naive_op_double.prices[i], 1e-2);
+        EXPECT_NEAR(fast_op_double.prices[i], naive_op_float.prices[i], 1e-2);
+        EXPECT_NEAR(fast_op_double.deltas[i], fast_op_float.deltas[i], 1e-2);
+        EXPECT_NEAR(fast_op_double.deltas[i], naive_op_double.deltas[i], 1e-2);
+        EXPECT_NEAR(fast_op_double.deltas[i], naive_op_float.deltas[i], 1e-2);
+    }
+}
+
+// Prices a random mixed book at accuracy A and compares it with the exact
+// tier: prices relative to max(S, K), greeks to max(1, |exact|)
+template <typename T, Accuracy A>
+static void ExpectAccuracyTierMatchesExact(
+    T price_tolerance, T greek_tolerance)
+{
+    // Assign
+    RandomInput<T> r{1, 100003};
+    OptionPricing<T> exact(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    OptionPricing<T> approx(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+
+    // Act
+    FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(exact);
+    FastBlackScholes<T, hn::ScalableTag<T>, A>::price_mixed(approx);
+
+    // Assert
+    const auto expect_greek_near = [&](const std::vector<T>& expected,
+                                       const std::vector<T>& actual) {
+        for (auto i = 0; i < r.num_options; ++i) {
+            EXPECT_NEAR(
+                actual[i], expected[i],
+                greek_tolerance * std::max<T>(1, std::abs(expected[i])))
+                << "index " << i;
+        }
+    };
+    for (auto i = 0; i < r.num_options; ++i) {
+        EXPECT_NEAR(
+            approx.prices[i], exact.prices[i],
+            price_tolerance * std::max(r.underlyings[i], r.strikes[i]))
+            << "index " << i;
+    }
+    expect_greek_near(exact.deltas, approx.deltas);
+    expect_greek_near(exact.vegas, approx.vegas);
+    expect_greek_near(exact.thetas, approx.thetas);
+    expect_greek_near(exact.gammas, approx.gammas);
+    expect_greek_near(exact.rhos, approx.rhos);
+}
+
+TEST(BlackScholesTestDouble, AccuracyTiersMatchExact)
+{
+    ExpectAccuracyTierMatchesExact<double, Accuracy::kFast>(2e-7, 2e-6);
+    ExpectAccuracyTierMatchesExact<double, Accuracy::kFastest>(3e-5, 1e-4);
+}
+
+TEST(BlackScholesTestFloat, AccuracyTiersMatchExact)
+{
+    ExpectAccuracyTierMatchesExact<float, Accuracy::kFast>(5e-7, 5e-6);
+    ExpectAccuracyTierMatchesExact<float, Accuracy::kFastest>(3e-5, 1e-4);
+}
+
+TEST(BlackScholesTestDouble, MixedPrecisionMatchesNaive)
+{
+    // Assign: a random book, with deep in the money long dated calls and
+    // puts at the front, where float only pricing drifts most
+    RandomInput<double> r{1, 100003};
+    for (auto i = 0; i < 1000; ++i) {
+        r.underlyings[i] = 400 + i % 100;
+        r.strikes[i] = 5 + i % 50;
+        r.times_to_expiry[i] = 5 + i % 25;
+        r.option_types[i] = OptionType<double>::kCall;
+        r.underlyings[1000 + i] = 5 + i % 50;
+        r.strikes[1000 + i] = 400 + i % 100;
+        r.times_to_expiry[1000 + i] = 5 + i % 25;
+        r.option_types[1000 + i] = OptionType<double>::kPut;
+    }
+    OptionPricing<double> naive(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    OptionPricing<double> mixed(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+
+    // Act
+    NaiveBlackScholes<double>::price_mixed(naive);
+    FastBlackScholes<
+        double, hn::ScalableTag<double>, Accuracy::kExact,
+        Precision::kMixed>::price_mixed(mixed);
+
+    // Assert: prices relative to max(S, K), greeks to max(1, |greek|)
+    const auto expect_greek_near = [&](const std::vector<double>& expected,
+                                       const std::vector<double>& actual) {
+        for (auto i = 0; i < r.num_options; ++i) {
+            EXPECT_NEAR(
+                actual[i], expected[i],
+                1e-6 * std::max(1.0, std::abs(expected[i])))
+                << "index " << i;
+        }
+    };
+    for (auto i = 0; i < r.num_options; ++i) {
+        EXPECT_NEAR(
+            mixed.prices[i], naive.prices[i],
+            1e-7 * std::max(r.underlyings[i], r.strikes[i]))
+            << "index " << i;
+    }
+    expect_greek_near(naive.deltas, mixed.deltas);
+    expect_greek_near(naive.vegas, mixed.vegas);
+    expect_greek_near(naive.thetas, mixed.thetas);
+    expect_greek_near(naive.gammas, mixed.gammas);
+    expect_greek_near(naive.rhos, mixed.rhos);
+}
+
+template <typename T>
+static void ExpectMatchesNaiveForEverySize(T tolerance)
+{
+    const size_t lanes = hn::Lanes(hn::ScalableTag<T>());
+    for (size_t num_options = 0; num_options <= 4 * lanes + 1; ++num_options) {
+        // Assign
+        RandomInput<T> r{1, num_options};
+        OptionPricing<T> fast_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields);
+        OptionPricing<T> naive_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields);
+
+        // Act
+        FastBlackScholes<T, hn::ScalableTag<T>>::template price<false>(
+            fast_op);
+        NaiveBlackScholes<T>::template price<false>(naive_op);
+
+        // Assert
+        for (auto i = 0; i < num_options; ++i) {
+            EXPECT_NEAR(fast_op.prices[i], naive_op.prices[i], tolerance)
+                << num_options << " options, index " << i;
+            EXPECT_NEAR(fast_op.deltas[i], naive_op.deltas[i], tolerance);
+            EXPECT_NEAR(fast_op.gammas[i], naive_op.gammas[i], tolerance);
+            EXPECT_NEAR(fast_op.vegas[i], naive_op.vegas[i], tolerance);
+            EXPECT_NEAR(fast_op.rhos[i], naive_op.rhos[i], tolerance);
+            EXPECT_NEAR(fast_op.thetas[i], naive_op.thetas[i], tolerance);
+        }
+    }
+}
+
+TEST(BlackScholesTestDouble, ArbitraryBatchSizes)
+{
+    ExpectMatchesNaiveForEverySize<double>(1e-5);
+}
+
+TEST(BlackScholesTestFloat, ArbitraryBatchSizes)
+{
+    ExpectMatchesNaiveForEverySize<float>(1e-2);
+}
+
+TEST(BlackScholesTestDouble, PriceCallPutMatchesSeparateLegs)
+{
+    // Assign
+    using T = double;
+    RandomInput<T> r{1, 100003};
+    OptionPricing<T> call_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    OptionPricing<T> put_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    PutPricing<T> fast_put(r.num_options);
+    OptionPricing<T> dynamic_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    PutPricing<T> dynamic_put(r.num_options);
+
+    // Act
+    NaiveBlackScholes<T>::price<true>(call_op);
+    NaiveBlackScholes<T>::price<false>(put_op);
+    FastBlackScholes<T, hn::ScalableTag<T>>::price_call_put(fast_op, fast_put);
+    DynamicBlackScholes<T>::price_call_put(dynamic_op, dynamic_put);
+
+    // Assert
+    for (auto i = 0; i < r.num_options; ++i) {
+        for (const auto* op : {&fast_op, &dynamic_op}) {
+            EXPECT_NEAR(op->prices[i], call_op.prices[i], 1e-5);
+            EXPECT_NEAR(op->deltas[i], call_op.deltas[i], 1e-5);
+            EXPECT_NEAR(op->rhos[i], call_op.rhos[i], 1e-5);
+            EXPECT_NEAR(op->thetas[i], call_op.thetas[i], 1e-5);
+            EXPECT_NEAR(op->gammas[i], call_op.gammas[i], 1e-5);
+            EXPECT_NEAR(op->vegas[i], call_op.vegas[i], 1e-5);
+        }
+        for (const auto* put : {&fast_put, &dynamic_put}) {
+            EXPECT_NEAR(put->prices[i], put_op.prices[i], 1e-5);
+            EXPECT_NEAR(put->deltas[i], put_op.deltas[i], 1e-5);
+            EXPECT_NEAR(put->rhos[i], put_op.rhos[i], 1e-5);
+            EXPECT_NEAR(put->thetas[i], put_op.thetas[i], 1e-5);
+        }
+    }
+}
+
+template <typename T>
+static void ExpectMixedMatchesLegs(size_t num_options, T tolerance)
+{
+    // Assign
+    RandomInput<T> r{1, num_options};
+    OptionPricing<T> call_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    OptionPricing<T> put_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    OptionPricing<T> naive_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    OptionPricing<T> dynamic_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    AlignedOptionPricing<T> aligned_op;
+    CopyInputs(r, aligned_op);
+
+    // Act
+    NaiveBlackScholes<T>::template price<true>(call_op);
+    NaiveBlackScholes<T>::template price<false>(put_op);
+    NaiveBlackScholes<T>::price_mixed(naive_op);
+    FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(fast_op);
+    DynamicBlackScholes<T>::price_mixed(dynamic_op);
+    FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(aligned_op);
+
+    // Assert
+    for (auto i = 0; i < num_options; ++i) {
+        const OptionPricing<T>& leg =
+            r.option_types[i] == OptionType<T>::kCall ? call_op : put_op;
+        for (const auto* op : {&naive_op, &fast_op, &dynamic_op}) {
+            EXPECT_NEAR(op->prices[i], leg.prices[i], tolerance)
+                << num_options << " options, index " << i;
+            EXPECT_NEAR(op->deltas[i], leg.deltas[i], tolerance);
+            EXPECT_NEAR(op->rhos[i], leg.rhos[i], tolerance);
+            EXPECT_NEAR(op->thetas[i], leg.thetas[i], tolerance);
+            EXPECT_NEAR(op->gammas[i], leg.gammas[i], tolerance);
+            EXPECT_NEAR(op->vegas[i], leg.vegas[i], tolerance);
+        }
+        EXPECT_NEAR(aligned_op.prices()[i], leg.prices[i], tolerance);
+        EXPECT_NEAR(aligned_op.deltas()[i], leg.deltas[i], tolerance);
+        EXPECT_NEAR(aligned_op.rhos()[i], leg.rhos[i], tolerance);
+    }
+}
+
+TEST(BlackScholesTestDouble, PriceMixedBook)
+{
+    const size_t lanes = hn::Lanes(hn::ScalableTag<double>());
+    for (const size_t num_options :
+         {lanes - 1, 4 * lanes + 1, size_t{100003}}) {
+        ExpectMixedMatchesLegs<double>(num_options, 1e-5);
+    }
+}
+
+TEST(BlackScholesTestFloat, PriceMixedBook)
+{
+    const size_t lanes = hn::Lanes(hn::ScalableTag<float>());
+    for (const size_t num_options :
+         {lanes - 1, 4 * lanes + 1, size_t{100003}}) {
+        ExpectMixedMatchesLegs<float>(num_options, 1e-2);
+    }
+}
+
+TEST(BlackScholesTestDouble, SelectedOutputsOnly)
+{
+    // Assign
+    using T = double;
+    using Fast = FastBlackScholes<T, hn::ScalableTag<T>>;
+    constexpr uint32_t kOutputs = kDelta | kGamma;
+    RandomInput<T> r{1, 100003};
+    OptionPricing<T> full_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    OptionPricing<T> price_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, {}, kPrice);
+    OptionPricing<T> greek_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, {}, kOutputs);
+    OptionPricing<T> call_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, {}, kPrice);
+    PutPricing<T> put(r.num_options, kPrice);
+
+    // Act
+    Fast::price<false>(full_op);
+    Fast::price<false, kPrice>(price_op);
+    Fast::price<false, kOutputs>(greek_op);
+    Fast::price_call_put<kPrice>(call_op, put);
+
+    // Assert
+    EXPECT_EQ(price_op.prices.size(), r.num_options);
+    EXPECT_TRUE(price_op.deltas.empty());
+    EXPECT_TRUE(price_op.vegas.empty());
+    EXPECT_TRUE(price_op.thetas.empty());
+    EXPECT_TRUE(price_op.gammas.empty());
+    EXPECT_TRUE(price_op.rhos.empty());
+    EXPECT_TRUE(greek_op.prices.empty());
+    EXPECT_TRUE(greek_op.rhos.empty());
+    EXPECT_TRUE(put.deltas.empty());
+    for (auto i = 0; i < r.num_options; ++i) {
+        EXPECT_NEAR(price_op.prices[i], full_op.prices[i], 1e-9);
+        EXPECT_NEAR(greek_op.deltas[i], full_op.deltas[i], 1e-9);
+        EXPECT_NEAR(greek_op.gammas[i], full_op.gammas[i], 1e-9);
+        EXPECT_NEAR(put.prices[i], full_op.prices[i], 1e-9);
+    }
+}
+
+TEST(BlackScholesTestDouble, ThetaMatchesFiniteDifference)
+{
+    // Assign
+    using T = double;
+    constexpr T h = 1e-5;
+    RandomInput<T> r{1, 10003};
+    // Keep well away from expiry for the difference
+    for (auto& t : r.times_to_expiry) {
+        t = std::max(t, 0.1);
+    }
+    std::vector<T> earlier = r.times_to_expiry;
+    std::vector<T> later = r.times_to_expiry;
+    for (auto i = 0; i < r.num_options; ++i) {
+        earlier[i] -= h;
+        later[i] += h;
+    }
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    PutPricing<T> fast_put(r.num_options);
+    OptionPricing<T> naive_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    PutPricing<T> naive_put(r.num_options);
+    OptionPricing<T> earlier_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities, earlier,
+        r.dividend_yields);
+    PutPricing<T> earlier_put(r.num_options);
+    OptionPricing<T> later_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities, later,
+        r.dividend_yields);
+    PutPricing<T> later_put(r.num_options);
+
+    // Act
+    FastBlackScholes<T, hn::ScalableTag<T>>::price_call_put(fast_op, fast_put);
+    NaiveBlackScholes<T>::price_call_put(naive_op, naive_put);
+    NaiveBlackScholes<T>::price_call_put<kPrice>(earlier_op, earlier_put);
+    NaiveBlackScholes<T>::price_call_put<kPrice>(later_op, later_put);
+
+    // Assert: theta is per calendar day, and time to expiry runs backwards
+    for (auto i = 0; i < r.num_options; ++i) {
+        const T call_theta =
+            (earlier_op.prices[i] - later_op.prices[i]) / (2 * h * 365);
+        const T put_theta =
+            (earlier_put.prices[i] - later_put.prices[i]) / (2 * h * 365);
+        EXPECT_NEAR(fast_op.thetas[i], call_theta, 1e-6) << "index " << i;
+        EXPECT_NEAR(fast_put.thetas[i], put_theta, 1e-6) << "index " << i;
+        EXPECT_NEAR(naive_op.thetas[i], call_theta, 1e-6) << "index " << i;
+        EXPECT_NEAR(naive_put.thetas[i], put_theta, 1e-6) << "index " << i;
+    }
+}
+
+TEST(BlackScholesTestDouble, GammaMatchesFiniteDifference)
+{
+    // Assign: central difference of the delta over a relative bump of the
+    // underlying
+    using T = double;
+    constexpr T h = 1e-5;
+    RandomInput<T> r{1, 10003};
+    // Keep well away from expiry, where gamma is too peaked for the difference
+    for (auto& t : r.times_to_expiry) {
+        t = std::max(t, 0.1);
+    }
+    std::vector<T> lower = r.underlyings;
+    std::vector<T> upper = r.underlyings;
+    for (auto i = 0; i < r.num_options; ++i) {
+        lower[i] *= 1 - h;
+        upper[i] *= 1 + h;
+    }
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    OptionPricing<T> naive_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    OptionPricing<T> lower_op(
+        lower, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, {}, kDelta);
+    OptionPricing<T> upper_op(
+        upper, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, {}, kDelta);
+
+    // Act
+    FastBlackScholes<T, hn::ScalableTag<T>>::price(fast_op);
+    NaiveBlackScholes<T>::price(naive_op);
+    NaiveBlackScholes<T>::price<true, kDelta>(lower_op);
+    NaiveBlackScholes<T>::price<true, kDelta>(upper_op);
+
+    // Assert
+    for (auto i = 0; i < r.num_options; ++i) {
+        const T gamma = (upper_op.deltas[i] - lower_op.deltas[i]) /
+                        (2 * h * r.underlyings[i]);
+        const T tolerance = 1e-6 * (1 + std::abs(gamma));
+        EXPECT_NEAR(fast_op.gammas[i], gamma, tolerance) << "index " << i;
+        EXPECT_NEAR(naive_op.gammas[i], gamma, tolerance) << "index " << i;
+    }
+}
+
+template <typename T>
+static void ExpectIntrinsicAtExpiryAndZeroVolatility(T tolerance)
+{
+    // Assign: d1 is +-inf at T = 0 and at sigma = 0, where the price is the
+    // payoff on the discounted underlying and strike
+    RandomInput<T> r{1, 1001};
+    for (auto i = 0; i < r.num_options; ++i) {
+        if (i % 2 == 0) {
+            r.times_to_expiry[i] = 0;
+        } else {
+            r.volatilities[i] = 0;
+        }
+    }
+    OptionPricing<T> call(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, {}, kPrice | kDelta);
+    OptionPricing<T> put(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, {}, kPrice | kDelta);
+
+    // Act
+    FastBlackScholes<T, hn::ScalableTag<T>>::template price<
+        true, kPrice | kDelta>(call);
+    FastBlackScholes<T, hn::ScalableTag<T>>::template price<
+        false, kPrice | kDelta>(put);
+
+    // Assert
+    for (auto i = 0; i < r.num_options; ++i) {
+        const T forward =
+            r.underlyings[i] *
+            std::exp(-r.dividend_yields[i] * r.times_to_expiry[i]);
+        const T discounted_strike =
+            r.strikes[i] *
+            std::exp(-r.risk_free_rates[i] * r.times_to_expiry[i]);
+        const T scale = std::max(r.underlyings[i], r.strikes[i]);
+        EXPECT_NEAR(
+            call.prices[i], std::max<T>(forward - discounted_strike, 0),
+            tolerance * scale)
+            << "index " << i;
+        EXPECT_NEAR(
+            put.prices[i], std::max<T>(discounted_strike - forward, 0),
+            tolerance * scale)
+            << "index " << i;
+        EXPECT_TRUE(std::isfinite(call.deltas[i])) << "index " << i;
+        EXPECT_TRUE(std::isfinite(put.deltas[i])) << "index " << i;
+    }
+}
+
+TEST(BlackScholesTestDouble, IntrinsicAtExpiryAndZeroVolatility)
+{
+    ExpectIntrinsicAtExpiryAndZeroVolatility<double>(1e-12);
+}
+
+TEST(BlackScholesTestFloat, IntrinsicAtExpiryAndZeroVolatility)
+{
+    ExpectIntrinsicAtExpiryAndZeroVolatility<float>(1e-5);
+}
+
+TEST(BlackScholesTestDouble, ParallelMatchesSerial)
+{
+    // Assign
+    using T = double;
+    RandomInput<T> r{1, 100003};
+    OptionPricing<T> serial_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    PutPricing<T> serial_put(r.num_options);
+    DynamicBlackScholes<T>::price_call_put(serial_op, serial_put);
+    OptionPricing<T> serial_mixed_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    DynamicBlackScholes<T>::price_mixed(serial_mixed_op);
+
+    for (const size_t num_threads : {1, 3, 8}) {
+        ThreadPool pool(num_threads);
+        // Small chunks so that every thread gets many, the last one partial
+        const ParallelBlackScholes<T> pricer(pool, 1000);
+        OptionPricing<T> call_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields);
+        OptionPricing<T> call_put_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields);
+        PutPricing<T> put(r.num_options);
+        OptionPricing<T> mixed_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types);
+        AlignedOptionPricing<T> aligned_op;
+        CopyInputs(r, aligned_op);
+
+        // Act
+        pricer.price<true>(call_op);
+        pricer.price_call_put(call_put_op, put);
+        pricer.price_mixed(mixed_op);
+        pricer.price<true>(aligned_op);
+
+        // Assert
+        EXPECT_EQ(pricer.chunk_size() % (HWY_ALIGNMENT / sizeof(T)), 0);
+        for (auto i = 0; i < r.num_options; ++i) {
+            EXPECT_NEAR(call_op.prices[i], serial_op.prices[i], 1e-9)
+                << num_threads << " threads, index " << i;
+            EXPECT_NEAR(call_op.thetas[i], serial_op.thetas[i], 1e-9);
+            EXPECT_NEAR(call_put_op.prices[i], serial_op.prices[i], 1e-9);
+            EXPECT_NEAR(call_put_op.vegas[i], serial_op.vegas[i], 1e-9);
+            EXPECT_NEAR(put.prices[i], serial_put.prices[i], 1e-9);
+            EXPECT_NEAR(put.rhos[i], serial_put.rhos[i], 1e-9);
+            EXPECT_NEAR(mixed_op.prices[i], serial_mixed_op.prices[i], 1e-9);
+            EXPECT_NEAR(mixed_op.deltas[i], serial_mixed_op.deltas[i], 1e-9);
+            EXPECT_NEAR(aligned_op.prices()[i], serial_op.prices[i], 1e-9);
+            EXPECT_NEAR(aligned_op.gammas()[i], serial_op.gammas[i], 1e-9);
+        }
+    }
+}
+
+TEST(BlackScholesTestDouble, DynamicAndParallelPriceOnly)
+{
+    // Assign
+    using T = double;
+    RandomInput<T> r{1, 10007};
+    OptionPricing<T> expected_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    PutPricing<T> expected_put(r.num_options);
+    DynamicBlackScholes<T>::price_call_put(expected_op, expected_put);
+    OptionPricing<T> expected_mixed_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    DynamicBlackScholes<T>::price_mixed(expected_mixed_op);
+    const auto price_only = [&] {
+        return OptionPricing<T>(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+    };
+    OptionPricing<T> dynamic_op = price_only();
+    OptionPricing<T> dynamic_mixed_op = price_only();
+    OptionPricing<T> parallel_op = price_only();
+    PutPricing<T> parallel_put(r.num_options, kPrice);
+    ThreadPool pool(3);
+    const ParallelBlackScholes<T> pricer(pool, 1000);
+
+    // Act
+    DynamicBlackScholes<T>::price<true, kPrice>(dynamic_op);
+    DynamicBlackScholes<T>::price_mixed<kPrice>(dynamic_mixed_op);
+    pricer.price_call_put<kPrice>(parallel_op, parallel_put);
+
+    // Assert
+    for (auto i = 0; i < r.num_options; ++i) {
+        EXPECT_NEAR(dynamic_op.prices[i], expected_op.prices[i], 1e-9)
+            << "index " << i;
+        EXPECT_NEAR(
+            dynamic_mixed_op.prices[i], expected_mixed_op.prices[i], 1e-9);
+        EXPECT_NEAR(parallel_op.prices[i], expected_op.prices[i], 1e-9);
+        EXPECT_NEAR(parallel_put.prices[i], expected_put.prices[i], 1e-9);
+    }
+}
+
+TEST(BlackScholesTestDouble, DynamicAndParallelAbortOnMissingOutputs)
+{
+    // Assign
+    using T = double;
+    RandomInput<T> r{1, 1001};
+    OptionPricing<T> op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+    OptionPricing<T> all_outputs_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    PutPricing<T> put(r.num_options, kPrice);
+    ThreadPool pool(2);
+    const ParallelBlackScholes<T> pricer(pool);
+
+    // Re-executes the test binary instead of forking a process with threads
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+
+    // Act, Assert: the columns only hold prices
+    EXPECT_DEATH(DynamicBlackScholes<T>::price(op), "columns hold fewer");
+    EXPECT_DEATH(
+        DynamicBlackScholes<T>::price_american(op.view()),
+        "columns hold fewer");
+    EXPECT_DEATH(pricer.price_mixed(op), "columns hold fewer");
+    EXPECT_DEATH(
+        pricer.price_call_put(all_outputs_op, put), "columns hold fewer");
+}
+
+// Whether a quote lies outside the prices at zero and infinite volatility,
+// up to rounding
+template <typename T>
+static bool outside_volatility_bounds(
+    const RandomInput<T>& r, size_t i, T quote)
+{
+    const T t = r.times_to_expiry[i];
+    const T underlying = r.underlyings[i] * std::exp(-r.dividend_yields[i] * t);
+    const T strike = r.strikes[i] * std::exp(-r.risk_free_rates[i] * t);
+    const bool is_call = r.option_types[i] > 0;
+    const bool in_the_money = underlying > strike;
+    const T intrinsic = is_call ? underlying - strike : strike - underlying;
+    const T lower = is_call == in_the_money ? intrinsic : 0;
+    const T upper = is_call ? underlying : strike;
+    const T slack = std::numeric_limits<T>::epsilon() * 64 * upper;
+    return quote <= lower + slack || quote >= upper - slack;
+}
+
+template <typename T>
+static void ExpectImpliedVolatilityRoundTrips(
+    T price_tolerance, T volatility_tolerance)
+{
+    // Assign
+    RandomQuotes<T> fast_q{100003};
+    RandomQuotes<T> naive_q{100003};
+    RandomQuotes<T> dynamic_q{100003};
+
+    // Act
+    FastImpliedVolatility<T, hn::ScalableTag<T>>::implied_volatility(
+        fast_q.view());
+    NaiveBlackScholes<T>::implied_volatility(naive_q.view());
+    DynamicBlackScholes<T>::implied_volatility(dynamic_q.view());
+
+    // Assert: repricing at the implied volatilities gives the quotes back,
+    // to within a tolerance relative to the underlying
+    const RandomInput<T>& r = fast_q.input;
+    size_t num_solved = 0;
+    size_t num_attainable = 0;
+    for (const auto* q : {&fast_q, &naive_q, &dynamic_q}) {
+        OptionPricing<T> repriced(
+            r.underlyings, r.strikes, r.risk_free_rates, q->volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types);
+        FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(repriced);
+        for (auto i = 0; i < r.num_options; ++i) {
+            // Quotes on or outside the zero and infinite volatility prices
+            // have no volatility to solve for
+            const T quote = q->pricing.prices[i];
+            num_attainable += !outside_volatility_bounds(r, i, quote);
+            if (std::isnan(q->volatilities[i])) {
+                EXPECT_TRUE(outside_volatility_bounds(r, i, quote))
+                    << "index " << i;
+                continue;
+            }
+            ++num_solved;
+            EXPECT_NEAR(
+                repriced.prices[i], quote,
+                price_tolerance * r.underlyings[i])
+                << "index " << i;
+            if (q->pricing.vegas[i] > 1e-2) {
+                EXPECT_NEAR(
+                    q->volatilities[i], r.volatilities[i],
+                    volatility_tolerance)
+                    << "index " << i;
+            }
+        }
+    }
+    EXPECT_GE(num_solved, num_attainable);
+}
+
+TEST(BlackScholesTestDouble, ImpliedVolatilityRoundTrip)
+{
+    ExpectImpliedVolatilityRoundTrips<double>(1e-10, 1e-7);
+}
+
+TEST(BlackScholesTestFloat, ImpliedVolatilityRoundTrip)
+{
+    ExpectImpliedVolatilityRoundTrips<float>(1e-4, 1e-2);
+}
+
+TEST(BlackScholesTestDouble, ImpliedVolatilityOfArbitrageIsNaN)
+{
+    // Assign: call below its lower bound, call above the underlying, put
+    // above the discounted strike, negative price
+    using T = double;
+    const std::vector<T> prices{1.0, 101.0, 200.0, -1.0};
+    const std::vector<T> underlyings(4, 100.0);
+    const std::vector<T> strikes{50.0, 100.0, 100.0, 100.0};
+    const std::vector<T> rates(4, 0.0);
+    const std::vector<T> times(4, 1.0);
+    const std::vector<T> yields(4, 0.0);
+    const std::vector<T> types{
+        OptionType<T>::kCall, OptionType<T>::kCall, OptionType<T>::kPut,
+        OptionType<T>::kPut};
+    std::vector<T> fast_volatilities(4, 0);
+    std::vector<T> naive_volatilities(4, 0);
+
+    // Act
+    FastImpliedVolatility<T, hn::ScalableTag<T>>::implied_volatility(
+        {prices, underlyings, strikes, rates, times, yields,
+         fast_volatilities, types});
+    NaiveBlackScholes<T>::implied_volatility(
+        {prices, underlyings, strikes, rates, times, yields,
+         naive_volatilities, types});
+
+    // Assert
+    for (auto i = 0; i < prices.size(); ++i) {
+        EXPECT_TRUE(std::isnan(fast_volatilities[i])) << "index " << i;
+        EXPECT_TRUE(std::isnan(naive_volatilities[i])) << "index " << i;
+    }
+}
+
+template <typename T>
+static void ExpectBlockedMatchesUnblocked(size_t num_options, size_t tile_size)
+{
+    // Assign
+    const RandomInput<T> r{1, num_options};
+    OptionPricing<T> op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    PutPricing<T> put(num_options);
+    const std::vector<T> positions(r.strikes.begin(), r.strikes.end());
+    OptionResult<T> totals{};
+    BlockedBlackScholes<T> pipeline(tile_size);
+    pipeline.template add_price<true>()
+        .add_put(put.view())
+        .add_aggregate(positions, totals);
+    OptionPricing<T> expected_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    PutPricing<T> expected_put(num_options);
+    DynamicBlackScholes<T>::price_call_put(expected_op, expected_put);
+
+    // Act
+    pipeline.run(op);
+
+    // Assert
+    EXPECT_EQ(pipeline.tile_size() % (HWY_ALIGNMENT / sizeof(T)), 0);
+    OptionResult<double> expected_totals{};
+    for (auto i = 0; i < num_options; ++i) {
+        EXPECT_EQ(op.prices[i], expected_op.prices[i]);
+        EXPECT_EQ(op.deltas[i], expected_op.deltas[i]);
+        EXPECT_EQ(op.vegas[i], expected_op.vegas[i]);
+        EXPECT_EQ(op.thetas[i], expected_op.thetas[i]);
+        EXPECT_EQ(op.gammas[i], expected_op.gammas[i]);
+        EXPECT_EQ(op.rhos[i], expected_op.rhos[i]);
+        EXPECT_EQ(put.prices[i], expected_put.prices[i]);
+        EXPECT_EQ(put.deltas[i], expected_put.deltas[i]);
+        EXPECT_EQ(put.thetas[i], expected_put.thetas[i]);
+        EXPECT_EQ(put.rhos[i], expected_put.rhos[i]);
+        expected_totals.price += positions[i] * op.prices[i];
+        expected_totals.delta += positions[i] * op.deltas[i];
+        expected_totals.vega += positions[i] * op.vegas[i];
+        expected_totals.theta += positions[i] * op.thetas[i];
+        expected_totals.gamma += positions[i] * op.gammas[i];
+        expected_totals.rho += positions[i] * op.rhos[i];
+    }
+    // Relative to the sum of absolute terms, which bounds rounding
+    const auto expect_sum = [&](T actual, double expected, auto column) {
+        double scale = 1.0;
+        for (auto i = 0; i < num_options; ++i) {
+            scale += std::abs(positions[i] * column[i]);
+        }
+        const double tolerance = std::is_same_v<T, float> ? 1e-5 : 1e-12;
+        EXPECT_NEAR(actual, expected, tolerance * scale);
+    };
+    expect_sum(totals.price, expected_totals.price, op.prices);
+    expect_sum(totals.delta, expected_totals.delta, op.deltas);
+    expect_sum(totals.vega, expected_totals.vega, op.vegas);
+    expect_sum(totals.theta, expected_totals.theta, op.thetas);
+    expect_sum(totals.gamma, expected_totals.gamma, op.gammas);
+    expect_sum(totals.rho, expected_totals.rho, op.rhos);
+}
+
+TEST(BlackScholesTestDouble, BlockedMatchesUnblocked)
+{
+    ExpectBlockedMatchesUnblocked<double>(0, 64);
+    ExpectBlockedMatchesUnblocked<double>(10007, 1);
+    ExpectBlockedMatchesUnblocked<double>(10007, 1000);
+    ExpectBlockedMatchesUnblocked<double>(10007, 20000);
+}
+
+TEST(BlackScholesTestFloat, BlockedMatchesUnblocked)
+{
+    ExpectBlockedMatchesUnblocked<float>(10007, 1000);
+}
+
+template <typename T>
+static void ExpectRecordsRoundTrip(size_t num_options)
+{
+    // Assign
+    const RandomInput<T> r{1, num_options};
+    const std::vector<OptionRecord<T>> records = ToRecords(r);
+    AlignedOptionPricing<T> fast_op;
+    AlignedOptionPricing<T> dynamic_op;
+    std::vector<OptionResult<T>> fast_results(num_options);
+    std::vector<OptionResult<T>> dynamic_results(num_options);
+
+    // Act
+    FastOptionRecords<T, hn::ScalableTag<T>>::ingest(records, fast_op);
+    DynamicBlackScholes<T>::ingest(records, dynamic_op);
+    FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(fast_op);
+    DynamicBlackScholes<T>::price_mixed(dynamic_op);
+    FastOptionRecords<T, hn::ScalableTag<T>>::write_results(
+        fast_op, fast_results);
+    DynamicBlackScholes<T>::write_results(dynamic_op, dynamic_results);
+
+    // Assert
+    for (auto* op : {&fast_op, &dynamic_op}) {
+        ASSERT_EQ(op->num_options(), num_options);
+        for (auto i = 0; i < num_options; ++i) {
+            EXPECT_EQ(op->underlyings()[i], r.underlyings[i]);
+            EXPECT_EQ(op->strikes()[i], r.strikes[i]);
+            EXPECT_EQ(op->risk_free_rates()[i], r.risk_free_rates[i]);
+            EXPECT_EQ(op->volatilities()[i], r.volatilities[i]);
+            EXPECT_EQ(op->times_to_expiry()[i], r.times_to_expiry[i]);
+            EXPECT_EQ(op->dividend_yields()[i], r.dividend_yields[i]);
+            EXPECT_EQ(op->option_types()[i], r.option_types[i]);
+        }
+    }
+    for (auto i = 0; i < num_options; ++i) {
+        for (const auto& [op, results] :
+             {std::pair{&fast_op, &fast_results},
+              std::pair{&dynamic_op, &dynamic_results}}) {
+            const OptionResult<T>& result = (*results)[i];
+            EXPECT_EQ(result.price, op->prices()[i]);
+            EXPECT_EQ(result.delta, op->deltas()[i]);
+            EXPECT_EQ(result.vega, op->vegas()[i]);
+            EXPECT_EQ(result.theta, op->thetas()[i]);
+            EXPECT_EQ(result.gamma, op->gammas()[i]);
+            EXPECT_EQ(result.rho, op->rhos()[i]);
+        }
+    }
+}
+
+TEST(BlackScholesTestDouble, RecordsRoundTrip)
+{
+    for (const size_t num_options : {0, 1, 7, 64, 1003}) {
+        ExpectRecordsRoundTrip<double>(num_options);
+    }
+}
+
+TEST(BlackScholesTestFloat, RecordsRoundTrip)
+{
+    for (const size_t num_options : {0, 1, 7, 64, 1003}) {
+        ExpectRecordsRoundTrip<float>(num_options);
+    }
+}
+
+template <typename T>
+static void ExpectRepriceDirtyMatchesFull()
+{
+    // Assign
+    constexpr T sentinel = -12345.0;
+    RandomInput<T> r{1, 10007};
+    AlignedOptionPricing<T> fast_op;
+    CopyInputs(r, fast_op);
+    AlignedOptionPricing<T> dynamic_op;
+    CopyInputs(r, dynamic_op);
+    const size_t lanes = hn::Lanes(hn::ScalableTag<T>());
+
+    // Act: the first cycle prices everything, which clears the bitmap
+    EXPECT_EQ(fast_op.num_dirty(), r.num_options);
+    FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(fast_op);
+    DynamicBlackScholes<T>::price_mixed(dynamic_op);
+    EXPECT_EQ(fast_op.num_dirty(), 0);
+    EXPECT_EQ(dynamic_op.num_dirty(), 0);
+
+    // then only what changed, here about 1% of the book
+    std::vector<bool> changed(r.num_options, false);
+    for (size_t i = 3; i < r.num_options; i += 97) {
+        changed[i] = true;
+    }
+    changed.back() = true;
+    for (auto i = 0; i < r.num_options; ++i) {
+        if (changed[i]) {
+            r.underlyings[i] *= static_cast<T>(1.01);
+            r.volatilities[i] += static_cast<T>(0.01);
+            r.option_types[i] = -r.option_types[i];
+        }
+    }
+    for (auto* op : {&fast_op, &dynamic_op}) {
+        std::fill(op->prices().begin(), op->prices().end(), sentinel);
+        for (auto i = 0; i < r.num_options; ++i) {
+            if (changed[i]) {
+                op->set_underlying(i, r.underlyings[i]);
+                op->set_volatility(i, r.volatilities[i]);
+                op->set_option_type(i, r.option_types[i]);
+            }
+        }
+    }
+    for (auto i = 0; i < r.num_options; ++i) {
+        EXPECT_EQ(fast_op.is_dirty(i), changed[i]);
+    }
+    FastBlackScholes<T, hn::ScalableTag<T>>::reprice_dirty_mixed(fast_op);
+    DynamicBlackScholes<T>::reprice_dirty_mixed(dynamic_op);
+    AlignedOptionPricing<T> expected_op;
+    CopyInputs(r, expected_op);
+    FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(expected_op);
+
+    // Assert
+    EXPECT_EQ(fast_op.num_dirty(), 0);
+    EXPECT_EQ(dynamic_op.num_dirty(), 0);
+    for (auto i = 0; i < r.num_options; ++i) {
+        const size_t first = i / lanes * lanes;
+        const bool in_dirty_vector = std::any_of(
+            changed.begin() + first,
+            changed.begin() + std::min(first + lanes, r.num_options),
+            [](bool c) { return c; });
+        EXPECT_EQ(
+            fast_op.prices()[i],
+            in_dirty_vector ? expected_op.prices()[i] : sentinel);
+        if (changed[i]) {
+            EXPECT_EQ(dynamic_op.prices()[i], expected_op.prices()[i]);
+            EXPECT_EQ(dynamic_op.deltas()[i], expected_op.deltas()[i]);
+            EXPECT_EQ(fast_op.deltas()[i], expected_op.deltas()[i]);
+            EXPECT_EQ(fast_op.vegas()[i], expected_op.vegas()[i]);
+            EXPECT_EQ(fast_op.thetas()[i], expected_op.thetas()[i]);
+            EXPECT_EQ(fast_op.gammas()[i], expected_op.gammas()[i]);
+            EXPECT_EQ(fast_op.rhos()[i], expected_op.rhos()[i]);
+        }
+    }
+}
+
+TEST(BlackScholesTestDouble, RepriceDirtyMatchesFull)
+{
+    ExpectRepriceDirtyMatchesFull<double>();
+}
+
+TEST(BlackScholesTestFloat, RepriceDirtyMatchesFull)
+{
+    ExpectRepriceDirtyMatchesFull<float>();
+}
+
+template <typename T>
+static void ExpectSpotTickMatchesPrice(T tolerance)
+{
+    // Assign
+    RandomInput<T> r{1, 10007};
+    AlignedOptionPricing<T> fast_op;
+    CopyInputs(r, fast_op);
+    SpotCache<T> fast_cache;
+    SpotCache<T> dynamic_cache;
+    FastSpotTick<T, hn::ScalableTag<T>>::cache_inputs(fast_op, fast_cache);
+    // A tick reads the underlyings, option types and the cache only
+    for (const std::span<T> column :
+         {fast_op.strikes(), fast_op.risk_free_rates(), fast_op.volatilities(),
+          fast_op.times_to_expiry(), fast_op.dividend_yields()}) {
+        std::fill(
+            column.begin(), column.end(),
+            std::numeric_limits<T>::quiet_NaN());
+    }
+    {
+        OptionPricing<T> op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types);
+        DynamicBlackScholes<T>::cache_spot_inputs(op.view(), dynamic_cache);
+    }
+
+    for (const T move : {1.0, 1.003, 0.97}) {
+        // Act: tick every underlying, keeping the cache
+        for (auto i = 0; i < r.num_options; ++i) {
+            r.underlyings[i] *= move;
+            fast_op.set_underlying(i, r.underlyings[i]);
+        }
+        OptionPricing<T> dynamic_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types);
+        OptionPricing<T> expected_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types);
+        FastSpotTick<T, hn::ScalableTag<T>>::price_mixed(fast_op, fast_cache);
+        DynamicBlackScholes<T>::price_spot_tick_mixed(
+            dynamic_op.view(), dynamic_cache);
+        FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(expected_op);
+
+        // Assert: prices relative to max(S, K), greeks to max(1, |greek|)
+        const auto expect_greek_near = [&](std::span<const T> expected,
+                                           std::span<const T> actual) {
+            for (auto i = 0; i < r.num_options; ++i) {
+                EXPECT_NEAR(
+                    actual[i], expected[i],
+                    tolerance * std::max<T>(1, std::abs(expected[i])))
+                    << "index " << i;
+            }
+        };
+        for (auto i = 0; i < r.num_options; ++i) {
+            const T scale = std::max(r.underlyings[i], r.strikes[i]);
+            EXPECT_NEAR(
+                fast_op.prices()[i], expected_op.prices[i], tolerance * scale)
+                << "index " << i;
+            EXPECT_NEAR(
+                dynamic_op.prices[i], expected_op.prices[i], tolerance * scale)
+                << "index " << i;
+        }
+        for (const OptionPricingView<T>& actual :
+             {fast_op.view(), dynamic_op.view()}) {
+            expect_greek_near(expected_op.deltas, actual.deltas);
+            expect_greek_near(expected_op.vegas, actual.vegas);
+            expect_greek_near(expected_op.thetas, actual.thetas);
+            expect_greek_near(expected_op.gammas, actual.gammas);
+            expect_greek_near(expected_op.rhos, actual.rhos);
+        }
+    }
+}
+
+TEST(BlackScholesTestDouble, SpotTickMatchesPrice)
+{
+    ExpectSpotTickMatchesPrice<double>(1e-12);
+}
+
+TEST(BlackScholesTestFloat, SpotTickMatchesPrice)
+{
+    ExpectSpotTickMatchesPrice<float>(5e-5);
+}
+
+template <typename T>
+static void ExpectBucketedMatchesPrice()
+{
+    // Assign: 12 expiry buckets, expanded into per-option columns for the
+    // expected prices
+    RandomInput<T> r{1, 10007};
+    constexpr size_t kNumBuckets = 12;
+    std::vector<T> bucket_rates(kNumBuckets, 0);
+    std::vector<T> bucket_yields(kNumBuckets, 0);
+    std::vector<T> bucket_expiries(kNumBuckets, 0);
+    for (auto b = 0; b < kNumBuckets; ++b) {
+        bucket_rates[b] = r.risk_free_rates[b];
+        bucket_yields[b] = r.dividend_yields[b];
+        bucket_expiries[b] = r.times_to_expiry[b];
+    }
+    std::vector<BucketIndex<T>> buckets(r.num_options, 0);
+    for (auto i = 0; i < r.num_options; ++i) {
+        buckets[i] = std::rand() % kNumBuckets;
+        r.risk_free_rates[i] = bucket_rates[buckets[i]];
+        r.dividend_yields[i] = bucket_yields[buckets[i]];
+        r.times_to_expiry[i] = bucket_expiries[buckets[i]];
+    }
+    const TermStructureView<T> ts(
+        bucket_rates, bucket_yields, bucket_expiries, buckets);
+    BucketTerms<T> fast_terms;
+    BucketTerms<T> dynamic_terms;
+    FastBlackScholes<T, hn::ScalableTag<T>>::cache_bucket_terms(
+        ts, fast_terms);
+    DynamicBlackScholes<T>::cache_bucket_terms(ts, dynamic_terms);
+
+    for (const bool mixed : {false, true}) {
+        OptionPricing<T> expected_fast_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types);
+        OptionPricing<T> expected_dynamic_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types);
+        OptionPricing<T> fast_op(
+            r.underlyings, r.strikes, {}, r.volatilities, {}, {},
+            r.option_types);
+        OptionPricing<T> dynamic_op(
+            r.underlyings, r.strikes, {}, r.volatilities, {}, {},
+            r.option_types);
+
+        // Act
+        if (mixed) {
+            FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(
+                expected_fast_op);
+            DynamicBlackScholes<T>::price_mixed(expected_dynamic_op);
+            FastBlackScholes<T, hn::ScalableTag<T>>::price_bucketed_mixed(
+                fast_op.view(), ts, fast_terms);
+            DynamicBlackScholes<T>::price_bucketed_mixed(
+                dynamic_op.view(), ts, dynamic_terms);
+        } else {
+            FastBlackScholes<T, hn::ScalableTag<T>>::template price<false>(
+                expected_fast_op);
+            DynamicBlackScholes<T>::template price<false>(
+                expected_dynamic_op);
+            FastBlackScholes<T, hn::ScalableTag<T>>::template price_bucketed<
+                false>(fast_op.view(), ts, fast_terms);
+            DynamicBlackScholes<T>::template price_bucketed<false>(
+                dynamic_op.view(), ts, dynamic_terms);
+        }
+
+        // Assert: the gathered terms are the ones price computes per option,
+        // on the same target
+        const auto expect_eq = [](const OptionPricing<T>& actual,
+                                  const OptionPricing<T>& expected) {
+            EXPECT_EQ(actual.prices, expected.prices);
+            EXPECT_EQ(actual.deltas, expected.deltas);
+            EXPECT_EQ(actual.vegas, expected.vegas);
+            EXPECT_EQ(actual.thetas, expected.thetas);
+            EXPECT_EQ(actual.gammas, expected.gammas);
+            EXPECT_EQ(actual.rhos, expected.rhos);
+        };
+        expect_eq(fast_op, expected_fast_op);
+        expect_eq(dynamic_op, expected_dynamic_op);
+    }
+
+    // A bucket past the last one, which the pricers would gather from
+    // unchecked
+    EXPECT_TRUE(ts.has_valid_buckets());
+    buckets.back() = kNumBuckets;
+    EXPECT_FALSE(ts.has_valid_buckets());
+}
+
+TEST(BlackScholesTestDouble, BucketedMatchesPrice)
+{
+    ExpectBucketedMatchesPrice<double>();
+}
+
+TEST(BlackScholesTestFloat, BucketedMatchesPrice)
+{
+    ExpectBucketedMatchesPrice<float>();
+}
+
+template <typename T>
+static void ExpectChainMatchesPrice()
+{
+    // Assign: a chain of 1001 strikes on a volatility smile, expanded into
+    // per-option columns for the expected prices
+    const StrikeChain<T> chain{100, 0.03, 0.5, 0.01};
+    RandomInput<T> r{1, 1001};
+    for (auto i = 0; i < r.num_options; ++i) {
+        const T moneyness = std::log(r.strikes[i] / chain.underlying);
+        r.underlyings[i] = chain.underlying;
+        r.risk_free_rates[i] = chain.risk_free_rate;
+        r.volatilities[i] = static_cast<T>(0.2) + moneyness * moneyness / 2;
+        r.times_to_expiry[i] = chain.time_to_expiry;
+        r.dividend_yields[i] = chain.dividend_yield;
+    }
+
+    for (const bool mixed : {false, true}) {
+        OptionPricing<T> expected_fast_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types);
+        OptionPricing<T> expected_dynamic_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types);
+        OptionPricing<T> fast_op(
+            {}, r.strikes, {}, r.volatilities, {}, {}, r.option_types);
+        OptionPricing<T> dynamic_op(
+            {}, r.strikes, {}, r.volatilities, {}, {}, r.option_types);
+        // Aligned and padded, for aligned full vectors
+        AlignedOptionPricing<T> aligned_op;
+        CopyInputs(r, aligned_op);
+
+        // Act
+        if (mixed) {
+            FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(
+                expected_fast_op);
+            DynamicBlackScholes<T>::price_mixed(expected_dynamic_op);
+            FastBlackScholes<T, hn::ScalableTag<T>>::price_chain_mixed(
+                chain, fast_op.view());
+            FastBlackScholes<T, hn::ScalableTag<T>>::price_chain_mixed(
+                chain, aligned_op.view());
+            DynamicBlackScholes<T>::price_chain_mixed(chain, dynamic_op.view());
+        } else {
+            FastBlackScholes<T, hn::ScalableTag<T>>::template price<true>(
+                expected_fast_op);
+            DynamicBlackScholes<T>::template price<true>(expected_dynamic_op);
+            FastBlackScholes<T, hn::ScalableTag<T>>::template price_chain<
+                true>(chain, fast_op.view());
+            FastBlackScholes<T, hn::ScalableTag<T>>::template price_chain<
+                true>(chain, aligned_op.view());
+            DynamicBlackScholes<T>::template price_chain<true>(
+                chain, dynamic_op.view());
+        }
+
+        // Assert: the broadcast terms are the ones price computes per
+        // option, on the same target
+        const auto expect_eq = [&](const OptionPricingView<T>& actual,
+                                   const OptionPricing<T>& expected) {
+            for (auto i = 0; i < r.num_options; ++i) {
+                EXPECT_EQ(actual.prices[i], expected.prices[i]);
+                EXPECT_EQ(actual.deltas[i], expected.deltas[i]);
+                EXPECT_EQ(actual.vegas[i], expected.vegas[i]);
+                EXPECT_EQ(actual.thetas[i], expected.thetas[i]);
+                EXPECT_EQ(actual.gammas[i], expected.gammas[i]);
+                EXPECT_EQ(actual.rhos[i], expected.rhos[i]);
+            }
+        };
+        expect_eq(fast_op.view(), expected_fast_op);
+        expect_eq(aligned_op.view(), expected_fast_op);
+        expect_eq(dynamic_op.view(), expected_dynamic_op);
+    }
+}
+
+TEST(BlackScholesTestDouble, ChainMatchesPrice)
+{
+    ExpectChainMatchesPrice<double>();
+}
+
+TEST(BlackScholesTestFloat, ChainMatchesPrice)
+{
+    ExpectChainMatchesPrice<float>();
+}
+
+// Scalar Cox-Ross-Rubinstein tree, the reference for FastBinomialTree.
+// 'sign' is +1 for calls and -1 for puts.
+static double ReferenceAmericanPrice(
+    double underlying, double strike, double risk_free_rate, double volatility,
+    double time_to_expiry, double dividend_yield, double sign,
+    size_t num_steps)
+{
+    const double dt = time_to_expiry / static_cast<double>(num_steps);
+    const double sigma_root_dt = volatility * std::sqrt(dt);
+    const double up = std::exp(sigma_root_dt);
+    const double down = std::exp(-sigma_root_dt);
+    const double discount = std::exp(-risk_free_rate * dt);
+    const double up_weight =
+        discount * (std::exp((risk_free_rate - dividend_yield) * dt) - down) /
+        (up - down);
+    const double down_weight = discount - up_weight;
+    const auto payoff = [&](double moves) {
+        return std::max(
+            sign * (underlying * std::exp(moves * sigma_root_dt) - strike),
+            0.0);
+    };
+
+    std::vector<double> values(num_steps + 1, 0);
+    for (size_t j = 0; j <= num_steps; ++j) {
+        values[j] = payoff(static_cast<double>(num_steps) - 2.0 * j);
+    }
+    for (size_t n = num_steps; n-- > 0;) {
+        for (size_t j = 0; j <= n; ++j) {
+            values[j] = std::max(
+                up_weight * values[j] + down_weight * values[j + 1],
+                payoff(static_cast<double>(n) - 2.0 * j));
+        }
+    }
+    return values[0];
+}
+
+template <typename T>
+static void ExpectAmericanTreeMatchesScalarTree(T tolerance)
+{
+    // Assign
+    constexpr size_t kNumSteps = 50;
+    RandomInput<T> r{1, 101};
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+    OptionPricing<T> dynamic_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+
+    // Act
+    FastBinomialTree<T, hn::ScalableTag<T>>::template price_mixed<kPrice>(
+        fast_op.view(), kNumSteps);
+    DynamicBlackScholes<T>::price_american_mixed(dynamic_op.view(), kNumSteps);
+
+    // Assert: relative to max(S, K)
+    for (auto i = 0; i < r.num_options; ++i) {
+        const double expected = ReferenceAmericanPrice(
+            r.underlyings[i], r.strikes[i], r.risk_free_rates[i],
+            r.volatilities[i], r.times_to_expiry[i], r.dividend_yields[i],
+            r.option_types[i], kNumSteps);
+        const T scale = std::max(r.underlyings[i], r.strikes[i]);
+        EXPECT_NEAR(fast_op.prices[i], expected, tolerance * scale)
+            << "index " << i;
+        EXPECT_NEAR(dynamic_op.prices[i], expected, tolerance * scale)
+            << "index " << i;
+    }
+}
+
+TEST(BlackScholesTestDouble, AmericanTreeMatchesScalarTree)
+{
+    ExpectAmericanTreeMatchesScalarTree<double>(1e-12);
+}
+
+TEST(BlackScholesTestFloat, AmericanTreeMatchesScalarTree)
+{
+    ExpectAmericanTreeMatchesScalarTree<float>(1e-4);
+}
+
+TEST(BlackScholesTestDouble, AmericanTreeConvergesToEuropean)
+{
+    // Assign: without dividends an American call is never exercised early,
+    // and an American put is worth at least the European one
+    using T = double;
+    RandomInput<T> r{1, 101};
+    for (auto i = 0; i < r.num_options; ++i) {
+        r.dividend_yields[i] = 0;
+        // Away from expiry, where the tree has too few steps per unit of
+        // time value
+        r.times_to_expiry[i] = 0.1 + r.times_to_expiry[i];
+        r.volatilities[i] = 0.05 + r.volatilities[i];
+        // Rates stay positive when rho bumps them, or calls may be
+        // exercised early
+        r.risk_free_rates[i] = 0.02 + r.risk_free_rates[i];
+    }
+    OptionPricing<T> tree_call(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    OptionPricing<T> tree_put(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, {}, kPrice);
+    OptionPricing<T> european_call(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    OptionPricing<T> european_put(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, {}, kPrice);
+
+    // Act
+    FastBinomialTree<T, hn::ScalableTag<T>>::price<true>(
+        tree_call.view(), 1000);
+    FastBinomialTree<T, hn::ScalableTag<T>>::price<false, kPrice>(
+        tree_put.view(), 1000);
+    FastBlackScholes<T, hn::ScalableTag<T>>::price<true>(european_call);
+    FastBlackScholes<T, hn::ScalableTag<T>>::price<false, kPrice>(
+        european_put);
+
+    // Assert: prices relative to max(S, K), greeks to max(1, |greek|)
+    const auto expect_greek_near = [&](std::span<const T> expected,
+                                       std::span<const T> actual) {
+        for (auto i = 0; i < r.num_options; ++i) {
+            EXPECT_NEAR(
+                actual[i], expected[i],
+                1e-2 * std::max<T>(1, std::abs(expected[i])))
+                << "index " << i;
+        }
+    };
+    for (auto i = 0; i < r.num_options; ++i) {
+        const T scale = std::max(r.underlyings[i], r.strikes[i]);
+        EXPECT_NEAR(tree_call.prices[i], european_call.prices[i], 1e-3 * scale)
+            << "index " << i;
+        EXPECT_GE(tree_put.prices[i], european_put.prices[i] - 1e-3 * scale)
+            << "index " << i;
+    }
+    expect_greek_near(european_call.deltas, tree_call.deltas);
+    expect_greek_near(european_call.vegas, tree_call.vegas);
+    expect_greek_near(european_call.thetas, tree_call.thetas);
+    expect_greek_near(european_call.gammas, tree_call.gammas);
+    expect_greek_near(european_call.rhos, tree_call.rhos);
+}
+
+TEST(BlackScholesTestDouble, AmericanPutGreeksMatchScalarTree)
+{
+    // Assign: a quarter of the options at the vega bump of 1%, a quarter
+    // below it
+    using T = double;
+    constexpr size_t kNumSteps = 500;
+    RandomInput<T> r{1, 101};
+    for (auto i = 0; i < r.num_options; ++i) {
+        r.times_to_expiry[i] = 0.1 + r.times_to_expiry[i];
+        r.volatilities[i] = i % 4 == 0   ? 0.01
+                            : i % 4 == 1 ? 0.005
+                                         : 0.05 + r.volatilities[i];
+    }
+    OptionPricing<T> tree_put(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+
+    // Act
+    FastBinomialTree<T, hn::ScalableTag<T>>::price<false>(
+        tree_put.view(), kNumSteps);
+
+    // Assert: vega and rho are the bumped scalar trees, delta and theta
+    // finite differences of it away from the lowest volatilities, where
+    // the tree is too coarse in the underlying
+    for (auto i = 0; i < r.num_options; ++i) {
+        const auto reference = [&](T underlying, T risk_free_rate,
+                                   T volatility, T time_to_expiry) {
+            return ReferenceAmericanPrice(
+                underlying, r.strikes[i], risk_free_rate, volatility,
+                time_to_expiry, r.dividend_yields[i], -1, kNumSteps);
+        };
+        const T S = r.underlyings[i];
+        const T rate = r.risk_free_rates[i];
+        const T vol = r.volatilities[i];
+        const T expiry = r.times_to_expiry[i];
+        const T scale = std::max(S, r.strikes[i]);
+
+        const T vol_down = vol > 0.01 ? vol - 0.01 : vol;
+        const T vega = 0.01 *
+                       (reference(S, rate, vol + 0.01, expiry) -
+                        reference(S, rate, vol_down, expiry)) /
+                       (vol + 0.01 - vol_down);
+        const T rho = 0.01 *
+                      (reference(S, rate + 0.01, vol, expiry) -
+                       reference(S, rate - 0.01, vol, expiry)) /
+                      0.02;
+        EXPECT_TRUE(std::isfinite(tree_put.vegas[i])) << "index " << i;
+        EXPECT_NEAR(tree_put.vegas[i], vega, 1e-9 * scale) << "index " << i;
+        EXPECT_NEAR(tree_put.rhos[i], rho, 1e-9 * scale) << "index " << i;
+        EXPECT_NEAR(
+            tree_put.prices[i], reference(S, rate, vol, expiry),
+            1e-9 * scale)
+            << "index " << i;
+        if (vol < 0.05) {
+            continue;
+        }
+        const T h = 1e-2 * S;
+        const T delta = (reference(S + h, rate, vol, expiry) -
+                         reference(S - h, rate, vol, expiry)) /
+                        (2 * h);
+        const T theta = -(reference(S, rate, vol, expiry + 1e-2) -
+                          reference(S, rate, vol, expiry - 1e-2)) /
+                        (2e-2 * 365);
+        EXPECT_NEAR(tree_put.deltas[i], delta, 2e-2) << "index " << i;
+        // Convex up to rounding where the nodes are all exercised
+        EXPECT_GE(tree_put.gammas[i], -1e-12) << "index " << i;
+        EXPECT_NEAR(
+            tree_put.thetas[i], theta,
+            1e-2 * std::max<T>(1, std::abs(theta)))
+            << "index " << i;
+    }
+}
+
+template <typename T>
+static void ExpectBaroneAdesiWhaleyNearTree(T tolerance)
+{
+    // Assign
+    constexpr size_t kNumSteps = 1000;
+    RandomInput<T> r{1, 101};
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+    OptionPricing<T> dynamic_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+
+    // Act
+    FastBaroneAdesiWhaley<T, hn::ScalableTag<T>>::price_mixed(fast_op.view());
+    DynamicBlackScholes<T>::price_american_approximation_mixed(
+        dynamic_op.view());
+
+    // Assert: the approximation error, relative to max(S, K)
+    for (auto i = 0; i < r.num_options; ++i) {
+        const double expected = ReferenceAmericanPrice(
+            r.underlyings[i], r.strikes[i], r.risk_free_rates[i],
+            r.volatilities[i], r.times_to_expiry[i], r.dividend_yields[i],
+            r.option_types[i], kNumSteps);
+        const T scale = std::max(r.underlyings[i], r.strikes[i]);
+        EXPECT_NEAR(fast_op.prices[i], expected, tolerance * scale)
+            << "index " << i;
+        EXPECT_NEAR(dynamic_op.prices[i], expected, tolerance * scale)
+            << "index " << i;
+    }
+}
+
+TEST(BlackScholesTestDouble, BaroneAdesiWhaleyNearTree)
+{
+    ExpectBaroneAdesiWhaleyNearTree<double>(2e-3);
+}
+
+TEST(BlackScholesTestFloat, BaroneAdesiWhaleyNearTree)
+{
+    ExpectBaroneAdesiWhaleyNearTree<float>(2e-3);
+}
+
+template <typename T>
+static void ExpectBaroneAdesiWhaleyCallWithoutDividendsIsEuropean(
+    T tolerance)
+{
+    // Assign: an American call on an underlying without dividends is never
+    // exercised early
+    RandomInput<T> r{1, 1001};
+    std::fill(r.dividend_yields.begin(), r.dividend_yields.end(), T{0});
+    OptionPricing<T> american(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, {}, kPrice);
+    OptionPricing<T> european(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, {}, kPrice);
+
+    // Act
+    FastBaroneAdesiWhaley<T, hn::ScalableTag<T>>::template price<true>(
+        american.view());
+    FastBlackScholes<T, hn::ScalableTag<T>>::template price<true, kPrice>(
+        european);
+
+    // Assert
+    for (auto i = 0; i < r.num_options; ++i) {
+        const T scale = std::max(r.underlyings[i], r.strikes[i]);
+        EXPECT_NEAR(american.prices[i], european.prices[i], tolerance * scale)
+            << "index " << i;
+    }
+}
+
+TEST(BlackScholesTestDouble, BaroneAdesiWhaleyCallWithoutDividendsIsEuropean)
+{
+    ExpectBaroneAdesiWhaleyCallWithoutDividendsIsEuropean<double>(1e-12);
+}
+
+TEST(BlackScholesTestFloat, BaroneAdesiWhaleyCallWithoutDividendsIsEuropean)
+{
+    ExpectBaroneAdesiWhaleyCallWithoutDividendsIsEuropean<float>(1e-5);
+}
+
+template <typename T>
+static void ExpectBaroneAdesiWhaleyAtZeroRateAndExpiry(T tolerance)
+{
+    // Assign: calls with dividends at r = 0, where 1 - e^(-rT) is 0, and
+    // options of either kind at T = 0
+    constexpr size_t kNumSteps = 1000;
+    RandomInput<T> r{1, 101};
+    for (auto i = 0; i < r.num_options; ++i) {
+        if (i % 2 == 0) {
+            r.risk_free_rates[i] = 0;
+            r.option_types[i] = OptionType<T>::kCall;
+            r.dividend_yields[i] = 0.01 + r.dividend_yields[i];
+        } else {
+            r.times_to_expiry[i] = 0;
+        }
+    }
+    OptionPricing<T> op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+
+    // Act
+    FastBaroneAdesiWhaley<T, hn::ScalableTag<T>>::price_mixed(op.view());
+
+    // Assert: the approximation error relative to max(S, K), and the payoff
+    // at expiry
+    for (auto i = 0; i < r.num_options; ++i) {
+        const T scale = std::max(r.underlyings[i], r.strikes[i]);
+        const T payoff = std::max<T>(
+            r.option_types[i] * (r.underlyings[i] - r.strikes[i]), 0);
+        if (i % 2 == 0) {
+            const double expected = ReferenceAmericanPrice(
+                r.underlyings[i], r.strikes[i], r.risk_free_rates[i],
+                r.volatilities[i], r.times_to_expiry[i],
+                r.dividend_yields[i], r.option_types[i], kNumSteps);
+            EXPECT_NEAR(op.prices[i], expected, tolerance * scale)
+                << "index " << i;
+        } else {
+            EXPECT_EQ(op.prices[i], payoff) << "index " << i;
+        }
+    }
+}
+
+TEST(BlackScholesTestDouble, BaroneAdesiWhaleyAtZeroRateAndExpiry)
+{
+    ExpectBaroneAdesiWhaleyAtZeroRateAndExpiry<double>(2e-3);
+}
+
+TEST(BlackScholesTestFloat, BaroneAdesiWhaleyAtZeroRateAndExpiry)
+{
+    ExpectBaroneAdesiWhaleyAtZeroRateAndExpiry<float>(2e-3);
+}
+
+TEST(BlackScholesTestDouble, PhiloxKnownAnswers)
+{
+    // Assign: Random123's known answers for Philox4x32-10
+    using Philox = FastPhilox<double, hn::ScalableTag<double>>;
+    constexpr hn::Rebind<uint32_t, hn::ScalableTag<double>> du;
+    const uint32_t counters[3][4] = {
+        {0x00000000, 0x00000000, 0x00000000, 0x00000000},
+        {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+        {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}};
+    const uint32_t keys[3][2] = {
+        {0x00000000, 0x00000000},
+        {0xffffffff, 0xffffffff},
+        {0xa4093822, 0x299f31d0}};
+    const uint32_t expected[3][4] = {
+        {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8},
+        {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd},
+        {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}};
+
+    for (auto k = 0; k < 3; ++k) {
+        auto c0 = hn::Set(du, counters[k][0]);
+        auto c1 = hn::Set(du, counters[k][1]);
+        auto c2 = hn::Set(du, counters[k][2]);
+        auto c3 = hn::Set(du, counters[k][3]);
+
+        // Act
+        Philox::hash(c0, c1, c2, c3, keys[k][0], keys[k][1]);
+
+        // Assert
+        for (size_t lane = 0; lane < hn::Lanes(du); ++lane) {
+            EXPECT_EQ(hn::ExtractLane(c0, lane), expected[k][0]);
+            EXPECT_EQ(hn::ExtractLane(c1, lane), expected[k][1]);
+            EXPECT_EQ(hn::ExtractLane(c2, lane), expected[k][2]);
+            EXPECT_EQ(hn::ExtractLane(c3, lane), expected[k][3]);
+        }
+    }
+}
+
+template <typename T>
+static void ExpectMonteCarloMatchesBlackScholes(T tolerance)
+{
+    // Assign
+    RandomInput<T> r{1, 101};
+    OptionPricing<T> expected(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+    FastBlackScholes<T, hn::ScalableTag<T>>::template price_mixed<kPrice>(
+        expected);
+
+    // One step samples the terminal underlying directly, three go through
+    // both normals of a draw and half of the next one
+    for (const size_t num_steps : {1, 3}) {
+        const MonteCarloSettings settings{1 << 15, num_steps, 42};
+        OptionPricing<T> fast_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+        OptionPricing<T> dynamic_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+        std::vector<T> fast_errors(r.num_options, 0);
+        std::vector<T> dynamic_errors(r.num_options, 0);
+
+        // Act
+        FastMonteCarlo<T, hn::ScalableTag<T>>::price_mixed(
+            fast_op.view(), settings, fast_errors);
+        DynamicBlackScholes<T>::price_monte_carlo_mixed(
+            dynamic_op.view(), settings, dynamic_errors);
+
+        // Assert: within five standard errors, plus a little of max(S, K)
+        // for options so far out of the money that almost no path pays
+        for (auto i = 0; i < r.num_options; ++i) {
+            const T scale = std::max(r.underlyings[i], r.strikes[i]);
+            EXPECT_NEAR(
+                fast_op.prices[i], expected.prices[i],
+                5 * fast_errors[i] + tolerance * scale)
+                << num_steps << " steps, index " << i;
+            EXPECT_NEAR(
+                dynamic_op.prices[i], expected.prices[i],
+                5 * dynamic_errors[i] + tolerance * scale)
+                << num_steps << " steps, index " << i;
+            EXPECT_LT(fast_errors[i], 2e-2 * scale) << "index " << i;
+        }
+    }
+}
+
+TEST(BlackScholesTestDouble, MonteCarloMatchesBlackScholes)
+{
+    ExpectMonteCarloMatchesBlackScholes<double>(1e-5);
+}
+
+TEST(BlackScholesTestFloat, MonteCarloMatchesBlackScholes)
+{
+    ExpectMonteCarloMatchesBlackScholes<float>(1e-4);
+}
+
+template <typename T>
+static void ExpectAntitheticMonteCarloMatchesBlackScholes(T tolerance)
+{
+    // Assign
+    RandomInput<T> r{1, 101};
+    OptionPricing<T> expected(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+    FastBlackScholes<T, hn::ScalableTag<T>>::template price_mixed<kPrice>(
+        expected);
+
+    // Pairs mirror both normals of a draw on one step and on three
+    for (const size_t num_steps : {1, 3}) {
+        MonteCarloSettings settings{1 << 14, num_steps, 42};
+        settings.antithetic = true;
+        OptionPricing<T> fast_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+        OptionPricing<T> dynamic_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+        std::vector<T> fast_errors(r.num_options, 0);
+        std::vector<T> dynamic_errors(r.num_options, 0);
+
+        // Act
+        FastMonteCarlo<T, hn::ScalableTag<T>>::price_mixed(
+            fast_op.view(), settings, fast_errors);
+        DynamicBlackScholes<T>::price_monte_carlo_mixed(
+            dynamic_op.view(), settings, dynamic_errors);
+
+        // Assert: within five standard errors of the pairs, plus a little
+        // of max(S, K) for options so far out of the money that almost no
+        // path pays
+        for (auto i = 0; i < r.num_options; ++i) {
+            const T scale = std::max(r.underlyings[i], r.strikes[i]);
+            EXPECT_NEAR(
+                fast_op.prices[i], expected.prices[i],
+                5 * fast_errors[i] + tolerance * scale)
+                << num_steps << " steps, index " << i;
+            EXPECT_NEAR(
+                dynamic_op.prices[i], expected.prices[i],
+                5 * dynamic_errors[i] + tolerance * scale)
+                << num_steps << " steps, index " << i;
+            EXPECT_LT(fast_errors[i], 2e-2 * scale) << "index " << i;
+        }
+    }
+}
+
+TEST(BlackScholesTestDouble, AntitheticMonteCarloMatchesBlackScholes)
+{
+    ExpectAntitheticMonteCarloMatchesBlackScholes<double>(1e-5);
+}
+
+TEST(BlackScholesTestFloat, AntitheticMonteCarloMatchesBlackScholes)
+{
+    ExpectAntitheticMonteCarloMatchesBlackScholes<float>(1e-4);
+}
+
+TEST(BlackScholesTestDouble, MonteCarloIndependentOfThreads)
+{
+    // Assign: paths that are neither a whole number of tasks nor of lanes
+    using T = double;
+    RandomInput<T> r{1, 11};
+    const MonteCarloSettings settings{40001, 2, 7};
+    OptionPricing<T> serial_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+    DynamicBlackScholes<T>::price_monte_carlo_mixed(
+        serial_op.view(), settings);
+    std::vector<T> single_thread_prices;
+
+    for (const size_t num_threads : {1, 3, 8}) {
+        ThreadPool pool(num_threads);
+        const ParallelBlackScholes<T> pricer(pool);
+        OptionPricing<T> mixed_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+
+        // Act
+        pricer.price_monte_carlo_mixed(mixed_op.view(), settings);
+
+        // Assert: the same sums in the same order whatever the threads, and
+        // the serial sums up to rounding
+        if (single_thread_prices.empty()) {
+            single_thread_prices = mixed_op.prices;
+        }
+        for (auto i = 0; i < r.num_options; ++i) {
+            EXPECT_EQ(mixed_op.prices[i], single_thread_prices[i])
+                << num_threads << " threads, index " << i;
+            EXPECT_NEAR(
+                mixed_op.prices[i], serial_op.prices[i],
+                1e-12 * std::max(r.underlyings[i], r.strikes[i]))
+                << num_threads << " threads, index " << i;
+        }
+    }
+}
+
+TEST(BlackScholesTestDouble, MonteCarloPathsMatchEstimate)
+{
+    // Assign
+    using T = double;
+    RandomInput<T> r{1, 5};
+    const MonteCarloSettings settings{1001, 4, 3};
+    OptionPricing<T> op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+    DynamicBlackScholes<T>::price_monte_carlo_mixed(op.view(), settings);
+
+    for (auto i = 0; i < r.num_options; ++i) {
+        std::vector<T> paths(settings.num_steps * settings.num_paths, 0);
+
+        // Act
+        DynamicBlackScholes<T>::simulate_paths(op.view(), i, settings, paths);
+
+        // Assert: the last row holds the underlyings the estimate paid on
+        T sum = 0;
+        for (size_t p = 0; p < settings.num_paths; ++p) {
+            const T spot =
+                paths[(settings.num_steps - 1) * settings.num_paths + p];
+            EXPECT_GT(spot, 0) << "path " << p;
+            sum += std::max(r.option_types[i] * (spot - r.strikes[i]), 0.0);
+        }
+        const T price =
+            std::exp(-r.risk_free_rates[i] * r.times_to_expiry[i]) * sum /
+            static_cast<T>(settings.num_paths);
+        EXPECT_NEAR(
+            op.prices[i], price,
+            1e-12 * std::max(r.underlyings[i], r.strikes[i]))
+            << "index " << i;
+    }
+}
+
+TEST(BlackScholesTestDouble, PathPayoffsMatchStoredPaths)
+{
+    // Assign
+    using T = double;
+    RandomInput<T> r{1, 5};
+    const PathPayoff payoffs[] = {
+        PathPayoff::kArithmeticAsian, PathPayoff::kGeometricAsian,
+        PathPayoff::kFixedLookback, PathPayoff::kFloatingLookback};
+
+    for (const PathPayoff payoff : payoffs) {
+        const MonteCarloSettings settings{1001, 5, 3, payoff};
+        OptionPricing<T> op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+
+        // Act
+        DynamicBlackScholes<T>::price_monte_carlo_mixed(op.view(), settings);
+
+        // Assert: the running accumulators pay what the stored paths do
+        for (auto i = 0; i < r.num_options; ++i) {
+            std::vector<T> paths(settings.num_steps * settings.num_paths, 0);
+            DynamicBlackScholes<T>::simulate_paths(
+                op.view(), i, settings, paths);
+            const T sign = r.option_types[i];
+            const T strike = r.strikes[i];
+            T sum = 0;
+            for (size_t p = 0; p < settings.num_paths; ++p) {
+                T mean = 0;
+                T log_mean = 0;
+                T low = r.underlyings[i];
+                T high = r.underlyings[i];
+                T spot = r.underlyings[i];
+                for (size_t s = 0; s < settings.num_steps; ++s) {
+                    spot = paths[s * settings.num_paths + p];
+                    mean += spot / settings.num_steps;
+                    log_mean += std::log(spot) / settings.num_steps;
+                    low = std::min(low, spot);
+                    high = std::max(high, spot);
+                }
+                switch (payoff) {
+                    case PathPayoff::kArithmeticAsian:
+                        sum += std::max(sign * (mean - strike), 0.0);
+                        break;
+                    case PathPayoff::kGeometricAsian:
+                        sum += std::max(
+                            sign * (std::exp(log_mean) - strike), 0.0);
+                        break;
+                    case PathPayoff::kFixedLookback:
+                        sum += std::max(
+                            sign * ((sign > 0 ? high : low) - strike), 0.0);
+                        break;
+                    default:
+                        sum += sign * (spot - (sign > 0 ? low : high));
+                }
+            }
+            const T price =
+                std::exp(-r.risk_free_rates[i] * r.times_to_expiry[i]) *
+                sum / static_cast<T>(settings.num_paths);
+            EXPECT_NEAR(
+                op.prices[i], price,
+                1e-12 * std::max(r.underlyings[i], r.strikes[i]))
+                << "payoff " << static_cast<int>(payoff) << ", index " << i;
+        }
+    }
+}
+
+template <typename T>
+static void ExpectGeometricAsianMatchesClosedForm(T tolerance)
+{
+    // Assign: the control variate prices geometric Asians in closed form
+    RandomInput<T> r{1, 101};
+    const MonteCarloSettings settings{
+        1 << 14, 12, 42, PathPayoff::kGeometricAsian};
+    MonteCarloSettings closed_form = settings;
+    closed_form.control_variate = true;
+    OptionPricing<T> expected(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+    std::vector<T> expected_errors(r.num_options, 0);
+    FastMonteCarlo<T, hn::ScalableTag<T>>::price_mixed(
+        expected.view(), closed_form, expected_errors);
+    OptionPricing<T> fast_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+    std::vector<T> fast_errors(r.num_options, 0);
+
+    // Act
+    FastMonteCarlo<T, hn::ScalableTag<T>>::price_mixed(
+        fast_op.view(), settings, fast_errors);
+
+    // Assert
+    for (auto i = 0; i < r.num_options; ++i) {
+        const T scale = std::max(r.underlyings[i], r.strikes[i]);
+        EXPECT_NEAR(expected_errors[i], 0, tolerance * scale) << "index " << i;
+        EXPECT_NEAR(
+            fast_op.prices[i], expected.prices[i],
+            5 * fast_errors[i] + tolerance * scale)
+            << "index " << i;
+    }
+}
+
+TEST(BlackScholesTestDouble, GeometricAsianMatchesClosedForm)
+{
+    ExpectGeometricAsianMatchesClosedForm<double>(1e-5);
+}
+
+TEST(BlackScholesTestFloat, GeometricAsianMatchesClosedForm)
+{
+    ExpectGeometricAsianMatchesClosedForm<float>(1e-4);
+}
+
+TEST(BlackScholesTestDouble, AsianVarianceReduction)
+{
+    // Assign
+    using T = double;
+    RandomInput<T> r{1, 101};
+    const MonteCarloSettings plain{
+        1 << 14, 12, 42, PathPayoff::kArithmeticAsian};
+    MonteCarloSettings antithetic = plain;
+    antithetic.antithetic = true;
+    MonteCarloSettings control = plain;
+    control.control_variate = true;
+    OptionPricing<T> expected(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+    std::vector<T> expected_errors(r.num_options, 0);
+    DynamicBlackScholes<T>::price_monte_carlo_mixed(
+        expected.view(), plain, expected_errors);
+
+    for (const MonteCarloSettings& settings : {antithetic, control}) {
+        OptionPricing<T> op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, r.option_types, kPrice);
+        std::vector<T> errors(r.num_options, 0);
+
+        // Act
+        DynamicBlackScholes<T>::price_monte_carlo_mixed(
+            op.view(), settings, errors);
+
+        // Assert: the same price at a fraction of the error. Antithetic
+        // pairs of a monotone payoff are negatively correlated, so pairs at
+        // least halve the variance. Errors of options so far out of the
+        // money that a handful of paths pay are themselves noise.
+        const T reduction = settings.antithetic ? 0.75 : 0.25;
+        for (auto i = 0; i < r.num_options; ++i) {
+            const T scale = std::max(r.underlyings[i], r.strikes[i]);
+            EXPECT_NEAR(
+                op.prices[i], expected.prices[i],
+                5 * std::hypot(errors[i], expected_errors[i]) + 1e-5 * scale)
+                << "index " << i;
+            if (expected.prices[i] > 1e-2 * scale) {
+                EXPECT_LE(errors[i], reduction * expected_errors[i])
+                    << "index " << i;
+            }
+        }
+    }
+}
+
+template <typename T>
+static void ExpectScenarioGridMatchesShockedPrice(T tolerance)
+{
+    // Assign
+    RandomInput<T> r{1, 10007};
+    const std::vector<T> spot_shocks{-0.1, -0.05, 0, 0.05, 0.1};
+    const std::vector<T> vol_shocks{0, 0.02, 0.05};
+    const ScenarioGridView<T> grid{spot_shocks, vol_shocks};
+    const size_t num_scenarios = grid.num_scenarios();
+    std::vector<T> positions(r.num_options, 0);
+    for (auto i = 0; i < r.num_options; ++i) {
+        positions[i] = r.rng(200.0) - 100;
+    }
+    OptionPricing<T> op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    std::vector<T> fast_pnl(num_scenarios * r.num_options, 0);
+    std::vector<T> dynamic_pnl(num_scenarios * r.num_options, 0);
+    std::vector<T> parallel_pnl(num_scenarios * r.num_options, 0);
+    std::vector<T> fast_totals(num_scenarios, 0);
+    std::vector<T> dynamic_totals(num_scenarios, 0);
+    std::vector<T> parallel_totals(num_scenarios, 0);
+    ThreadPool pool(3);
+    // Small chunks so that every thread gets many, the last one partial
+    const ParallelBlackScholes<T> pricer(pool, 1000);
+
+    // Act
+    FastScenarioGrid<T, hn::ScalableTag<T>>::revalue(
+        op.view(), grid, fast_pnl);
+    FastScenarioGrid<T, hn::ScalableTag<T>>::aggregate(
+        op.view(), grid, positions, fast_totals);
+    DynamicBlackScholes<T>::revalue_scenarios(op.view(), grid, dynamic_pnl);
+    DynamicBlackScholes<T>::aggregate_scenarios(
+        op.view(), grid, positions, dynamic_totals);
+    pricer.revalue_scenarios(op.view(), grid, parallel_pnl);
+    pricer.aggregate_scenarios(op.view(), grid, positions, parallel_totals);
+
+    // Assert: against repricing the shocked columns, P&L relative to
+    // max(S, K) and totals to the sum of |position| * max(S, K)
+    OptionPricing<T> base_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(base_op);
+    EXPECT_EQ(parallel_pnl, dynamic_pnl);
+    for (auto j = 0; j < spot_shocks.size(); ++j) {
+        for (auto k = 0; k < vol_shocks.size(); ++k) {
+            std::vector<T> underlyings(r.underlyings);
+            std::vector<T> volatilities(r.volatilities);
+            for (auto i = 0; i < r.num_options; ++i) {
+                underlyings[i] *= 1 + spot_shocks[j];
+                volatilities[i] += vol_shocks[k];
+            }
+            OptionPricing<T> shocked_op(
+                underlyings, r.strikes, r.risk_free_rates, volatilities,
+                r.times_to_expiry, r.dividend_yields, r.option_types);
+            FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(shocked_op);
+
+            const size_t s = grid.scenario(j, k);
+            T expected_total = 0;
+            T total_scale = 0;
+            for (auto i = 0; i < r.num_options; ++i) {
+                const T expected = shocked_op.prices[i] - base_op.prices[i];
+                const T scale = std::max(r.underlyings[i], r.strikes[i]);
+                const size_t cell = s * r.num_options + i;
+                EXPECT_NEAR(fast_pnl[cell], expected, tolerance * scale)
+                    << "scenario " << s << " index " << i;
+                EXPECT_NEAR(dynamic_pnl[cell], expected, tolerance * scale)
+                    << "scenario " << s << " index " << i;
+                expected_total += positions[i] * expected;
+                total_scale += std::abs(positions[i]) * scale;
+            }
+            for (const T total :
+                 {fast_totals[s], dynamic_totals[s], parallel_totals[s]}) {
+                EXPECT_NEAR(total, expected_total, tolerance * total_scale)
+                    << "scenario " << s;
+            }
+        }
+    }
+    // The unshocked scenario reprices at exactly the base price
+    for (auto i = 0; i < r.num_options; ++i) {
+        EXPECT_EQ(fast_pnl[grid.scenario(2, 0) * r.num_options + i], 0);
+    }
+}
+
+TEST(BlackScholesTestDouble, ScenarioGridMatchesShockedPrice)
+{
+    ExpectScenarioGridMatchesShockedPrice<double>(1e-12);
+}
+
+TEST(BlackScholesTestFloat, ScenarioGridMatchesShockedPrice)
+{
+    ExpectScenarioGridMatchesShockedPrice<float>(5e-5);
+}
+
+template <typename T>
+static void ExpectScenarioGridClampsVolatility(T tolerance)
+{
+    // Assign: a vol shock that takes every volatility below zero
+    RandomInput<T> r{1, 1001};
+    const std::vector<T> spot_shocks{0};
+    const std::vector<T> vol_shocks{-10};
+    const ScenarioGridView<T> grid{spot_shocks, vol_shocks};
+    OptionPricing<T> op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    std::vector<T> pnl(r.num_options, 0);
+
+    // Act
+    FastScenarioGrid<T, hn::ScalableTag<T>>::revalue(op.view(), grid, pnl);
+
+    // Assert: P&L is that of pricing at kMinVolatility
+    OptionPricing<T> base_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(base_op);
+    const std::vector<T> floored(
+        r.num_options, ScenarioGridView<T>::kMinVolatility);
+    OptionPricing<T> floored_op(
+        r.underlyings, r.strikes, r.risk_free_rates, floored,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    FastBlackScholes<T, hn::ScalableTag<T>>::price_mixed(floored_op);
+    for (auto i = 0; i < r.num_options; ++i) {
+        const T expected = floored_op.prices[i] - base_op.prices[i];
+        const T scale = std::max(r.underlyings[i], r.strikes[i]);
+        EXPECT_NEAR(pnl[i], expected, tolerance * scale) << "index " << i;
+    }
+}
+
+TEST(BlackScholesTestDouble, ScenarioGridClampsVolatility)
+{
+    ExpectScenarioGridClampsVolatility<double>(1e-12);
+}
+
+TEST(BlackScholesTestFloat, ScenarioGridClampsVolatility)
+{
+    ExpectScenarioGridClampsVolatility<float>(5e-5);
+}
+
+template <Stores S>
+using StoresPricer = FastBlackScholes<
+    double, hn::ScalableTag<double>, Accuracy::kExact, Precision::kFull, S>;
+
+template <Stores S>
+static void ExpectStoresMatchCached(size_t num_options)
+{
+    // Assign
+    using T = double;
+    const RandomInput<T> r{1, num_options};
+    AlignedOptionPricing<T> op;
+    CopyInputs(r, op);
+    AlignedOptionPricing<T> mixed_op;
+    CopyInputs(r, mixed_op);
+    PutPricing<T> put(num_options);
+    OptionPricing<T> cached_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    PutPricing<T> cached_put(num_options);
+    OptionPricing<T> cached_mixed_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+
+    // Act
+    StoresPricer<S>::price_call_put(op.view(), put.view());
+    StoresPricer<S>::price_mixed(mixed_op);
+    StoresPricer<Stores::kCached>::price_call_put(cached_op, cached_put);
+    StoresPricer<Stores::kCached>::price_mixed(cached_mixed_op);
+
+    // Assert
+    for (auto i = 0; i < num_options; ++i) {
+        EXPECT_EQ(op.prices()[i], cached_op.prices[i]);
+        EXPECT_EQ(op.deltas()[i], cached_op.deltas[i]);
+        EXPECT_EQ(op.vegas()[i], cached_op.vegas[i]);
+        EXPECT_EQ(op.thetas()[i], cached_op.thetas[i]);
+        EXPECT_EQ(op.gammas()[i], cached_op.gammas[i]);
+        EXPECT_EQ(op.rhos()[i], cached_op.rhos[i]);
+        EXPECT_EQ(put.prices[i], cached_put.prices[i]);
+        EXPECT_EQ(put.deltas[i], cached_put.deltas[i]);
+        EXPECT_EQ(put.thetas[i], cached_put.thetas[i]);
+        EXPECT_EQ(put.rhos[i], cached_put.rhos[i]);
+        EXPECT_EQ(mixed_op.prices()[i], cached_mixed_op.prices[i]);
+        EXPECT_EQ(mixed_op.deltas()[i], cached_mixed_op.deltas[i]);
+        EXPECT_EQ(mixed_op.thetas()[i], cached_mixed_op.thetas[i]);
+        EXPECT_EQ(mixed_op.rhos()[i], cached_mixed_op.rhos[i]);
+    }
+}
+
+TEST(BlackScholesTestDouble, StreamingStoresMatchCached)
+{
+    ExpectStoresMatchCached<Stores::kStreaming>(10007);
+    ExpectStoresMatchCached<Stores::kAuto>(10007);
+}
+
+TEST(BlackScholesTestDouble, DynamicAndParallelStoresMatchCached)
+{
+    // Assign
+    using T = double;
+    const RandomInput<T> r{1, 100003};
+    OptionPricing<T> cached_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    PutPricing<T> cached_put(r.num_options);
+    OptionPricing<T> cached_mixed_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields, r.option_types);
+    AlignedOptionPricing<T> dynamic_op;
+    CopyInputs(r, dynamic_op);
+    PutPricing<T> dynamic_put(r.num_options);
+    AlignedOptionPricing<T> parallel_op;
+    CopyInputs(r, parallel_op);
+    AlignedOptionPricing<T> parallel_mixed_op;
+    CopyInputs(r, parallel_mixed_op);
+    ThreadPool pool(3);
+    const ParallelBlackScholes<T> pricer(pool, 1000);
+
+    // Act
+    DynamicBlackScholes<T>::price_call_put(cached_op, cached_put);
+    DynamicBlackScholes<T>::price_mixed(cached_mixed_op);
+    DynamicBlackScholes<T>::price_call_put(
+        dynamic_op.view(), dynamic_put.view(), Stores::kStreaming);
+    pricer.price<true>(parallel_op, Stores::kStreaming);
+    pricer.price_mixed(parallel_mixed_op, Stores::kAuto);
+
+    // Assert
+    for (auto i = 0; i < r.num_options; ++i) {
+        EXPECT_EQ(dynamic_op.prices()[i], cached_op.prices[i]);
+        EXPECT_EQ(dynamic_op.gammas()[i], cached_op.gammas[i]);
+        EXPECT_EQ(dynamic_put.prices[i], cached_put.prices[i]);
+        EXPECT_EQ(dynamic_put.rhos[i], cached_put.rhos[i]);
+        EXPECT_EQ(parallel_op.prices()[i], cached_op.prices[i]);
+        EXPECT_EQ(parallel_op.thetas()[i], cached_op.thetas[i]);
+        EXPECT_EQ(parallel_mixed_op.prices()[i], cached_mixed_op.prices[i]);
+        EXPECT_EQ(parallel_mixed_op.deltas()[i], cached_mixed_op.deltas[i]);
+    }
+}
+
+TEST(BlackScholesTestDouble, AutoStoresStreamBatchesLargerThanCache)
+{
+    using Auto = StoresPricer<Stores::kAuto>;
+    using Cached = StoresPricer<Stores::kCached>;
+    using Streaming = StoresPricer<Stores::kStreaming>;
+    // 6 inputs and 6 outputs of 8 bytes per option
+    const size_t fits = last_level_cache_bytes() / (12 * sizeof(double));
+
+    EXPECT_FALSE((Auto::streams<Auto::Legs::kCall, kAllOutputs>(fits)));
+    EXPECT_TRUE((Auto::streams<Auto::Legs::kCall, kAllOutputs>(fits + 1)));
+    EXPECT_FALSE((Auto::streams<Auto::Legs::kCall, kPrice>(fits + 1)));
+    EXPECT_TRUE((Auto::streams<Auto::Legs::kCallAndPut, kAllOutputs>(fits)));
+    EXPECT_FALSE(
+        (Cached::streams<Cached::Legs::kCall, kAllOutputs>(100 * fits)));
+    EXPECT_TRUE((Streaming::streams<Streaming::Legs::kCall, kAllOutputs>(1)));
+}
+
+TEST(BlackScholesTestDouble, PriceCallerOwnedColumns)
+{
+    // Assign
+    using T = double;
+    constexpr T sentinel = -12345.0;
+    RandomInput<T> r{1, 1003};
+    OptionPricing<T> owning_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    // Output columns live in one caller buffer, with a guard past each column
+    const size_t stride = r.num_options + hn::Lanes(hn::ScalableTag<T>());
+    std::vector<T> fast_out(6 * stride, sentinel);
+    std::vector<T> naive_out(6 * stride, sentinel);
+    auto view = [&](std::vector<T>& out) {
+        auto column = [&](size_t c) {
+            return std::span<T>(out.data() + c * stride, r.num_options);
+        };
+        return OptionPricingView<T>(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields, column(0), column(1),
+            column(2), column(3), column(4), column(5));
+    };
+
+    // Act
+    FastBlackScholes<T, hn::ScalableTag<T>>::price<false>(view(fast_out));
+    NaiveBlackScholes<T>::price<false>(view(naive_out));
+    FastBlackScholes<T, hn::ScalableTag<T>>::price<false>(owning_op);
+
+    // Assert
+    const OptionPricingView<T> fast_view = view(fast_out);
+    const OptionPricingView<T> naive_view = view(naive_out);
+    for (auto i = 0; i < r.num_options; ++i) {
+        EXPECT_EQ(fast_view.prices[i], owning_op.prices[i]);
+        EXPECT_EQ(fast_view.deltas[i], owning_op.deltas[i]);
+        EXPECT_EQ(fast_view.gammas[i], owning_op.gammas[i]);
+        EXPECT_EQ(fast_view.vegas[i], owning_op.vegas[i]);
+        EXPECT_EQ(fast_view.rhos[i], owning_op.rhos[i]);
+        EXPECT_NEAR(fast_view.prices[i], naive_view.prices[i], 1e-5);
+        EXPECT_NEAR(fast_view.deltas[i], naive_view.deltas[i], 1e-5);
+    }
+    for (size_t c = 0; c < 6; ++c) {
+        for (size_t i = r.num_options; i < stride; ++i) {
+            EXPECT_EQ(fast_out[c * stride + i], sentinel);
+            EXPECT_EQ(naive_out[c * stride + i], sentinel);
+        }
+    }
+}
+
+TEST(BlackScholesTestDouble, AlignedStorageIsReused)
+{
+    using T = double;
+    AlignedOptionPricing<T> aligned_op;
+    aligned_op.reserve(1000);
+    const T* prices = aligned_op.prices().data();
+    EXPECT_EQ(
+        reinterpret_cast<uintptr_t>(aligned_op.underlyings().data()) %
+            HWY_ALIGNMENT,
+        0);
+
+    for (const size_t num_options : {1000, 37, 999, 1}) {
+        // Assign
+        RandomInput<T> r{1, num_options};
+        OptionPricing<T> expected_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields);
+        CopyInputs(r, aligned_op);
+
+        // Act
+        FastBlackScholes<T, hn::ScalableTag<T>>::price<true>(aligned_op);
+        NaiveBlackScholes<T>::price<true>(expected_op);
+
+        // Assert
+        EXPECT_EQ(aligned_op.prices().data(), prices);
+        EXPECT_EQ(
+            aligned_op.capacity() % AlignedOptionPricing<T>::kColumnPadding,
+            0);
+        for (auto i = 0; i < num_options; ++i) {
+            EXPECT_NEAR(aligned_op.prices()[i], expected_op.prices[i], 1e-5);
+            EXPECT_NEAR(aligned_op.deltas()[i], expected_op.deltas[i], 1e-5);
+            EXPECT_NEAR(aligned_op.gammas()[i], expected_op.gammas[i], 1e-5);
+            EXPECT_NEAR(aligned_op.vegas()[i], expected_op.vegas[i], 1e-5);
+            EXPECT_NEAR(aligned_op.rhos()[i], expected_op.rhos[i], 1e-5);
+        }
+    }
+}
+
+TEST(BlackScholesTestDouble, DynamicDispatchEveryTarget)
+{
+    // Assign
+    using T = double;
+    RandomInput<T> r{1, 100003};
+    OptionPricing<T> naive_op(
+        r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+        r.times_to_expiry, r.dividend_yields);
+    NaiveBlackScholes<T>::price<true>(naive_op);
+
+    const std::vector<int64_t> targets = available_targets();
+    ASSERT_FALSE(targets.empty());
+    EXPECT_EQ(dispatched_target(), targets.front());
+    for (const int64_t target : targets) {
+        OptionPricing<T> dynamic_op(
+            r.underlyings, r.strikes, r.risk_free_rates, r.volatilities,
+            r.times_to_expiry, r.dividend_yields);
+
+        // Act
+        ASSERT_TRUE(force_target(target));
+        DynamicBlackScholes<T>::price<true>(dynamic_op);
+
+        // Assert
+        EXPECT_EQ(dispatched_target(), target) << dispatched_target_name();
+        for (auto i = 0; i < dynamic_op.prices.size(); ++i) {
+            EXPECT_NEAR(dynamic_op.prices[i], naive_op.prices[i], 1e-5);
+            EXPECT_NEAR(dynamic_op.deltas[i], naive_op.deltas[i], 1e-5);
+            EXPECT_NEAR(dynamic_op.gammas[i], naive_op.gammas[i], 1e-5);
+            EXPECT_NEAR(dynamic_op.vegas[i], naive_op.vegas[i], 1e-5);
+            EXPECT_NEAR(dynamic_op.rhos[i], naive_op.rhos[i], 1e-5);
+        }
+    }
+    reset_target();
+    EXPECT_EQ(dispatched_target(), targets.front());
+    EXPECT_FALSE(force_target(0));
+}
+
+template <typename T>
+static void ExpectRecordsRoundTripEveryTarget()
+{
+    // Assign
+    const size_t num_options = 1003;
+    const RandomInput<T> r{1, num_options};
+    const std::vector<OptionRecord<T>> records = ToRecords(r);
+
+    const std::vector<int64_t> targets = available_targets();
+    ASSERT_FALSE(targets.empty());
+    for (const int64_t target : targets) {
+        AlignedOptionPricing<T> op;
+        std::vector<OptionResult<T>> results(num_options);
+
+        // Act
+        ASSERT_TRUE(force_target(target));
+        DynamicBlackScholes<T>::ingest(records, op);
+        DynamicBlackScholes<T>::price_mixed(op);
+        DynamicBlackScholes<T>::write_results(op, results);
+
+        // Assert
+        ASSERT_EQ(op.num_options(), num_options) << dispatched_target_name();
+        for (auto i = 0; i < num_options; ++i) {
+            EXPECT_EQ(op.underlyings()[i], r.underlyings[i]);
+            EXPECT_EQ(op.strikes()[i], r.strikes[i]);
+            EXPECT_EQ(op.risk_free_rates()[i], r.risk_free_rates[i]);
+            EXPECT_EQ(op.volatilities()[i], r.volatilities[i]);
+            EXPECT_EQ(op.times_to_expiry()[i], r.times_to_expiry[i]);
+            EXPECT_EQ(op.dividend_yields()[i], r.dividend_yields[i]);
+            EXPECT_EQ(op.option_types()[i], r.option_types[i]);
+            EXPECT_EQ(results[i].price, op.prices()[i])
+                << dispatched_target_name() << " option " << i;
+            EXPECT_EQ(results[i].delta, op.deltas()[i]);
+            EXPECT_EQ(results[i].vega, op.vegas()[i]);
+            EXPECT_EQ(results[i].theta, op.thetas()[i]);
+            EXPECT_EQ(results[i].gamma, op.gammas()[i]);
+            EXPECT_EQ(results[i].rho, op.rhos()[i]);
+        }
+    }
+    reset_target();
+}
+
+TEST(BlackScholesTestDouble, DynamicDispatchRecordsEveryTarget)
+{
+    ExpectRecordsRoundTripEveryTarget<double>();
+}
+
+TEST(BlackScholesTestFloat, DynamicDispatchRecordsEveryTarget)
+{
+    ExpectRecordsRoundTripEveryTarget<float>();
 }
 
 TEST(BlackScholesTestDouble, Benchmarks)
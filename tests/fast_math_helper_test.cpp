@@ -5,36 +5,293 @@
 #include "fast_math_helper.h"
 #include <gtest/gtest.h>
 #include <hwy/highway.h>
-#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include "naive_math_helper.h"
 
 namespace hn = hwy::HWY_NAMESPACE;
 
 namespace fast_option_pricer {
 
+// Erf, Erfc and NormalCdf are held to the ULP bounds math-inl.h documents
 class FastMathHelperTest : public ::testing::Test
 {
+   protected:
+    // Evaluates 'f' on [lo, hi] one vector at a time and checks that no
+    // lane is more than 'max_ulp' representable values away from 'ref'.
+    template <typename T, typename F, typename R>
+    static void expect_ulp(T lo, T hi, F f, R ref, uint64_t max_ulp)
+    {
+        const hn::ScalableTag<T> d;
+        const size_t lanes = hn::Lanes(d);
+        const size_t n = 100000;
+        std::vector<T> inputs(n + lanes);
+        std::vector<T> outputs(n + lanes);
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            inputs[i] = lo + (hi - lo) * static_cast<T>(i) / static_cast<T>(n);
+        }
+        for (size_t i = 0; i < n; i += lanes) {
+            hn::StoreU(f(d, hn::LoadU(d, inputs.data() + i)), d,
+                       outputs.data() + i);
+        }
+        uint64_t worst = 0;
+        T worst_input = lo;
+        for (size_t i = 0; i < n; ++i) {
+            const uint64_t distance = ulp_distance(outputs[i], ref(inputs[i]));
+            if (distance > worst) {
+                worst = distance;
+                worst_input = inputs[i];
+            }
+        }
+        EXPECT_LE(worst, max_ulp) << "x = " << worst_input;
+    }
+
+    // Number of representable values of T between a and b
+    template <typename T>
+    static uint64_t ulp_distance(T a, T b)
+    {
+        using Bits = std::conditional_t<sizeof(T) == 8, int64_t, int32_t>;
+        // Sign and magnitude onto one ordered integer line, -0 == +0
+        const auto ordered = [](T x) {
+            Bits bits;
+            std::memcpy(&bits, &x, sizeof(T));
+            const auto magnitude = static_cast<int64_t>(
+                bits & std::numeric_limits<Bits>::max());
+            return bits < 0 ? -magnitude : magnitude;
+        };
+        const int64_t delta = ordered(a) - ordered(b);
+        return static_cast<uint64_t>(delta < 0 ? -delta : delta);
+    }
+
+    // Largest error of 'f' against 'ref' on [lo, hi], relative to the
+    // reference value or absolute.
+    template <typename T, typename F, typename R>
+    static T max_error(T lo, T hi, F f, R ref, bool relative)
+    {
+        const hn::ScalableTag<T> d;
+        const size_t lanes = hn::Lanes(d);
+        const size_t n = 1000000;
+        std::vector<T> inputs(n + lanes);
+        std::vector<T> outputs(n + lanes);
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            inputs[i] = lo + (hi - lo) * static_cast<T>(i) / static_cast<T>(n);
+        }
+        for (size_t i = 0; i < n; i += lanes) {
+            hn::StoreU(f(d, hn::LoadU(d, inputs.data() + i)), d,
+                       outputs.data() + i);
+        }
+        T max_error = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const T expected = ref(inputs[i]);
+            const T scale = relative ? std::max(
+                                           std::abs(expected),
+                                           std::numeric_limits<T>::min())
+                                     : 1;
+            max_error =
+                std::max(max_error, std::abs(outputs[i] - expected) / scale);
+        }
+        return max_error;
+    }
+
+    template <typename T>
+    static void record_error(const std::string& key, T error)
+    {
+        std::ostringstream value;
+        value << error;
+        RecordProperty(key, value.str());
+    }
+
+    // Measures exp, log and normal_cdf at accuracy A and checks them
+    // against the bounds FastMathHelper documents.
+    template <typename T, Accuracy A>
+    static void expect_max_errors(T max_exp, T max_log, T max_cdf)
+    {
+        using D = hn::ScalableTag<T>;
+        using VecT = hn::Vec<D>;
+        const T exp_error = max_error<T>(
+            -50, 2,
+            [](auto, auto x) {
+                return FastMathHelper::exp<VecT, T, D, D{}, A>(x);
+            },
+            [](T x) {
+                return static_cast<T>(std::exp(static_cast<double>(x)));
+            },
+            true);
+        const T log_error = max_error<T>(
+            0.01, 100,
+            [](auto, auto x) {
+                return FastMathHelper::log<VecT, T, D, D{}, A>(x);
+            },
+            [](T x) {
+                return static_cast<T>(std::log(static_cast<double>(x)));
+            },
+            true);
+        const T cdf_error = max_error<T>(
+            -10, 10,
+            [](auto, auto x) {
+                return FastMathHelper::normal_cdf<VecT, T, D, D{}, A>(x);
+            },
+            [](T x) {
+                return static_cast<T>(NaiveMathHelper::normal_cdf<double>(x));
+            },
+            false);
+        // Measured errors go to the test report, e.g. --gtest_output=xml
+        const char* names[] = {"exact", "fast", "fastest"};
+        const std::string tier = std::string(names[static_cast<int>(A)]) +
+                                 "_" + std::to_string(sizeof(T) * 8) + "bit_";
+        record_error(tier + "exp", exp_error);
+        record_error(tier + "log", log_error);
+        record_error(tier + "normal_cdf", cdf_error);
+        EXPECT_LE(exp_error, max_exp);
+        EXPECT_LE(log_error, max_log);
+        EXPECT_LE(cdf_error, max_cdf);
+    }
 };
 
-TEST_F(FastMathHelperTest, NormalCdf)
-{
-    const hn::ScalableTag<float> d;
-    std::cout << "Lanes: " << hn::Lanes(d) << std::endl;
-    std::vector<float> inputs{0.0, 1.0, 0.0, 1.0, 0.0, 1.0, 0.0, 1.0};
-    std::vector<float> output{1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
-    for (size_t i = 0; i < inputs.size(); i += hn::Lanes(d)) {
-        std::cout << i << std::endl;
-        hn::Vec128<float> mul = hn::Load(d, inputs.data() + i);
-        mul = hn::MulAdd(mul, mul, mul);
-        hn::Store(mul, d, output.data() + i);
+TEST_F(FastMathHelperTest, ErfDouble)
+{
+    expect_ulp<double>(
+        -6.0, 6.0, [](auto d, auto x) { return hn::Erf(d, x); },
+        [](double x) { return std::erf(x); }, 3);
+}
+
+TEST_F(FastMathHelperTest, ErfcDouble)
+{
+    expect_ulp<double>(
+        -6.0, 26.0, [](auto d, auto x) { return hn::Erfc(d, x); },
+        [](double x) { return std::erfc(x); }, 5);
+}
+
+TEST_F(FastMathHelperTest, ErfFloat)
+{
+    expect_ulp<float>(
+        -4.0f, 4.0f, [](auto d, auto x) { return hn::Erf(d, x); },
+        [](float x) { return std::erf(x); }, 3);
+}
+
+TEST_F(FastMathHelperTest, ErfcFloat)
+{
+    expect_ulp<float>(
+        -4.0f, 9.0f, [](auto d, auto x) { return hn::Erfc(d, x); },
+        [](float x) { return std::erfc(x); }, 5);
+}
+
+TEST_F(FastMathHelperTest, NormalCdfDouble)
+{
+    using T = double;
+    using D = hn::ScalableTag<T>;
+    expect_ulp<T>(
+        -37.0, 8.0,
+        [](auto, auto x) {
+            return FastMathHelper::normal_cdf<hn::Vec<D>, T, D, D{}>(x);
+        },
+        [](T x) {
+            return static_cast<T>(
+                0.5L * std::erfc(-static_cast<long double>(x) /
+                                 std::sqrt(2.0L)));
+        },
+        6);
+}
+
+TEST_F(FastMathHelperTest, NormalCdfDoubleMatchesNaive)
+{
+    // The naive reference rounds x / sqrt(2) before erfc, which costs up to
+    // x^2 ulp on its own, hence the looser bound.
+    using T = double;
+    using D = hn::ScalableTag<T>;
+    expect_ulp<T>(
+        -8.0, 8.0,
+        [](auto, auto x) {
+            return FastMathHelper::normal_cdf<hn::Vec<D>, T, D, D{}>(x);
+        },
+        [](T x) { return NaiveMathHelper::normal_cdf<T>(x); }, 80);
+}
+
+TEST_F(FastMathHelperTest, NormalCdfFloat)
+{
+    using T = float;
+    using D = hn::ScalableTag<T>;
+    expect_ulp<T>(
+        -12.0f, 5.0f,
+        [](auto, auto x) {
+            return FastMathHelper::normal_cdf<hn::Vec<D>, T, D, D{}>(x);
+        },
+        [](T x) {
+            return static_cast<T>(NaiveMathHelper::normal_cdf<double>(x));
+        },
+        6);
+}
+
+TEST_F(FastMathHelperTest, NormalCdfDoubleExtremes)
+{
+    using T = double;
+    using D = hn::ScalableTag<T>;
+    constexpr T kInf = std::numeric_limits<T>::infinity();
+    for (const auto& [x, expected] :
+         {std::pair<T, T>{-kInf, 0}, std::pair<T, T>{-1e300, 0},
+          std::pair<T, T>{1e300, 1}, std::pair<T, T>{kInf, 1}}) {
+        const D d;
+        EXPECT_EQ(
+            hn::GetLane(FastMathHelper::normal_cdf<hn::Vec<D>, T, D, D{}>(
+                hn::Set(d, x))),
+            expected)
+            << "x = " << x;
+        EXPECT_EQ(hn::GetLane(hn::Erfc(d, hn::Set(d, x))), 2 * (1 - expected))
+            << "x = " << x;
     }
-    for (int i = 0; i < output.size(); ++i) {
-        std::cout << i << ": " << output[i] << std::endl;
+}
+
+TEST_F(FastMathHelperTest, NormalCdfFloatExtremes)
+{
+    using T = float;
+    using D = hn::ScalableTag<T>;
+    constexpr T kInf = std::numeric_limits<T>::infinity();
+    constexpr T kMax = std::numeric_limits<T>::max();
+    for (const auto& [x, expected] :
+         {std::pair<T, T>{-kInf, 0}, std::pair<T, T>{-kMax, 0},
+          std::pair<T, T>{-1e20f, 0}, std::pair<T, T>{1e20f, 1},
+          std::pair<T, T>{kMax, 1}, std::pair<T, T>{kInf, 1}}) {
+        const D d;
+        EXPECT_EQ(
+            hn::GetLane(FastMathHelper::normal_cdf<hn::Vec<D>, T, D, D{}>(
+                hn::Set(d, x))),
+            expected)
+            << "x = " << x;
     }
-    std::cout << "Lanes: " << hn::Lanes(d) << std::endl;
-    //auto res = fast_math_helper.normal_cdf(0);
-    //EXPECT_DOUBLE_EQ(0.5, res);
-    EXPECT_TRUE(true);
 }
 
-}  // namespace fast_option_pricer
\ No newline at end of file
+TEST_F(FastMathHelperTest, NormalPdf)
+{
+    using T = double;
+    using D = hn::ScalableTag<T>;
+    expect_ulp<T>(
+        -10.0, 10.0,
+        [](auto, auto x) {
+            return FastMathHelper::normal_pdf<hn::Vec<D>, T, D, D{}>(x);
+        },
+        [](T x) { return NaiveMathHelper::normal_pdf<T>(x); }, 64);
+}
+
+TEST_F(FastMathHelperTest, AccuracyTiersDouble)
+{
+    expect_max_errors<double, Accuracy::kExact>(4e-16, 4e-16, 4e-16);
+    expect_max_errors<double, Accuracy::kFast>(1.1e-7, 1.2e-7, 9e-8);
+    expect_max_errors<double, Accuracy::kFastest>(6e-6, 1.2e-7, 1.2e-5);
+}
+
+TEST_F(FastMathHelperTest, AccuracyTiersFloat)
+{
+    expect_max_errors<float, Accuracy::kExact>(2e-7, 2e-7, 1e-7);
+    expect_max_errors<float, Accuracy::kFast>(3e-7, 4e-7, 4e-7);
+    expect_max_errors<float, Accuracy::kFastest>(6e-6, 4e-7, 1.2e-5);
+}
+
+}  // namespace fast_option_pricer
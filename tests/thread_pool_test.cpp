@@ -0,0 +1,63 @@
+//
+// Created by Karolis Spukas on 17/10/2026.
+//
+
+#include "thread_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+
+namespace fast_option_pricer {
+
+TEST(ThreadPoolTest, RunsEveryTaskOnce)
+{
+    for (const size_t num_threads : {1, 2, 5}) {
+        // Assign
+        ThreadPool pool(num_threads);
+        EXPECT_EQ(pool.num_threads(), num_threads);
+
+        // Act: reuse the same pool for batches of different sizes
+        for (const size_t num_tasks : {0, 1, 3, 1000}) {
+            std::vector<std::atomic<int>> calls(num_tasks);
+            pool.run(num_tasks, [&](size_t i) { ++calls[i]; });
+
+            // Assert
+            for (size_t i = 0; i < num_tasks; ++i) {
+                EXPECT_EQ(calls[i], 1) << num_threads << " threads, task " << i;
+            }
+        }
+    }
+}
+
+TEST(ThreadPoolTest, ZeroThreadsRunsInline)
+{
+    // Assign
+    ThreadPool pool(0);
+    size_t sum = 0;
+
+    // Act
+    pool.run(10, [&](size_t i) { sum += i; });
+
+    // Assert
+    EXPECT_EQ(pool.num_threads(), 1);
+    EXPECT_EQ(sum, 45);
+}
+
+TEST(ThreadPoolTest, NestedRunOnSamePoolRunsInline)
+{
+    // Assign
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> calls(8 * 100);
+
+    // Act: every task runs a batch of its own on the pool it runs on
+    pool.run(8, [&](size_t i) {
+        pool.run(100, [&](size_t j) { ++calls[100 * i + j]; });
+    });
+
+    // Assert
+    for (size_t i = 0; i < calls.size(); ++i) {
+        EXPECT_EQ(calls[i], 1) << "task " << i;
+    }
+}
+
+}  // namespace fast_option_pricer